@@ -23,10 +23,18 @@ DROP TABLE IF EXISTS `scanned_barcodes`;
 /*!40101 SET @saved_cs_client     = @@character_set_client */;
 /*!50503 SET character_set_client = utf8mb4 */;
 CREATE TABLE `scanned_barcodes` (
-  `id` int NOT NULL AUTO_INCREMENT,
+  `id` bigint unsigned NOT NULL AUTO_INCREMENT,
   `barcode` varchar(255) NOT NULL,
-  `timestamp` datetime DEFAULT NULL,
-  PRIMARY KEY (`id`)
+  `timestamp` datetime(3) DEFAULT NULL,
+  `device_id` int unsigned NOT NULL DEFAULT '0',
+  `boot` smallint unsigned NOT NULL DEFAULT '0',
+  `seq` int unsigned NOT NULL DEFAULT '0',
+  `scanner` tinyint unsigned NOT NULL DEFAULT '0',
+  `device_ms` int unsigned DEFAULT NULL,
+  PRIMARY KEY (`id`),
+  UNIQUE KEY `uq_device_boot_seq` (`device_id`,`boot`,`seq`),
+  KEY `idx_timestamp` (`timestamp`),
+  KEY `idx_device_timestamp` (`device_id`,`timestamp`)
 ) ENGINE=InnoDB AUTO_INCREMENT=1 DEFAULT CHARSET=utf8mb4 COLLATE=utf8mb4_0900_ai_ci;
 /*!40101 SET character_set_client = @saved_cs_client */;
 
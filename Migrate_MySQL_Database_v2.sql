@@ -0,0 +1,36 @@
+-- Migration von `scanned_barcodes` auf das Schema in Create_MySQL_Database.sql
+--
+-- Neue Spalten (von mysql_bridge.py befüllt):
+--   device_id  Geräte-ID der Firmware (NET_DEVICE_ID bzw. aus der Board-ID)
+--   boot       Startzähler der Firmware; die Scan-Nummern beginnen mit jedem Start neu
+--   seq        Scan-Nummer innerhalb des Starts
+--   scanner    USB-Geräteadresse des Scanners
+--   device_ms  Zeitstempel des Scans auf dem Gerät in ms seit dem Start `boot`
+-- `timestamp` bekommt Millisekunden (Empfangszeit minus Alter des Scans beim Senden).
+-- Bei Scans eines früheren Starts, deren Zeit der Zwischenserver nicht kennt, bleibt er NULL
+-- (`device_ms` ist gesetzt).
+--
+-- Der eindeutige Schlüssel (device_id, boot, seq) macht wiederholt gesendete Scans zu
+-- wirkungslosen Upserts. Bestehende Zeilen erhalten device_id = 0, boot = 0 und seq = id,
+-- damit sie eindeutig bleiben.
+--
+-- Aufruf: mysql -u root -p ch9121_test < Migrate_MySQL_Database_v2.sql
+-- (die erste Änderung kopiert die Tabelle; bei großen Tabellen außerhalb der Schichten)
+
+ALTER TABLE `scanned_barcodes`
+  MODIFY `id` bigint unsigned NOT NULL AUTO_INCREMENT,
+  MODIFY `timestamp` datetime(3) DEFAULT NULL,
+  ADD COLUMN `device_id` int unsigned NOT NULL DEFAULT '0' AFTER `timestamp`,
+  ADD COLUMN `boot` smallint unsigned NOT NULL DEFAULT '0' AFTER `device_id`,
+  ADD COLUMN `seq` int unsigned NOT NULL DEFAULT '0' AFTER `boot`,
+  ADD COLUMN `scanner` tinyint unsigned NOT NULL DEFAULT '0' AFTER `seq`,
+  ADD COLUMN `device_ms` int unsigned DEFAULT NULL AFTER `scanner`;
+
+UPDATE `scanned_barcodes` SET `seq` = `id` WHERE `device_id` = 0 AND `boot` = 0;
+
+-- Zeitbereiche (alle Geräte) und Zeitbereiche pro Gerät; Lücken- und Stand-Abfragen pro
+-- Gerät/Start laufen über den eindeutigen Schlüssel
+ALTER TABLE `scanned_barcodes`
+  ADD UNIQUE KEY `uq_device_boot_seq` (`device_id`,`boot`,`seq`),
+  ADD KEY `idx_timestamp` (`timestamp`),
+  ADD KEY `idx_device_timestamp` (`device_id`,`timestamp`);
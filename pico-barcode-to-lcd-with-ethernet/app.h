@@ -0,0 +1,18 @@
+// Einstiegspunkte der beiden Hauptschleifen
+// main() ruft core0_setup() und dann core0_poll() in einer Endlosschleife auf,
+// Core 1 entsprechend core1_setup() und core1_poll(). Die Host-Simulation (host_sim/)
+// ruft dieselben Funktionen direkt auf und verzahnt beide Cores über eine virtuelle Uhr.
+
+#pragma once
+
+// Core 0: Board, Standard-I/O und TinyUSB Host initialisieren
+void core0_setup(void);
+
+// Core 0: ein Durchlauf (tuh_task, HID-Dekodierung)
+void core0_poll(void);
+
+// Core 1: LED, LCD, CH9121 und Sendepfad initialisieren
+void core1_setup(void);
+
+// Core 1: ein Durchlauf (Senken, LCD-Renderer, LED)
+void core1_poll(void);
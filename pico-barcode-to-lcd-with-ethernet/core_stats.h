@@ -0,0 +1,15 @@
+// Auslastungszähler pro CPU-Core (werden von der jeweiligen Hauptschleife gepflegt)
+
+#pragma once
+
+#include <stdint.h>
+
+typedef struct {
+    uint32_t loops;         // Durchläufe der Hauptschleife
+    uint32_t busy_loops;    // Durchläufe, in denen Arbeit angefallen ist
+    uint64_t busy_us;       // Summe der Laufzeit dieser Durchläufe
+    uint32_t max_loop_us;   // Längster einzelner Durchlauf (Latenz bis zum nächsten tuh_task())
+} core_stats_t;
+
+// Liefert eine Kopie der Zähler von Core 0 oder Core 1
+void core_stats_get(uint8_t core, core_stats_t* out);
@@ -12,30 +12,69 @@
 #include <string.h>
 #include <stdio.h>
 
-#include "lcd_1602_i2c.h"
-
-// Methoden aus main.c
-// Externe Funktionen für LED-Steuerung und Netzwerkkommunikation
-void led_request_off_ms(uint32_t ms);
-void net_send_line(const char* line);
+#include "keymap.h"
+#include "led.h"
+#include "scan_ring.h"
+#include "scan_check.h"
+#include "scan_dedup.h"
+#include "scan_stats.h"
+#include "pico/time.h"
 
 // Maximale Anzahl von Reports pro HID-Gerät
 #define MAX_REPORT  4
 
-// Lookup-Tabelle für die Konvertierung von HID-Keycodes in ASCII-Zeichen
-// Index: Keycode, [0]: normale Taste, [1]: mit Shift-Taste
-static uint8_t const keycode2ascii[128][2] =  { HID_KEYCODE_TO_ASCII };
-
-// Struktur zur Speicherung von HID-Report-Informationen pro Gerät
-static struct {
+// Zustand pro HID-Schnittstelle, Schlüssel (dev_addr, instance)
+// Enthält die Report-Informationen und den Barcode-Assembler des jeweiligen Scanners,
+// damit mehrere Scanner an einem Hub ihre Zeichen nicht in einen Puffer mischen.
+typedef struct {
+  uint8_t dev_addr;                                 // USB-Geräteadresse, 0 = Slot frei
+  uint8_t instance;                                 // Instanznummer des HID-Interface
   uint8_t report_count;                             // Anzahl der Reports
+  uint8_t barcode_len;                              // Aktuelle Länge des Barcodes
+  uint32_t t_first_us;                              // Zeitstempel des ersten Zeichens (Latenzmessung)
   tuh_hid_report_info_t report_info[MAX_REPORT];    // Report-Informationen
-} hid_info[CFG_TUH_HID];
+  hid_keyboard_report_t prev_report;                // Letzter empfangener Tastatur-Report
+  char barcode_buf[SCAN_CODE_MAX];                  // Puffer für Barcode-Zeichen
+} hid_slot_t;
+
+// Ein Slot pro möglicher HID-Schnittstelle (CFG_TUH_HID)
+static hid_slot_t hid_slots[CFG_TUH_HID];
 
 // Funktionsprototypen für Report-Verarbeitung
-static void process_kbd_report(hid_keyboard_report_t const *report);
+static void process_kbd_report(hid_slot_t* slot, hid_keyboard_report_t const *report);
 static void process_mouse_report(hid_mouse_report_t const * report);
-static void process_generic_report(uint8_t dev_addr, uint8_t instance, uint8_t const* report, uint16_t len);
+static void process_generic_report(hid_slot_t* slot, uint8_t const* report, uint16_t len);
+
+// Sucht den Slot einer HID-Schnittstelle
+// Parameter dev_addr: USB-Geräteadresse
+// Parameter instance: Instanznummer des HID-Interface
+// Rückgabe: Zeiger auf den Slot oder NULL, wenn die Schnittstelle nicht gemountet ist
+static hid_slot_t* hid_slot_find(uint8_t dev_addr, uint8_t instance) {
+  for (uint8_t i = 0; i < CFG_TUH_HID; i++) {
+    if (hid_slots[i].dev_addr == dev_addr && hid_slots[i].instance == instance) return &hid_slots[i];
+  }
+  return NULL;
+}
+
+// Belegt einen freien Slot für eine neu gemountete HID-Schnittstelle
+// Rückgabe: Zeiger auf den (zurückgesetzten) Slot oder NULL, wenn alle belegt sind
+static hid_slot_t* hid_slot_alloc(uint8_t dev_addr, uint8_t instance) {
+  hid_slot_t* slot = hid_slot_find(dev_addr, instance);
+  if (!slot) slot = hid_slot_find(0, 0);  // Freie Slots sind komplett genullt
+  if (slot) {
+    memset(slot, 0, sizeof(*slot));
+    slot->dev_addr = dev_addr;
+    slot->instance = instance;
+  }
+  return slot;
+}
+
+// Anzahl empfangener HID-Reports (für die Auslastungszähler von Core 0)
+static volatile uint32_t hid_report_count = 0;
+
+uint32_t hid_app_report_count(void) {
+  return hid_report_count;
+}
 
 // HID-App-Task (aktuell keine Aktion erforderlich)
 // Diese Funktion wird in der Hauptschleife aufgerufen, aktuell werden alle Aktionen
@@ -52,6 +91,13 @@ void hid_app_task(void) {
 void tuh_hid_mount_cb(uint8_t dev_addr, uint8_t instance, uint8_t const* desc_report, uint16_t desc_len) {
   printf("HID device address = %d, instance = %d is mounted\r\n", dev_addr, instance);
 
+  // Belegt den Slot mit Report-Informationen und Barcode-Assembler
+  hid_slot_t* slot = hid_slot_alloc(dev_addr, instance);
+  if (!slot) {
+    printf("Error: no free HID slot\r\n");
+    return;
+  }
+
   // Protokoll-Strings für Debug-Ausgabe
   const char* protocol_str[] = { "None", "Keyboard", "Mouse" };
   uint8_t const itf_protocol = tuh_hid_interface_protocol(dev_addr, instance);
@@ -59,8 +105,8 @@ void tuh_hid_mount_cb(uint8_t dev_addr, uint8_t instance, uint8_t const* desc_re
 
   // Wenn kein spezifisches Protokoll erkannt wurde, Report-Deskriptor parsen
   if ( itf_protocol == HID_ITF_PROTOCOL_NONE ) {
-    hid_info[instance].report_count = tuh_hid_parse_report_descriptor(hid_info[instance].report_info, MAX_REPORT, desc_report, desc_len);
-    printf("HID has %u reports \r\n", hid_info[instance].report_count);
+    slot->report_count = tuh_hid_parse_report_descriptor(slot->report_info, MAX_REPORT, desc_report, desc_len);
+    printf("HID has %u reports \r\n", slot->report_count);
   }
 
   // Fordert den ersten Report vom Gerät an
@@ -74,6 +120,10 @@ void tuh_hid_mount_cb(uint8_t dev_addr, uint8_t instance, uint8_t const* desc_re
 // Parameter instance: Instanznummer des HID-Interface
 void tuh_hid_umount_cb(uint8_t dev_addr, uint8_t instance) {
   printf("HID device address = %d, instance = %d is unmounted\r\n", dev_addr, instance);
+
+  // Gibt den Slot frei; ein halb gelesener Barcode wird verworfen
+  hid_slot_t* slot = hid_slot_find(dev_addr, instance);
+  if (slot) memset(slot, 0, sizeof(*slot));
 }
 
 // Callback-Funktion, die aufgerufen wird, wenn ein HID-Report empfangen wurde
@@ -82,20 +132,24 @@ void tuh_hid_umount_cb(uint8_t dev_addr, uint8_t instance) {
 // Parameter report: Zeiger auf die Report-Daten
 // Parameter len: Länge der Report-Daten
 void tuh_hid_report_received_cb(uint8_t dev_addr, uint8_t instance, uint8_t const* report, uint16_t len) {
+  hid_report_count++;
+
+  hid_slot_t* slot = hid_slot_find(dev_addr, instance);
+
   // Ermittelt das Interface-Protokoll (Tastatur, Maus oder generisch)
   uint8_t const itf_protocol = tuh_hid_interface_protocol(dev_addr, instance);
 
   // Verarbeitet den Report basierend auf dem Gerätetyp
   switch (itf_protocol) {
     case HID_ITF_PROTOCOL_KEYBOARD:
-      process_kbd_report( (hid_keyboard_report_t const*) report );
+      if (slot) process_kbd_report( slot, (hid_keyboard_report_t const*) report );
     break;
     case HID_ITF_PROTOCOL_MOUSE:
       process_mouse_report( (hid_mouse_report_t const*) report );
     break;
     default:
       // Für generische HID-Geräte (z.B. Barcode-Scanner ohne Tastatur-Protokoll)
-      process_generic_report(dev_addr, instance, report, len);
+      if (slot) process_generic_report(slot, report, len);
     break;
   }
 
@@ -117,58 +171,60 @@ static inline bool find_key_in_report(hid_keyboard_report_t const *report, uint8
 }
 
 // Verarbeitet Tastatur-Reports und sammelt Zeichen zu einem Barcode
+// Parameter slot: Zustand des sendenden Scanners (vorheriger Report, Barcode-Puffer)
 // Parameter report: Zeiger auf den Tastatur-Report
 // 
-// Diese Funktion akkumuliert eingehende Zeichen in einem Puffer, bis die Enter-Taste
-// gedrückt wird. Dann wird der komplette Barcode auf dem LCD angezeigt und über
-// Ethernet versendet.
-static void process_kbd_report(hid_keyboard_report_t const *report) {
-  // Statische Variablen für die Verfolgung des vorherigen Reports und des Barcode-Puffers
-  static hid_keyboard_report_t prev_report = { 0, 0, {0} };  // Letzter empfangener Report
-  static char barcode_buf[64];                                // Puffer für Barcode-Zeichen
-  static size_t barcode_len = 0;                              // Aktuelle Länge des Barcodes
+// Diese Funktion akkumuliert eingehende Zeichen im Puffer des Scanners, bis die Enter-Taste
+// gedrückt wird. Dann wird der komplette Barcode im Scan-Ring veröffentlicht; Anzeige,
+// Versand und LED-Feedback übernehmen die Senken auf Core 1.
+static void process_kbd_report(hid_slot_t* slot, hid_keyboard_report_t const *report) {
+  hid_keyboard_report_t const* prev_report = &slot->prev_report;
 
   // Iteriert über alle Keycodes im aktuellen Report
   for(uint8_t i=0; i<6; i++) {
     if ( report->keycode[i] ) {
       // Verarbeitet nur neu gedrückte Tasten (nicht im vorherigen Report)
-      if (!find_key_in_report(&prev_report, report->keycode[i])) {
-        // Überprüft, ob eine Shift-Taste gedrückt ist
-        bool const is_shift = report->modifier & (KEYBOARD_MODIFIER_LEFTSHIFT | KEYBOARD_MODIFIER_RIGHTSHIFT);
-        
-        // Konvertiert den Keycode in ein ASCII-Zeichen
-        uint8_t ch = keycode2ascii[report->keycode[i]][is_shift ? 1 : 0];
+      if (!find_key_in_report(prev_report, report->keycode[i])) {
+        // Konvertiert den Keycode layoutabhängig in ein ASCII-Zeichen
+        // (flache Tabelle aus keymap.h, Index aus Modifier-Ebene und Keycode)
+        uint8_t ch = keymap_decode(report->modifier, report->keycode[i]);
 
         if ( ch == '\r' ) {
           // finalize barcode
           // Enter-Taste erkannt: Barcode ist komplett
-          if (barcode_len > 0) {
-            barcode_buf[barcode_len] = '\0';  // Null-Terminierung
-            
-            // Zeigt den Barcode auf dem LCD an
-            lcd_1602_i2c_show_barcode(barcode_buf);
-            
-            // Send to Ethernet (UART0 -> CH9121) with newline
-            // Sendet den Barcode über Ethernet mit Zeilenumbruch
-            char line[80];
-            snprintf(line, sizeof(line), "%s\n", barcode_buf);
-            net_send_line(line);
-            
-            // LED feedback
-            // LED-Feedback: LED für 3 Sekunden ausschalten
-            led_request_off_ms(3000);
-            
-            // Setzt den Barcode-Puffer zurück
-            barcode_len = 0;
+          // Fehllesungen (falsches Prüfzeichen) und Doppellesungen desselben Etiketts verwerfen,
+          // bevor sie LCD, UART und Datenbank belasten (gezählt in scan_check_get_stats() bzw.
+          // scan_dedup_get_stats()); die LED zeigt beides an, angenommene Scans quittiert die
+          // LED-Senke
+          if (slot->barcode_len > 0) {
+            scan_check_action_t const check = scan_check_code(slot->barcode_buf, slot->barcode_len);
+            if (check == SCAN_CHECK_DROP) {
+              led_signal(LED_PATTERN_ERROR);
+            } else if (scan_dedup_check(slot->barcode_buf, slot->barcode_len, slot->dev_addr)) {
+              led_signal(LED_PATTERN_DUPLICATE);
+            } else {
+              // Veröffentlicht den Barcode für die Senken (LCD, Ethernet, LED)
+              // Ist der Ring voll, wird der Barcode verworfen und gezählt; USB wird nie blockiert
+              bool const ok = scan_ring_publish(slot->barcode_buf, slot->barcode_len, slot->dev_addr,
+                                                slot->instance, slot->t_first_us,
+                                                check == SCAN_CHECK_FLAG ? SCAN_FLAG_CHECK : 0);
+              scan_stats_scan(ok, slot->barcode_len);
+              if (ok) scan_dedup_record(slot->barcode_buf, slot->barcode_len, slot->dev_addr);
+            }
           }
+          // Setzt den Barcode-Puffer zurück
+          slot->barcode_len = 0;
         } else if (ch >= 32 && ch <= 126) {
           // Druckbare ASCII-Zeichen (Space bis Tilde)
           // Fügt das Zeichen zum Barcode-Puffer hinzu, wenn noch Platz ist
-          if (barcode_len < sizeof(barcode_buf)-1) {
-            barcode_buf[barcode_len++] = (char)ch;
+          if (slot->barcode_len == 0) slot->t_first_us = time_us_32();
+          bool const kept = slot->barcode_len < sizeof(slot->barcode_buf)-1;
+          if (kept) {
+            slot->barcode_buf[slot->barcode_len++] = (char)ch;
           }
+          scan_stats_char(kept);
           // Kurzes LED-Feedback für jedes empfangene Zeichen
-          led_request_off_ms(300);
+          led_signal(LED_PATTERN_KEY);
         } else {
           // ignore non-printable
           // Ignoriert nicht druckbare Zeichen
@@ -177,7 +233,7 @@ static void process_kbd_report(hid_keyboard_report_t const *report) {
     }
   }
   // Speichert den aktuellen Report für den nächsten Vergleich
-  prev_report = *report;
+  slot->prev_report = *report;
 }
 
 // Verarbeitet Maus-Reports (aktuell keine Aktion)
@@ -187,20 +243,19 @@ static void process_mouse_report(hid_mouse_report_t const * report) {
 }
 
 // Verarbeitet generische HID-Reports
-// Parameter dev_addr: USB-Geräteadresse
-// Parameter instance: Instanznummer des HID-Interface
+// Parameter slot: Zustand der HID-Schnittstelle (Report-Informationen, Assembler)
 // Parameter report: Zeiger auf die Report-Daten
 // Parameter len: Länge der Report-Daten
 // 
 // Diese Funktion wird für HID-Geräte aufgerufen, die kein Standard-Tastatur- oder
 // Maus-Protokoll verwenden. Prüft, ob das Gerät ein Tastatur-Usage hat und
 // verarbeitet es entsprechend.
-static void process_generic_report(uint8_t dev_addr, uint8_t instance, uint8_t const* report, uint16_t len) {
-  (void) dev_addr; (void) len;  // Ungenutzte Parameter
+static void process_generic_report(hid_slot_t* slot, uint8_t const* report, uint16_t len) {
+  (void) len;  // Ungenutzter Parameter
   
-  // Ruft die Report-Informationen für diese Instanz ab
-  uint8_t const rpt_count = hid_info[instance].report_count;
-  tuh_hid_report_info_t* rpt_info_arr = hid_info[instance].report_info;
+  // Ruft die Report-Informationen für diese Schnittstelle ab
+  uint8_t const rpt_count = slot->report_count;
+  tuh_hid_report_info_t* rpt_info_arr = slot->report_info;
   tuh_hid_report_info_t* rpt_info = NULL;
 
   // Ermittelt die passende Report-Info
@@ -223,7 +278,7 @@ static void process_generic_report(uint8_t dev_addr, uint8_t instance, uint8_t c
     switch (rpt_info->usage) {
       case HID_USAGE_DESKTOP_KEYBOARD:
         // Verarbeitet den Report als Tastatur-Report
-        process_kbd_report( (hid_keyboard_report_t const*) report );
+        process_kbd_report( slot, (hid_keyboard_report_t const*) report );
       break;
       default: break;
     }
@@ -0,0 +1,117 @@
+"""
+Erzeugt HID-Report-Traces für host_sim (siehe sim_main.c für das Format).
+
+Jeder Scanner tippt seine Barcodes als Folge von Tastendruck- und Loslass-Reports,
+abgeschlossen mit Enter. Die Keycodes werden aus demselben Layout zurückgerechnet,
+das tools/gen_keymap.py für die Firmware erzeugt.
+
+Beispiele:
+    python gen_trace.py --out burst.trace --scans 200 --rate 20
+    python gen_trace.py --out hub.trace --scanners 3 --scans 100 --rate 50 --length 13
+    python gen_trace.py --out poisson.trace --scanners 8 --scans 100 --rate 30 --poisson
+    python gen_trace.py --out misreads.trace --scans 200 --rate 20 --bad-check 0.1
+
+Reine Ziffernfolgen der GTIN-Längen (8, 12, 13, 14) erhalten eine gültige Prüfziffer, da die
+Firmware Scans mit falscher Prüfziffer verwirft (siehe scan_check.h); --bad-check erzeugt
+gezielt Fehllesungen.
+"""
+
+import argparse
+import os
+import random
+import sys
+
+sys.path.insert(0, os.path.join(os.path.dirname(os.path.abspath(__file__)), "..", "tools"))
+import gen_keymap  # noqa: E402
+
+ENTER = 0x28
+SHIFT = 0x02
+ALTGR = 0x40
+
+
+def reverse_map(layout):
+    """Zeichen -> (Modifier, Keycode), einfachste Variante zuerst."""
+    base, shift, altgr, _ = gen_keymap.LAYOUTS[layout]()
+    rev = {}
+    for mod, plane in ((0, base), (SHIFT, shift), (ALTGR, altgr)):
+        for code in sorted(plane):
+            c = plane[code]
+            if c is not None and c not in rev and 32 <= ord(c) <= 126:
+                rev[c] = (mod, code)
+    return rev
+
+
+GTIN_LENGTHS = (8, 12, 13, 14)
+
+
+def gtin_check(digits):
+    """Prüfziffer nach GTIN (Modulo 10, Gewichte 3/1 von rechts)."""
+    total = sum(int(d) * (3 if i % 2 == 0 else 1) for i, d in enumerate(reversed(digits)))
+    return str((10 - total % 10) % 10)
+
+
+def report(mod, code):
+    return f"{mod:02x} 00 {code:02x} 00 00 00 00 00"
+
+
+RELEASE = report(0, 0)
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Erzeugt einen HID-Trace für host_sim")
+    parser.add_argument("--out", required=True)
+    parser.add_argument("--layout", default="DE", choices=sorted(gen_keymap.LAYOUTS))
+    parser.add_argument("--scans", type=int, default=100, help="Scans pro Scanner")
+    parser.add_argument("--scanners", type=int, default=1, help="Scanner am Hub (Geräteadressen 1..N)")
+    parser.add_argument("--rate", type=float, default=10.0, help="Scans pro Sekunde und Scanner")
+    parser.add_argument("--length", type=int, default=13, help="Barcode-Länge")
+    parser.add_argument("--charset", default="0123456789", help="Zeichen der Barcodes")
+    parser.add_argument("--key-us", type=int, default=1000, help="Abstand der Reports (USB-Poll-Intervall)")
+    parser.add_argument("--poisson", action="store_true",
+                        help="Zufällige Abstände (Poisson-Prozess mit --rate) statt fester Periode")
+    parser.add_argument("--bad-check", type=float, default=0.0,
+                        help="Anteil der GTIN-Scans mit falscher Prüfziffer (Fehllesungen)")
+    parser.add_argument("--seed", type=int, default=1)
+    args = parser.parse_args()
+
+    rev = reverse_map(args.layout)
+    missing = [c for c in args.charset if c not in rev]
+    if missing:
+        parser.error(f"Zeichen im Layout {args.layout} nicht tippbar: {''.join(missing)}")
+
+    rng = random.Random(args.seed)
+    events = []
+    period = 1e6 / args.rate
+    for dev in range(1, args.scanners + 1):
+        # Scanner starten versetzt, damit sich ihre Reports verzahnen
+        t = int(period * (dev - 1) / args.scanners)
+        for _ in range(args.scans):
+            code = "".join(rng.choice(args.charset) for _ in range(args.length))
+            if code.isdigit() and args.length in GTIN_LENGTHS:
+                check = gtin_check(code[:-1])
+                if rng.random() < args.bad_check:
+                    check = str((int(check) + rng.randint(1, 9)) % 10)
+                code = code[:-1] + check
+            ts = t
+            for c in code:
+                mod, key = rev[c]
+                events.append((ts, dev, report(mod, key)))
+                events.append((ts + args.key_us, dev, RELEASE))
+                ts += 2 * args.key_us
+            events.append((ts, dev, report(0, ENTER)))
+            events.append((ts + args.key_us, dev, RELEASE))
+            # Ein Scanner tippt nie zwei Barcodes gleichzeitig
+            gap = rng.expovariate(1.0 / period) if args.poisson else period
+            t = max(t + int(gap), ts + 2 * args.key_us)
+
+    events.sort(key=lambda e: (e[0], e[1]))
+    with open(args.out, "w", newline="\n") as f:
+        f.write(f"# gen_trace.py layout={args.layout} scanners={args.scanners} scans={args.scans} "
+                f"rate={args.rate} length={args.length} key_us={args.key_us} poisson={int(args.poisson)} "
+                f"bad_check={args.bad_check}\n")
+        for ts, dev, rpt in events:
+            f.write(f"{ts} {dev} 0 {rpt}\n")
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,9 @@
+// Host-Simulation: Ersatz für bsp/board_api.h (TinyUSB Board-Support)
+
+#pragma once
+
+#include <stdint.h>
+
+void board_init(void);
+void board_init_after_tusb(void) __attribute__((weak));
+uint32_t board_millis(void);
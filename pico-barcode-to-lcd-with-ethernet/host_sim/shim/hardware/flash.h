@@ -0,0 +1,22 @@
+// Host-Simulation: Ersatz für hardware/flash.h (Flash als Speicherabbild in sim_hw.c)
+
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+
+#define FLASH_PAGE_SIZE (1u << 8)
+#define FLASH_SECTOR_SIZE (1u << 12)
+
+// Pico 2 W: 4 MB QSPI-Flash
+#ifndef PICO_FLASH_SIZE_BYTES
+#define PICO_FLASH_SIZE_BYTES (4u * 1024u * 1024u)
+#endif
+
+// XIP-Fenster: Lesezugriffe gehen direkt auf das Abbild
+extern uint8_t sim_flash_mem[PICO_FLASH_SIZE_BYTES];
+#define XIP_BASE ((uintptr_t)sim_flash_mem)
+
+// Löschen (0xFF) und Programmieren (nur 1 -> 0) wie beim NOR-Flash, mit Zeitbedarf
+void flash_range_erase(uint32_t flash_offs, size_t count);
+void flash_range_program(uint32_t flash_offs, const uint8_t *data, size_t count);
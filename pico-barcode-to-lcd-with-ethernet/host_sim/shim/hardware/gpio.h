@@ -0,0 +1,17 @@
+// Host-Simulation: Ersatz für hardware/gpio.h
+
+#pragma once
+
+#include <stdbool.h>
+
+#define GPIO_FUNC_UART 2
+#define GPIO_FUNC_I2C  3
+#define GPIO_IN  false
+#define GPIO_OUT true
+
+void gpio_init(unsigned pin);
+void gpio_set_function(unsigned pin, int fn);
+void gpio_set_dir(unsigned pin, bool out);
+void gpio_put(unsigned pin, bool value);
+bool gpio_get(unsigned pin);
+void gpio_pull_up(unsigned pin);
@@ -0,0 +1,34 @@
+// Host-Simulation: Ersatz für hardware/i2c.h
+// Blockierende Übertragungen und DMA-Frames laufen in sim_hw.c über ein
+// PCF8574/HD44780-Modell; die Busdauer folgt aus Baudrate und Bytezahl.
+
+#pragma once
+
+#include "pico/stdlib.h"
+
+typedef struct i2c_inst i2c_inst_t;
+extern i2c_inst_t *const sim_i2c0;
+extern i2c_inst_t *const sim_i2c1;
+#define i2c0 sim_i2c0
+#define i2c1 sim_i2c1
+
+typedef struct {
+    volatile uint32_t con, tar, sar, _pad0, data_cmd, ss_scl_hcnt, ss_scl_lcnt, fs_scl_hcnt, fs_scl_lcnt,
+        _pad1[2], intr_stat, intr_mask, raw_intr_stat, rx_tl, tx_tl, clr_intr, clr_rx_under, clr_rx_over,
+        clr_tx_over, clr_rd_req, clr_tx_abrt, clr_rx_done, clr_activity, clr_stop_det, clr_start_det,
+        clr_gen_call, enable, status, txflr, rxflr, sda_hold, tx_abrt_source, slv_data_nack_only, dma_cr,
+        dma_tdlr, dma_rdlr;
+} i2c_hw_t;
+
+#define I2C_IC_DATA_CMD_STOP_BITS          0x200
+#define I2C_IC_INTR_MASK_M_STOP_DET_BITS   0x200
+#define I2C_IC_INTR_MASK_M_TX_ABRT_BITS    0x040
+#define I2C_IC_INTR_STAT_R_STOP_DET_BITS   0x200
+#define I2C_IC_INTR_STAT_R_TX_ABRT_BITS    0x040
+#define I2C_IC_DMA_CR_TDMAE_BITS           0x002
+
+uint i2c_init(i2c_inst_t *i2c, uint baudrate);
+i2c_hw_t *i2c_get_hw(i2c_inst_t *i2c);
+uint i2c_get_index(i2c_inst_t *i2c);
+uint i2c_get_dreq(i2c_inst_t *i2c, bool is_tx);
+int i2c_write_blocking(i2c_inst_t *i2c, uint8_t addr, const uint8_t *src, size_t len, bool nostop);
@@ -0,0 +1,16 @@
+// Host-Simulation: Ersatz für hardware/irq.h
+// Ein Interrupt läuft auf dem Core, der ihn mit irq_set_enabled() freigegeben hat.
+
+#pragma once
+
+#include "pico/stdlib.h"
+
+#define UART0_IRQ 33
+#define UART1_IRQ 34
+#define I2C0_IRQ  36
+#define I2C1_IRQ  37
+
+typedef void (*irq_handler_t)(void);
+
+void irq_set_exclusive_handler(uint num, irq_handler_t handler);
+void irq_set_enabled(uint num, bool enabled);
@@ -0,0 +1,13 @@
+// Host-Simulation: Ersatz für hardware/sync.h
+
+#pragma once
+
+#include "hardware/irq.h"
+
+#define __mem_fence_release() __atomic_thread_fence(__ATOMIC_RELEASE)
+#define __mem_fence_acquire() __atomic_thread_fence(__ATOMIC_ACQUIRE)
+#define __dmb() __atomic_thread_fence(__ATOMIC_SEQ_CST)
+
+// Sperrt die Interrupts des aktuellen Cores; anstehende laufen bei restore_interrupts()
+uint32_t save_and_disable_interrupts(void);
+void restore_interrupts(uint32_t status);
@@ -0,0 +1,39 @@
+// Host-Simulation: Ersatz für hardware/uart.h (PL011-Modell in sim_hw.c)
+// uart_get_hw() aktualisiert fr aus dem Modell; direkte Schreibzugriffe auf dr
+// sieht die Simulation nicht, daher uart_putc_raw() verwenden.
+
+#pragma once
+
+#include "pico/stdlib.h"
+#include "hardware/irq.h"
+
+typedef struct uart_inst uart_inst_t;
+extern uart_inst_t *const sim_uart0;
+extern uart_inst_t *const sim_uart1;
+#define uart0 sim_uart0
+#define uart1 sim_uart1
+
+typedef struct {
+    volatile uint32_t dr, rsr, _pad0[4], fr, _pad1, ilpr, ibrd, fbrd, lcr_h, cr, ifls, imsc, ris, mis, icr, dmacr;
+} uart_hw_t;
+
+#define UART_UARTFR_BUSY_BITS 0x08
+#define UART_UARTFR_RXFE_BITS 0x10
+#define UART_UARTFR_TXFF_BITS 0x20
+#define UART_UARTFR_TXFE_BITS 0x80
+
+uart_hw_t *uart_get_hw(uart_inst_t *uart);
+uint uart_get_index(uart_inst_t *uart);
+uint uart_init(uart_inst_t *uart, uint baudrate);
+uint uart_set_baudrate(uart_inst_t *uart, uint baudrate);
+void uart_set_fifo_enabled(uart_inst_t *uart, bool enabled);
+void uart_set_irq_enables(uart_inst_t *uart, bool rx_has_data, bool tx_needs_data);
+bool uart_is_writable(uart_inst_t *uart);
+bool uart_is_readable(uart_inst_t *uart);
+bool uart_is_readable_within_us(uart_inst_t *uart, uint32_t us);
+void uart_putc_raw(uart_inst_t *uart, char c);
+void uart_putc(uart_inst_t *uart, char c);
+void uart_puts(uart_inst_t *uart, const char *s);
+void uart_write_blocking(uart_inst_t *uart, const uint8_t *src, size_t len);
+char uart_getc(uart_inst_t *uart);
+void uart_tx_wait_blocking(uart_inst_t *uart);
@@ -0,0 +1,11 @@
+// Host-Simulation: Ersatz für pico/cyw43_arch.h (nur die LED am CYW43)
+// Jeder Aufruf von cyw43_arch_gpio_put() wird gezählt und kostet SIM_CYW43_PUT_US.
+
+#pragma once
+
+#include <stdbool.h>
+
+#define CYW43_WL_GPIO_LED_PIN 0
+
+int cyw43_arch_init(void);
+void cyw43_arch_gpio_put(unsigned pin, bool value);
@@ -0,0 +1,13 @@
+// Host-Simulation: Ersatz für pico/flash.h
+// flash_safe_execute() sperrt die Interrupts des aufrufenden Cores und hält den anderen
+// Core bis zum Ende der Flash-Operation an (siehe sim_hw.c).
+
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define PICO_OK 0
+
+bool flash_safe_execute_core_init(void);
+int flash_safe_execute(void (*func)(void *), void *param, uint32_t enter_exit_timeout_ms);
@@ -0,0 +1,6 @@
+// Host-Simulation: Ersatz für pico/multicore.h
+// Core 1 wird nicht gestartet; host_sim ruft core1_setup()/core1_poll() selbst auf.
+
+#pragma once
+
+void multicore_launch_core1(void (*entry)(void));
@@ -0,0 +1,7 @@
+// Host-Simulation: Ersatz für pico/rand.h (fester Wert, Läufe bleiben reproduzierbar)
+
+#pragma once
+
+#include <stdint.h>
+
+static inline uint32_t get_rand_32(void) { return 0x5EED0001u; }
@@ -0,0 +1,27 @@
+// Host-Simulation: Ersatz für pico/stdlib.h
+// Nur die Teile des Pico SDK, die die Firmware verwendet; Zeit und Peripherie
+// werden von sim_hw.c über die virtuelle Uhr nachgebildet.
+
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+typedef unsigned int uint;
+
+#include "pico/time.h"
+#include "hardware/gpio.h"
+
+#define PICO_DEFAULT_I2C_SDA_PIN 4
+#define PICO_DEFAULT_I2C_SCL_PIN 5
+
+#define __not_in_flash_func(f) f
+#define __aligned(x) __attribute__((aligned(x)))
+#define __unused __attribute__((unused))
+#define count_of(a) (sizeof(a) / sizeof((a)[0]))
+
+// Busy-Wait-Schleifen: rückt die Uhr des aktuellen Cores vor und bedient Interrupts
+void tight_loop_contents(void);
+
+bool stdio_init_all(void);
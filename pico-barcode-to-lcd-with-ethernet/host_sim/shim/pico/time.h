@@ -0,0 +1,16 @@
+// Host-Simulation: Ersatz für pico/time.h (virtuelle Uhr pro Core)
+
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+
+typedef uint64_t absolute_time_t;
+
+uint32_t time_us_32(void);
+uint64_t time_us_64(void);
+absolute_time_t get_absolute_time(void);
+static inline uint32_t to_ms_since_boot(absolute_time_t t) { return (uint32_t)(t / 1000); }
+
+void sleep_us(uint64_t us);
+void sleep_ms(uint32_t ms);
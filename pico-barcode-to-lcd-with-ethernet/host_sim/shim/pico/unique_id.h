@@ -0,0 +1,15 @@
+// Host-Simulation: Ersatz für pico/unique_id.h (feste ID des simulierten Boards)
+
+#pragma once
+
+#include <stdint.h>
+
+#define PICO_UNIQUE_BOARD_ID_SIZE_BYTES 8
+
+typedef struct {
+    uint8_t id[PICO_UNIQUE_BOARD_ID_SIZE_BYTES];
+} pico_unique_board_id_t;
+
+static inline void pico_get_unique_board_id(pico_unique_board_id_t* id_out) {
+    for (int i = 0; i < PICO_UNIQUE_BOARD_ID_SIZE_BYTES; ++i) id_out->id[i] = (uint8_t)(0x51 + i);
+}
@@ -0,0 +1,47 @@
+// Host-Simulation: Ersatz für tusb.h (nur HID-Host)
+// Reports kommen aus einer Trace-Datei und werden in tuh_task() zum Trace-Zeitpunkt
+// an tuh_hid_report_received_cb() übergeben (siehe sim_tusb.c).
+
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define OPT_MCU_RP2040 1
+#define CFG_TUSB_MCU OPT_MCU_RP2040
+#define BOARD_TUH_MAX_SPEED 0
+#include "tusb_config.h"
+
+typedef struct {
+    uint8_t modifier;
+    uint8_t reserved;
+    uint8_t keycode[6];
+} hid_keyboard_report_t;
+
+typedef struct {
+    uint8_t buttons;
+    int8_t x, y, wheel, pan;
+} hid_mouse_report_t;
+
+typedef struct {
+    uint8_t report_id;
+    uint8_t usage;
+    uint16_t usage_page;
+} tuh_hid_report_info_t;
+
+enum { HID_ITF_PROTOCOL_NONE = 0, HID_ITF_PROTOCOL_KEYBOARD = 1, HID_ITF_PROTOCOL_MOUSE = 2 };
+
+#define HID_USAGE_PAGE_DESKTOP     0x01
+#define HID_USAGE_DESKTOP_KEYBOARD 0x06
+
+bool tuh_init(uint8_t rhport);
+void tuh_task(void);
+uint8_t tuh_hid_interface_protocol(uint8_t dev_addr, uint8_t idx);
+uint8_t tuh_hid_parse_report_descriptor(tuh_hid_report_info_t *arr, uint8_t arr_count, uint8_t const *desc_report,
+                                        uint16_t desc_len);
+bool tuh_hid_receive_report(uint8_t dev_addr, uint8_t idx);
+
+// Callbacks der Anwendung (hid_app.c)
+void tuh_hid_mount_cb(uint8_t dev_addr, uint8_t instance, uint8_t const *desc_report, uint16_t desc_len);
+void tuh_hid_umount_cb(uint8_t dev_addr, uint8_t instance);
+void tuh_hid_report_received_cb(uint8_t dev_addr, uint8_t instance, uint8_t const *report, uint16_t len);
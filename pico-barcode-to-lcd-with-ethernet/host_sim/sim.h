@@ -0,0 +1,138 @@
+// Host-Simulation: Schnittstelle zwischen Scheduler (sim_main.c), Peripheriemodellen
+// (sim_hw.c) und USB-Ersatz (sim_tusb.c)
+//
+// Jeder Core hat eine eigene virtuelle Uhr in Mikrosekunden. sim_main.c führt immer den
+// Core mit der kleineren Uhr einen Schleifendurchlauf weit aus; blockierende Aufrufe
+// (sleep, I2C, Busy-Wait) rücken nur die Uhr des aufrufenden Cores vor und bedienen
+// dabei dessen Interrupts.
+
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#define SIM_CORES 2
+
+// Kosten eines Zugriffs auf den CYW43 (SPI-Transaktion über PIO)
+#ifndef SIM_CYW43_PUT_US
+#define SIM_CYW43_PUT_US 20
+#endif
+
+// Dauer einer Flash-Operation (typische Werte des W25Q32 auf dem Pico 2 W)
+#ifndef SIM_FLASH_ERASE_US
+#define SIM_FLASH_ERASE_US 45000
+#endif
+#ifndef SIM_FLASH_PROGRAM_US
+#define SIM_FLASH_PROGRAM_US 400
+#endif
+
+// CH9121: Konfigurationspin und Zeiten des Modells
+// (Eintritt in den Konfigurationsmodus ist nicht dokumentiert; angenommener Wert)
+#define SIM_CH9121_CFG_PIN 14
+#define SIM_CH9121_RES_PIN 17
+#ifndef SIM_CH9121_ENTER_US
+#define SIM_CH9121_ENTER_US 20000
+#endif
+#ifndef SIM_CH9121_REPLY_US
+#define SIM_CH9121_REPLY_US 1000
+#endif
+#ifndef SIM_CH9121_SAVE_US
+#define SIM_CH9121_SAVE_US 30000
+#endif
+// Nach einem Reset über RES_PIN: Neustart bis das Modul wieder antwortet, dann Aufbau der
+// TCP-Verbindung (angenommene Werte); kürzere Pulse (Glitch bei gpio_init) zählen nicht
+#ifndef SIM_CH9121_BOOT_US
+#define SIM_CH9121_BOOT_US 200000
+#endif
+#ifndef SIM_CH9121_CONNECT_US
+#define SIM_CH9121_CONNECT_US 50000
+#endif
+#ifndef SIM_CH9121_RESET_MIN_US
+#define SIM_CH9121_RESET_MIN_US 100
+#endif
+
+// Zähler der Peripheriemodelle
+typedef struct {
+    uint64_t uart_tx_bytes;     // Über UART0 gesendete Bytes
+    uint64_t uart_rx_bytes;     // Von UART0 gelesene Bytes
+    uint64_t i2c_bytes;         // I2C-Datenbytes (ohne Adressbyte)
+    uint64_t i2c_xfers;         // I2C-Übertragungen (blockierend + DMA)
+    uint64_t i2c_bus_us;        // Busbelegung in Mikrosekunden
+    uint64_t lcd_instr;         // Vom HD44780 ausgeführte Befehle und Zeichen
+    uint64_t lcd_violations;    // Befehle, die vor Ablauf der Ausführungszeit eintrafen
+    uint64_t i2c_aborts;        // Eingespeiste Abbrüche von DMA-Frames (sim_i2c_set_abort())
+    uint64_t cyw43_puts;        // Aufrufe von cyw43_arch_gpio_put()
+    uint64_t irqs;              // Ausgeführte Interrupt-Handler
+    uint64_t flash_erases;      // Gelöschte 4-KB-Sektoren
+    uint64_t flash_programs;    // Programmierte 256-B-Seiten
+    uint64_t flash_lockout_us;  // Zeit, in der beide Cores für den Flash standen
+    uint64_t ch9121_cmds;       // Vom CH9121 beantwortete Konfigurationskommandos
+    uint64_t ch9121_saves;      // EEPROM-Schreibvorgänge des CH9121
+    uint64_t ch9121_resets;     // Resets des CH9121 über RES_PIN
+} sim_counters_t;
+
+extern sim_counters_t sim_counters;
+
+// Aktuell ausgeführter Core (0 oder 1)
+extern int sim_core;
+
+// Uhr eines Cores
+uint64_t sim_clock(int core);
+
+// Uhr des aktuellen Cores
+uint64_t sim_now(void);
+
+// Setzt die Uhr eines Cores (nur vorwärts)
+void sim_set_clock(int core, uint64_t t);
+
+// Rückt die Uhr des aktuellen Cores bis t vor und bedient unterwegs dessen Interrupts
+void sim_wait_until(uint64_t t);
+
+// Führt alle jetzt fälligen Interrupts des aktuellen Cores aus
+void sim_service_irqs(void);
+
+// Wird für jedes Byte aufgerufen, das UART0 vollständig verlassen hat
+// Parameter byte: Gesendetes Byte
+// Parameter t_us: Zeitpunkt des Stoppbits
+typedef void (*sim_uart_tx_cb_t)(uint8_t byte, uint64_t t_us);
+void sim_uart_set_tx_cb(sim_uart_tx_cb_t cb);
+
+// Stellt Bytes zum Zeitpunkt t_us in den UART0-Empfangspuffer
+void sim_uart_inject_rx(const uint8_t *data, size_t len, uint64_t t_us);
+
+// CH9121: Setzt einen Parameter im EEPROM des Modells (Set-Kommando und Datenbytes wie auf
+// der Leitung); ohne Aufruf gelten die Werkseinstellungen
+void sim_ch9121_set_param(uint8_t cmd, const uint8_t *data, size_t len);
+
+// I2C: Bricht jeden n-ten DMA-Frame (n = every, 0 = keinen) mitten in einem LCD-Byte mit NACK ab;
+// das HD44780-Modell bleibt dabei um ein Nibble versetzt
+void sim_i2c_set_abort(uint32_t every);
+
+// CH9121: Abfragen (Get-Kommandos) unbeantwortet lassen, wie Module ohne Rücklesen;
+// Set-Kommandos werden weiter übernommen und bestätigt
+void sim_ch9121_set_no_query(bool no_query);
+
+// CH9121: Verbindung zum Server unterbrechen
+// Parameter outage_start/_end: Kabel bzw. Server weg; das Modul meldet keine Verbindung
+//                              und baut danach selbst neu auf (UINT64_MAX = nie)
+// Parameter half_open: ab diesem Zeitpunkt kommt nichts mehr durch, das Modul meldet aber
+//                      weiterhin eine Verbindung; endet erst mit einem Reset (UINT64_MAX = nie)
+void sim_ch9121_set_link(uint64_t outage_start, uint64_t outage_end, uint64_t half_open);
+
+// CH9121: true, wenn zum Zeitpunkt t_us Bytes zwischen Modul und Server durchkommen
+bool sim_ch9121_link_up(uint64_t t_us);
+
+// Wird aufgerufen, wenn der HD44780 ein Zeichen in das DDRAM geschrieben hat
+typedef void (*sim_lcd_cb_t)(uint64_t t_us);
+void sim_lcd_set_cb(sim_lcd_cb_t cb);
+
+// Liest eine Displayzeile des HD44780-Modells (16 Zeichen + Null)
+void sim_lcd_row(int row, char out[17]);
+
+// USB: Stellt einen HID-Tastatur-Report zum Zeitpunkt t_us bereit
+// Das Gerät wird beim ersten Report automatisch gemountet.
+void sim_usb_push_report(uint64_t t_us, uint8_t dev_addr, uint8_t instance, const uint8_t report[8]);
+
+// USB: true, solange noch nicht zugestellte Reports anstehen
+bool sim_usb_pending(void);
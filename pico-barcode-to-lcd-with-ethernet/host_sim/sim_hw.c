@@ -0,0 +1,754 @@
+// Host-Simulation: virtuelle Uhr, Interrupts und Peripheriemodelle
+//
+// Modelliert wird nur, was für Latenz und Busverkehr zählt:
+//  - UART (PL011): 32 Byte FIFO + Schieberegister, 8N1, TX-Interrupt bei <= 4 Bytes,
+//    RX-Interrupt ab 4 Bytes oder nach 32 Bitzeiten Pause
+//  - I2C + DMA: Busdauer 9 Bit pro Byte, DMA-Frames enden mit STOP_DET-Interrupt
+//  - PCF8574 + HD44780: dekodiert den Pinzustands-Strom (4-Bit-Modus, Enable-Flanken),
+//    führt DDRAM nach und zählt Befehle, die vor Ablauf der Ausführungszeit eintreffen
+//  - CYW43-LED: jeder Zugriff kostet SIM_CYW43_PUT_US
+// Interne Zeiten der Modelle sind in Nanosekunden, damit sich Bytezeiten nicht aufrunden.
+
+#include "sim.h"
+#include "pico/stdlib.h"
+#include "pico/multicore.h"
+#include "pico/cyw43_arch.h"
+#include "hardware/uart.h"
+#include "hardware/i2c.h"
+#include "hardware/dma.h"
+#include "hardware/irq.h"
+#include "hardware/sync.h"
+#include "hardware/flash.h"
+#include "pico/flash.h"
+#include "bsp/board_api.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define SIM_NEVER UINT64_MAX
+
+sim_counters_t sim_counters;
+int sim_core = 0;
+
+static uint64_t sim_clk[SIM_CORES];         // Uhr pro Core in Mikrosekunden
+static bool sim_irq_masked[SIM_CORES];      // Interrupts gesperrt oder Handler aktiv
+
+static inline uint64_t sim_now_ns(void) { return sim_clk[sim_core] * 1000u; }
+static inline uint64_t ns_to_us_ceil(uint64_t ns) { return (ns + 999u) / 1000u; }
+
+uint64_t sim_clock(int core) { return sim_clk[core]; }
+uint64_t sim_now(void) { return sim_clk[sim_core]; }
+
+void sim_set_clock(int core, uint64_t t) {
+    if (t > sim_clk[core]) sim_clk[core] = t;
+}
+
+// ============================================================================
+// Interrupt-Controller
+// ============================================================================
+
+#define SIM_IRQ_COUNT 64
+
+static irq_handler_t irq_handler[SIM_IRQ_COUNT];
+static bool irq_on[SIM_IRQ_COUNT];
+static uint8_t irq_core[SIM_IRQ_COUNT];
+
+void irq_set_exclusive_handler(uint num, irq_handler_t handler) { irq_handler[num] = handler; }
+
+void irq_set_enabled(uint num, bool enabled) {
+    irq_on[num] = enabled;
+    irq_core[num] = (uint8_t)sim_core;
+}
+
+uint32_t save_and_disable_interrupts(void) {
+    uint32_t const prev = sim_irq_masked[sim_core];
+    sim_irq_masked[sim_core] = true;
+    return prev;
+}
+
+void restore_interrupts(uint32_t status) {
+    sim_irq_masked[sim_core] = status != 0;
+    if (!status) sim_service_irqs();
+}
+
+// ============================================================================
+// UART (PL011)
+// ============================================================================
+
+#define SIM_UART_RX_MAX 4096
+
+struct uart_inst {
+    uint8_t index;
+    uint32_t baud;
+    uint64_t byte_ns;           // 10 Bit (8N1)
+    uint64_t tx_end_ns;         // Ende des letzten gepufferten Bytes
+    bool fifo;
+    bool tx_irq, rx_irq;
+    uint8_t rx_buf[SIM_UART_RX_MAX];
+    uint64_t rx_t[SIM_UART_RX_MAX];
+    uint32_t rx_head, rx_tail;
+    uart_hw_t hw;
+};
+
+static struct uart_inst sim_uart_inst[2] = { { .index = 0 }, { .index = 1 } };
+uart_inst_t *const sim_uart0 = &sim_uart_inst[0];
+uart_inst_t *const sim_uart1 = &sim_uart_inst[1];
+
+static sim_uart_tx_cb_t uart_tx_cb;
+static bool ch9121_cfg_byte(uint8_t byte, uint64_t t_us);
+
+void sim_uart_set_tx_cb(sim_uart_tx_cb_t cb) { uart_tx_cb = cb; }
+
+// Belegung von FIFO + Schieberegister zum Zeitpunkt t
+static uint32_t uart_tx_level(const uart_inst_t *u, uint64_t t_ns) {
+    if (u->tx_end_ns <= t_ns) return 0;
+    return (uint32_t)((u->tx_end_ns - t_ns + u->byte_ns - 1) / u->byte_ns);
+}
+
+static inline uint32_t uart_tx_cap(const uart_inst_t *u) { return u->fifo ? 33u : 2u; }
+
+// Anzahl jetzt lesbarer Bytes
+static uint32_t uart_rx_avail(const uart_inst_t *u, uint64_t t_ns) {
+    uint32_t n = 0;
+    for (uint32_t i = u->rx_tail; i != u->rx_head && u->rx_t[i % SIM_UART_RX_MAX] <= t_ns; i++) n++;
+    return n;
+}
+
+// Zeitpunkt, ab dem der UART-Interrupt ansteht (SIM_NEVER = keiner)
+static uint64_t uart_irq_time(const uart_inst_t *u) {
+    uint64_t t = SIM_NEVER;
+
+    if (u->tx_irq) {
+        uint64_t const thr = 4u * u->byte_ns;
+        t = (u->tx_end_ns > thr) ? u->tx_end_ns - thr : 0;
+    }
+    if (u->rx_irq && u->rx_tail != u->rx_head) {
+        // Schwelle 4 Bytes, sonst Timeout nach 32 Bitzeiten seit dem letzten Byte
+        uint32_t const n = u->rx_head - u->rx_tail;
+        uint64_t const t4 = (n >= 4) ? u->rx_t[(u->rx_tail + 3) % SIM_UART_RX_MAX] : SIM_NEVER;
+        uint64_t const tto = u->rx_t[(u->rx_head - 1) % SIM_UART_RX_MAX] + u->byte_ns * 32u / 10u;
+        uint64_t const trx = t4 < tto ? t4 : tto;
+        if (trx < t) t = trx;
+    }
+    return t;
+}
+
+void sim_uart_inject_rx(const uint8_t *data, size_t len, uint64_t t_us) {
+    uart_inst_t *u = sim_uart0;
+    uint64_t t = t_us * 1000u;
+
+    // Bytes folgen im Abstand einer Bytezeit, frühestens nach dem zuletzt eingestellten
+    if (u->rx_head != u->rx_tail && u->rx_t[(u->rx_head - 1) % SIM_UART_RX_MAX] > t) {
+        t = u->rx_t[(u->rx_head - 1) % SIM_UART_RX_MAX];
+    }
+    for (size_t i = 0; i < len; ++i) {
+        if (u->rx_head - u->rx_tail >= SIM_UART_RX_MAX) break;
+        uint32_t const pos = u->rx_head % SIM_UART_RX_MAX;
+        t += u->byte_ns ? u->byte_ns : 1000u;
+        u->rx_buf[pos] = data[i];
+        u->rx_t[pos] = t;
+        u->rx_head++;
+    }
+}
+
+uint uart_set_baudrate(uart_inst_t *uart, uint baudrate) {
+    uart->baud = baudrate;
+    uart->byte_ns = 10000000000ull / baudrate;
+    return baudrate;
+}
+
+uint uart_init(uart_inst_t *uart, uint baudrate) {
+    uart->fifo = true;
+    uart->tx_irq = uart->rx_irq = false;
+    uart->tx_end_ns = sim_now_ns();
+    return uart_set_baudrate(uart, baudrate);
+}
+
+uint uart_get_index(uart_inst_t *uart) { return uart->index; }
+
+void uart_set_fifo_enabled(uart_inst_t *uart, bool enabled) { uart->fifo = enabled; }
+
+void uart_set_irq_enables(uart_inst_t *uart, bool rx_has_data, bool tx_needs_data) {
+    uart->rx_irq = rx_has_data;
+    uart->tx_irq = tx_needs_data;
+}
+
+bool uart_is_writable(uart_inst_t *uart) { return uart_tx_level(uart, sim_now_ns()) < uart_tx_cap(uart); }
+
+bool uart_is_readable(uart_inst_t *uart) { return uart_rx_avail(uart, sim_now_ns()) > 0; }
+
+void uart_putc_raw(uart_inst_t *uart, char c) {
+    // Blockiert, bis im FIFO wieder Platz ist
+    while (!uart_is_writable(uart)) {
+        uint64_t const free_at = uart->tx_end_ns - (uint64_t)(uart_tx_cap(uart) - 1) * uart->byte_ns;
+        uint64_t const t = ns_to_us_ceil(free_at);
+        sim_wait_until(t > sim_now() ? t : sim_now() + 1);
+    }
+    uint64_t const now = sim_now_ns();
+    uint64_t const start = uart->tx_end_ns > now ? uart->tx_end_ns : now;
+    uart->tx_end_ns = start + uart->byte_ns;
+    if (uart->index == 0) {
+        sim_counters.uart_tx_bytes++;
+        if (ch9121_cfg_byte((uint8_t)c, ns_to_us_ceil(uart->tx_end_ns))) return;
+        if (uart_tx_cb) uart_tx_cb((uint8_t)c, ns_to_us_ceil(uart->tx_end_ns));
+    }
+}
+
+void uart_putc(uart_inst_t *uart, char c) { uart_putc_raw(uart, c); }
+
+void uart_puts(uart_inst_t *uart, const char *s) {
+    while (*s) uart_putc(uart, *s++);
+}
+
+void uart_write_blocking(uart_inst_t *uart, const uint8_t *src, size_t len) {
+    for (size_t i = 0; i < len; ++i) uart_putc_raw(uart, (char)src[i]);
+}
+
+void uart_tx_wait_blocking(uart_inst_t *uart) { sim_wait_until(ns_to_us_ceil(uart->tx_end_ns)); }
+
+char uart_getc(uart_inst_t *uart) {
+    while (!uart_is_readable(uart)) {
+        if (uart->rx_tail == uart->rx_head) {
+            tight_loop_contents();
+        } else {
+            sim_wait_until(ns_to_us_ceil(uart->rx_t[uart->rx_tail % SIM_UART_RX_MAX]));
+        }
+    }
+    char const c = (char)uart->rx_buf[uart->rx_tail % SIM_UART_RX_MAX];
+    uart->rx_tail++;
+    if (uart->index == 0) sim_counters.uart_rx_bytes++;
+    return c;
+}
+
+bool uart_is_readable_within_us(uart_inst_t *uart, uint32_t us) {
+    uint64_t const deadline = sim_now() + us;
+    while (!uart_is_readable(uart)) {
+        if (sim_now() >= deadline) return false;
+        tight_loop_contents();
+    }
+    return true;
+}
+
+uart_hw_t *uart_get_hw(uart_inst_t *uart) {
+    uint64_t const now = sim_now_ns();
+    uint32_t const level = uart_tx_level(uart, now);
+    uint32_t fr = 0;
+
+    if (level) fr |= UART_UARTFR_BUSY_BITS;
+    if (level <= 1) fr |= UART_UARTFR_TXFE_BITS;
+    if (level >= uart_tx_cap(uart)) fr |= UART_UARTFR_TXFF_BITS;
+    if (!uart_rx_avail(uart, now)) fr |= UART_UARTFR_RXFE_BITS;
+    uart->hw.fr = fr;
+    return &uart->hw;
+}
+
+// ============================================================================
+// HD44780 hinter PCF8574
+// ============================================================================
+
+#define PCF_RS 0x01
+#define PCF_EN 0x04
+
+static struct {
+    uint8_t prev;               // Letzter Pinzustand des PCF8574
+    bool four_bit;              // Interface-Modus (nach Power-On 8 Bit)
+    bool have_high;             // Oberes Nibble bereits übernommen
+    uint8_t high;
+    uint8_t addr;               // DDRAM-Adresszähler
+    uint8_t ddram[128];
+    uint64_t busy_until_ns;     // Ende der Ausführungszeit des letzten Befehls
+} lcd = { .ddram = { 0 } };
+
+static sim_lcd_cb_t lcd_cb;
+
+void sim_lcd_set_cb(sim_lcd_cb_t cb) { lcd_cb = cb; }
+
+void sim_lcd_row(int row, char out[17]) {
+    for (int i = 0; i < 16; ++i) {
+        uint8_t const c = lcd.ddram[(row ? 0x40 : 0x00) + i];
+        out[i] = (c >= 32 && c <= 126) ? (char)c : '?';
+    }
+    out[16] = '\0';
+}
+
+// Führt einen vollständig übernommenen Befehl oder ein Zeichen aus
+static void lcd_exec(bool rs, uint8_t v, uint64_t t_ns) {
+    uint64_t exec_ns = 37000;
+
+    sim_counters.lcd_instr++;
+    if (rs) {
+        lcd.ddram[lcd.addr & 0x7F] = v;
+        lcd.addr = (uint8_t)((lcd.addr + 1) & 0x7F);
+        if (lcd_cb) lcd_cb(ns_to_us_ceil(t_ns));
+    } else if (v & 0x80) {
+        lcd.addr = v & 0x7F;
+    } else if (v & 0x40) {
+        // CGRAM-Adresse: nicht modelliert
+    } else if (v & 0x20) {
+        lcd.four_bit = !(v & 0x10);
+    } else if (v & 0x1C) {
+        // Cursor/Display-Shift, Display Control, Entry Mode: nicht modelliert
+    } else if (v & 0x02) {
+        lcd.addr = 0;
+        exec_ns = 1520000;
+    } else if (v & 0x01) {
+        memset(lcd.ddram, ' ', sizeof(lcd.ddram));
+        lcd.addr = 0;
+        exec_ns = 1520000;
+    } else if (v == 0) {
+        exec_ns = 0;
+    }
+    lcd.busy_until_ns = t_ns + exec_ns;
+}
+
+// Übernimmt einen neuen Pinzustand des PCF8574 (nach dem ACK des Bytes)
+static void lcd_feed(uint8_t pins, uint64_t t_ns) {
+    if ((lcd.prev & PCF_EN) && !(pins & PCF_EN)) {
+        // Fallende Enable-Flanke: Nibble D4-D7 übernehmen
+        uint8_t const nib = lcd.prev & 0xF0;
+        bool const rs = lcd.prev & PCF_RS;
+
+        if (!lcd.have_high && t_ns < lcd.busy_until_ns) sim_counters.lcd_violations++;
+        if (!lcd.four_bit) {
+            lcd_exec(rs, nib, t_ns);
+        } else if (!lcd.have_high) {
+            lcd.high = nib;
+            lcd.have_high = true;
+        } else {
+            lcd.have_high = false;
+            lcd_exec(rs, (uint8_t)(lcd.high | (nib >> 4)), t_ns);
+        }
+    }
+    lcd.prev = pins;
+}
+
+// ============================================================================
+// I2C + DMA
+// ============================================================================
+
+#define SIM_LCD_ADDR 0x27
+
+struct i2c_inst {
+    uint8_t index;
+    uint32_t baud;
+    uint64_t byte_ns;           // 8 Datenbits + ACK
+    uint64_t frame_end_ns;      // Ende des laufenden DMA-Frames (SIM_NEVER = keiner)
+    bool frame_aborted;         // Laufender DMA-Frame endet mit TX_ABRT
+    i2c_hw_t hw;
+};
+
+static uint32_t i2c_abort_every;            // Jeder n-te DMA-Frame wird abgebrochen (0 = keiner)
+static uint32_t i2c_dma_frames;
+
+void sim_i2c_set_abort(uint32_t every) { i2c_abort_every = every; }
+
+static struct i2c_inst sim_i2c_inst[2] = { { .index = 0, .frame_end_ns = SIM_NEVER },
+                                            { .index = 1, .frame_end_ns = SIM_NEVER } };
+i2c_inst_t *const sim_i2c0 = &sim_i2c_inst[0];
+i2c_inst_t *const sim_i2c1 = &sim_i2c_inst[1];
+
+uint i2c_init(i2c_inst_t *i2c, uint baudrate) {
+    i2c->baud = baudrate;
+    i2c->byte_ns = 9000000000ull / baudrate;
+    return baudrate;
+}
+
+i2c_hw_t *i2c_get_hw(i2c_inst_t *i2c) { return &i2c->hw; }
+uint i2c_get_index(i2c_inst_t *i2c) { return i2c->index; }
+uint i2c_get_dreq(i2c_inst_t *i2c, bool is_tx) { return i2c->index * 2u + (is_tx ? 0u : 1u); }
+
+// Legt eine Übertragung auf den Bus und speist die Bytes in das LCD-Modell
+// Rückgabe: Ende der Übertragung (STOP) in Nanosekunden
+static uint64_t i2c_bus_transfer(i2c_inst_t *i2c, uint8_t addr, const uint8_t *data, size_t len, uint64_t t0) {
+    uint64_t const bit_ns = i2c->byte_ns / 9u;
+
+    // START + Adressbyte, danach je Datenbyte 9 Bit, zum Schluss STOP
+    for (size_t i = 0; i < len; ++i) {
+        if (addr == SIM_LCD_ADDR) lcd_feed(data[i], t0 + bit_ns + (uint64_t)(i + 2) * i2c->byte_ns);
+    }
+    uint64_t const end = t0 + 2u * bit_ns + (uint64_t)(len + 1) * i2c->byte_ns;
+
+    sim_counters.i2c_bytes += len;
+    sim_counters.i2c_xfers++;
+    sim_counters.i2c_bus_us += (end - t0) / 1000u;
+    return end;
+}
+
+int i2c_write_blocking(i2c_inst_t *i2c, uint8_t addr, const uint8_t *src, size_t len, bool nostop) {
+    (void)nostop;
+    uint64_t const end = i2c_bus_transfer(i2c, addr, src, len, sim_now_ns());
+    sim_wait_until(ns_to_us_ceil(end));
+    return (int)len;
+}
+
+// Zeitpunkt des Frame-Endes (SIM_NEVER = kein Frame unterwegs)
+static uint64_t i2c_irq_time(const i2c_inst_t *i2c) { return i2c->frame_end_ns; }
+
+#define SIM_DMA_CHANNELS 12
+
+static struct {
+    bool claimed;
+    uint8_t size;               // enum dma_channel_transfer_size
+    volatile void *write_addr;
+} sim_dma[SIM_DMA_CHANNELS];
+
+int dma_claim_unused_channel(bool required) {
+    for (int i = 0; i < SIM_DMA_CHANNELS; ++i) {
+        if (!sim_dma[i].claimed) { sim_dma[i].claimed = true; return i; }
+    }
+    if (required) { fprintf(stderr, "sim: no free DMA channel\n"); exit(1); }
+    return -1;
+}
+
+dma_channel_config dma_channel_get_default_config(uint channel) {
+    (void)channel;
+    return (dma_channel_config){ .ctrl = DMA_SIZE_32 };
+}
+
+void channel_config_set_transfer_data_size(dma_channel_config *c, enum dma_channel_transfer_size size) { c->ctrl = size; }
+void channel_config_set_read_increment(dma_channel_config *c, bool incr) { (void)c; (void)incr; }
+void channel_config_set_write_increment(dma_channel_config *c, bool incr) { (void)c; (void)incr; }
+void channel_config_set_dreq(dma_channel_config *c, uint dreq) { (void)c; (void)dreq; }
+
+void dma_channel_configure(uint channel, const dma_channel_config *config, volatile void *write_addr,
+                           const volatile void *read_addr, uint transfer_count, bool trigger) {
+    sim_dma[channel].size = (uint8_t)config->ctrl;
+    sim_dma[channel].write_addr = write_addr;
+    if (trigger) dma_channel_transfer_from_buffer_now(channel, read_addr, transfer_count);
+}
+
+void dma_channel_transfer_from_buffer_now(uint channel, const volatile void *read_addr, uint32_t transfer_count) {
+    for (int k = 0; k < 2; ++k) {
+        i2c_inst_t *i2c = &sim_i2c_inst[k];
+        if (sim_dma[channel].write_addr != &i2c->hw.data_cmd) continue;
+
+        // IC_DATA_CMD-Wörter auf die Datenbytes reduzieren
+        static uint8_t bytes[4096];
+        uint32_t const n = transfer_count < sizeof(bytes) ? transfer_count : sizeof(bytes);
+        for (uint32_t i = 0; i < n; ++i) {
+            switch (sim_dma[channel].size) {
+            case DMA_SIZE_8:  bytes[i] = ((const volatile uint8_t *)read_addr)[i]; break;
+            case DMA_SIZE_16: bytes[i] = (uint8_t)((const volatile uint16_t *)read_addr)[i]; break;
+            default:          bytes[i] = (uint8_t)((const volatile uint32_t *)read_addr)[i]; break;
+            }
+        }
+        // Abbruch: nach der Hälfte, genauer nach dem oberen Nibble eines LCD-Bytes (6 Bytes je Byte)
+        uint32_t len = n;
+        i2c->frame_aborted = false;
+        if (i2c_abort_every && ++i2c_dma_frames % i2c_abort_every == 0 && n > 6) {
+            len = n / 2 / 6 * 6 + 3;
+            i2c->frame_aborted = true;
+            sim_counters.i2c_aborts++;
+        }
+        i2c->frame_end_ns = i2c_bus_transfer(i2c, (uint8_t)i2c->hw.tar, bytes, len, sim_now_ns());
+        return;
+    }
+    fprintf(stderr, "sim: DMA target not modelled\n");
+    exit(1);
+}
+
+bool dma_channel_is_busy(uint channel) {
+    for (int k = 0; k < 2; ++k) {
+        i2c_inst_t *i2c = &sim_i2c_inst[k];
+        if (sim_dma[channel].write_addr == &i2c->hw.data_cmd) return i2c->frame_end_ns != SIM_NEVER && i2c->frame_end_ns > sim_now_ns();
+    }
+    return false;
+}
+
+void dma_channel_abort(uint channel) { (void)channel; }
+
+// ============================================================================
+// Interrupt-Zustellung
+// ============================================================================
+
+// Nächster Interrupt-Zeitpunkt (ns) einer Quelle auf dem aktuellen Core
+static uint64_t irq_source_time(uint num) {
+    if (!irq_on[num] || irq_core[num] != sim_core || !irq_handler[num]) return SIM_NEVER;
+    switch (num) {
+    case UART0_IRQ: return uart_irq_time(sim_uart0);
+    case UART1_IRQ: return uart_irq_time(sim_uart1);
+    case I2C0_IRQ:  return i2c_irq_time(sim_i2c0);
+    case I2C1_IRQ:  return i2c_irq_time(sim_i2c1);
+    default:        return SIM_NEVER;
+    }
+}
+
+static void irq_run(uint num) {
+    sim_irq_masked[sim_core] = true;
+    sim_counters.irqs++;
+    irq_handler[num]();
+    sim_irq_masked[sim_core] = false;
+}
+
+// Frame-Ende eines I2C-Blocks: STOP_DET melden, falls freigegeben
+static void i2c_frame_done(i2c_inst_t *i2c, uint num) {
+    i2c->frame_end_ns = SIM_NEVER;
+    if (!(i2c->hw.intr_mask & I2C_IC_INTR_MASK_M_STOP_DET_BITS)) return;
+    i2c->hw.intr_stat = I2C_IC_INTR_STAT_R_STOP_DET_BITS;
+    if (i2c->frame_aborted && (i2c->hw.intr_mask & I2C_IC_INTR_MASK_M_TX_ABRT_BITS)) {
+        i2c->hw.intr_stat |= I2C_IC_INTR_STAT_R_TX_ABRT_BITS;
+    }
+    irq_run(num);
+    i2c->hw.intr_stat = 0;
+}
+
+void sim_service_irqs(void) {
+    static const uint sources[] = { UART0_IRQ, UART1_IRQ, I2C0_IRQ, I2C1_IRQ };
+
+    // DMA-Frames ohne aktiven Interrupt enden stillschweigend
+    for (int k = 0; k < 2; ++k) {
+        i2c_inst_t *i2c = &sim_i2c_inst[k];
+        uint const num = k ? I2C1_IRQ : I2C0_IRQ;
+        if (i2c->frame_end_ns <= sim_now_ns() && !(irq_on[num] && irq_handler[num])) i2c->frame_end_ns = SIM_NEVER;
+    }
+    if (sim_irq_masked[sim_core]) return;
+
+    for (int guard = 0; guard < 10000; ++guard) {
+        uint64_t const now = sim_now_ns();
+        bool ran = false;
+
+        for (size_t i = 0; i < count_of(sources); ++i) {
+            uint const num = sources[i];
+            if (irq_source_time(num) > now) continue;
+            if (num == I2C0_IRQ || num == I2C1_IRQ) {
+                i2c_frame_done(num == I2C0_IRQ ? sim_i2c0 : sim_i2c1, num);
+            } else {
+                irq_run(num);
+            }
+            ran = true;
+        }
+        if (!ran) return;
+    }
+    fprintf(stderr, "sim: interrupt storm on core %d at %llu us\n", sim_core, (unsigned long long)sim_now());
+    exit(1);
+}
+
+// Nächster Interrupt-Zeitpunkt (µs) des aktuellen Cores
+static uint64_t sim_next_irq_us(void) {
+    static const uint sources[] = { UART0_IRQ, UART1_IRQ, I2C0_IRQ, I2C1_IRQ };
+    uint64_t t = SIM_NEVER;
+
+    if (sim_irq_masked[sim_core]) return SIM_NEVER;
+    for (size_t i = 0; i < count_of(sources); ++i) {
+        uint64_t const ts = irq_source_time(sources[i]);
+        if (ts < t) t = ts;
+    }
+    return t == SIM_NEVER ? SIM_NEVER : ns_to_us_ceil(t);
+}
+
+void sim_wait_until(uint64_t t) {
+    for (;;) {
+        sim_service_irqs();
+        uint64_t const now = sim_clk[sim_core];
+        if (now >= t) return;
+        uint64_t const next = sim_next_irq_us();
+        sim_clk[sim_core] = (next > now && next < t) ? next : t;
+    }
+}
+
+// ============================================================================
+// CH9121 (Konfigurationsmodus)
+// ============================================================================
+
+static bool sim_gpio[64] = { [SIM_CH9121_CFG_PIN] = true, [SIM_CH9121_RES_PIN] = true };
+static uint64_t ch9121_cfg_low_us;          // CFG-Pin seit diesem Zeitpunkt low
+static uint64_t ch9121_res_low_us;          // RES-Pin seit diesem Zeitpunkt low
+static uint64_t ch9121_boot_us;             // Modul antwortet ab diesem Zeitpunkt wieder
+static uint64_t ch9121_outage_start = UINT64_MAX, ch9121_outage_end = UINT64_MAX;
+static uint64_t ch9121_half_open = UINT64_MAX;
+static bool ch9121_no_query;                // Get-Kommandos unbeantwortet lassen
+
+// Parameter im EEPROM, Index = Set-Kommando (0x10..0x21); Werkseinstellungen
+static uint8_t ch9121_param[0x22][4] = {
+    [0x10] = { 0 },                         // TCP-Server
+    [0x11] = { 192, 168, 1, 200 },
+    [0x12] = { 255, 255, 255, 0 },
+    [0x13] = { 192, 168, 1, 1 },
+    [0x14] = { 0xD0, 0x07 },                // 2000
+    [0x15] = { 192, 168, 1, 100 },
+    [0x16] = { 0xE8, 0x03 },                // 1000
+    [0x21] = { 0x80, 0x25, 0x00, 0x00 },    // 9600
+};
+
+static struct {
+    uint8_t buf[8];
+    size_t len;
+} ch9121_rx;
+
+// Datenbytes eines Set-Kommandos (0 = unbekannt)
+static size_t ch9121_param_len(uint8_t cmd) {
+    switch (cmd) {
+    case 0x10: return 1;
+    case 0x11: case 0x12: case 0x13: case 0x15: case 0x21: return 4;
+    case 0x14: case 0x16: return 2;
+    default: return 0;
+    }
+}
+
+// Set-Kommando zu einem Abfragekommando (0 = keins)
+static uint8_t ch9121_query_param(uint8_t cmd) {
+    if (cmd >= 0x60 && cmd <= 0x66) return (uint8_t)(cmd - 0x50);
+    return cmd == 0x71 ? 0x21 : 0;
+}
+
+void sim_ch9121_set_param(uint8_t cmd, const uint8_t *data, size_t len) {
+    if (ch9121_param_len(cmd) == len) memcpy(ch9121_param[cmd], data, len);
+}
+
+void sim_ch9121_set_no_query(bool no_query) {
+    ch9121_no_query = no_query;
+}
+
+void sim_ch9121_set_link(uint64_t outage_start, uint64_t outage_end, uint64_t half_open) {
+    ch9121_outage_start = outage_start;
+    ch9121_outage_end = outage_end;
+    ch9121_half_open = half_open;
+}
+
+// TCP-Verbindung aus Sicht des Moduls (eine halboffene zählt als verbunden)
+static bool ch9121_tcp_connected(uint64_t t_us) {
+    if (t_us < ch9121_boot_us + SIM_CH9121_CONNECT_US) return false;
+    return t_us < ch9121_outage_start || t_us >= ch9121_outage_end;
+}
+
+bool sim_ch9121_link_up(uint64_t t_us) {
+    return ch9121_tcp_connected(t_us) && t_us < ch9121_half_open && sim_gpio[SIM_CH9121_RES_PIN];
+}
+
+// RES-Pin: steigende Flanke nach ausreichend langem Puls startet das Modul neu
+static void ch9121_res_edge(bool value) {
+    uint64_t const now = sim_now();
+    if (!value) {
+        ch9121_res_low_us = now;
+        return;
+    }
+    if (now - ch9121_res_low_us < SIM_CH9121_RESET_MIN_US) return;
+    sim_counters.ch9121_resets++;
+    ch9121_boot_us = now + SIM_CH9121_BOOT_US;
+    ch9121_rx.len = 0;
+    if (ch9121_half_open <= now) ch9121_half_open = UINT64_MAX;
+}
+
+// Nimmt ein Byte von UART0 an, solange der CFG-Pin low ist
+// Rückgabe: false im Datenmodus (Byte geht an den Server)
+static bool ch9121_cfg_byte(uint8_t byte, uint64_t t_us) {
+    if (sim_gpio[SIM_CH9121_CFG_PIN]) {
+        ch9121_rx.len = 0;
+        return false;
+    }
+    // Noch nicht im Konfigurationsmodus oder im Neustart: Byte geht verloren
+    if (t_us < ch9121_cfg_low_us + SIM_CH9121_ENTER_US || t_us < ch9121_boot_us) return true;
+
+    // Kopf 57 AB suchen
+    if ((ch9121_rx.len == 0 && byte != 0x57) || (ch9121_rx.len == 1 && byte != 0xAB)) {
+        ch9121_rx.len = (byte == 0x57);
+        return true;
+    }
+    ch9121_rx.buf[ch9121_rx.len++] = byte;
+    if (ch9121_rx.len < 3) return true;
+
+    uint8_t const cmd = ch9121_rx.buf[2];
+    uint8_t const q = ch9121_query_param(cmd);
+    size_t const need = 3 + ch9121_param_len(cmd);
+    if (ch9121_rx.len < need) return true;
+    ch9121_rx.len = 0;
+
+    uint8_t const ack = 0xAA;
+    sim_counters.ch9121_cmds++;
+    if (q) {
+        if (ch9121_no_query) return true;
+        sim_uart_inject_rx(ch9121_param[q], ch9121_param_len(q), t_us + SIM_CH9121_REPLY_US);
+    } else if (ch9121_param_len(cmd)) {
+        memcpy(ch9121_param[cmd], &ch9121_rx.buf[3], ch9121_param_len(cmd));
+        sim_uart_inject_rx(&ack, 1, t_us + SIM_CH9121_REPLY_US);
+    } else if (cmd == 0x0D) {
+        sim_counters.ch9121_saves++;
+        sim_uart_inject_rx(&ack, 1, t_us + SIM_CH9121_SAVE_US);
+    } else if (cmd == 0x03) {
+        uint8_t const status = ch9121_tcp_connected(t_us) ? 0x01 : 0x00;
+        sim_uart_inject_rx(&status, 1, t_us + SIM_CH9121_REPLY_US);
+    } else if (cmd == 0x0E || cmd == 0x5E) {
+        sim_uart_inject_rx(&ack, 1, t_us + SIM_CH9121_REPLY_US);
+    }
+    return true;
+}
+
+// ============================================================================
+// Flash
+// ============================================================================
+
+uint8_t sim_flash_mem[PICO_FLASH_SIZE_BYTES];
+static uint64_t flash_busy_us;              // Zeitbedarf der laufenden flash_safe_execute()
+
+void flash_range_erase(uint32_t flash_offs, size_t count) {
+    if (flash_offs % FLASH_SECTOR_SIZE || count % FLASH_SECTOR_SIZE || flash_offs + count > PICO_FLASH_SIZE_BYTES) {
+        fprintf(stderr, "sim: flash_range_erase(0x%lx, %zu) not sector aligned\n", (unsigned long)flash_offs, count);
+        exit(1);
+    }
+    memset(&sim_flash_mem[flash_offs], 0xFF, count);
+    sim_counters.flash_erases += count / FLASH_SECTOR_SIZE;
+    flash_busy_us += SIM_FLASH_ERASE_US * (count / FLASH_SECTOR_SIZE);
+}
+
+void flash_range_program(uint32_t flash_offs, const uint8_t *data, size_t count) {
+    if (flash_offs % FLASH_PAGE_SIZE || count % FLASH_PAGE_SIZE || flash_offs + count > PICO_FLASH_SIZE_BYTES) {
+        fprintf(stderr, "sim: flash_range_program(0x%lx, %zu) not page aligned\n", (unsigned long)flash_offs, count);
+        exit(1);
+    }
+    // NOR-Flash: Programmieren kann Bits nur löschen
+    for (size_t i = 0; i < count; ++i) sim_flash_mem[flash_offs + i] &= data[i];
+    sim_counters.flash_programs += count / FLASH_PAGE_SIZE;
+    flash_busy_us += SIM_FLASH_PROGRAM_US * (count / FLASH_PAGE_SIZE);
+}
+
+bool flash_safe_execute_core_init(void) { return true; }
+
+// Der aufrufende Core läuft ohne Interrupts, der andere steht bis zum Ende still
+int flash_safe_execute(void (*func)(void *), void *param, uint32_t enter_exit_timeout_ms) {
+    (void)enter_exit_timeout_ms;
+    flash_busy_us = 0;
+    func(param);
+
+    // Uhr direkt vorrücken (ohne sim_wait_until), damit unterwegs kein Interrupt läuft
+    uint64_t const end = sim_clk[sim_core] + flash_busy_us;
+    sim_clk[sim_core] = end;
+    sim_set_clock(1 - sim_core, end);
+    sim_counters.flash_lockout_us += flash_busy_us;
+    return PICO_OK;
+}
+
+// ============================================================================
+// Zeit, GPIO, Board, CYW43
+// ============================================================================
+
+uint32_t time_us_32(void) { return (uint32_t)sim_now(); }
+uint64_t time_us_64(void) { return sim_now(); }
+absolute_time_t get_absolute_time(void) { return sim_now(); }
+void sleep_us(uint64_t us) { sim_wait_until(sim_now() + us); }
+void sleep_ms(uint32_t ms) { sim_wait_until(sim_now() + (uint64_t)ms * 1000u); }
+void tight_loop_contents(void) { sim_wait_until(sim_now() + 1); }
+
+void gpio_init(unsigned pin) { gpio_put(pin, false); }
+void gpio_set_function(unsigned pin, int fn) { (void)pin; (void)fn; }
+void gpio_set_dir(unsigned pin, bool out) { (void)pin; (void)out; }
+void gpio_put(unsigned pin, bool value) {
+    if (pin == SIM_CH9121_CFG_PIN && sim_gpio[pin] && !value) ch9121_cfg_low_us = sim_now();
+    if (pin == SIM_CH9121_RES_PIN && sim_gpio[pin] != value) ch9121_res_edge(value);
+    sim_gpio[pin] = value;
+}
+bool gpio_get(unsigned pin) { return sim_gpio[pin]; }
+void gpio_pull_up(unsigned pin) { (void)pin; }
+
+bool stdio_init_all(void) { return true; }
+void board_init(void) {}
+uint32_t board_millis(void) { return (uint32_t)(sim_now() / 1000u); }
+
+void multicore_launch_core1(void (*entry)(void)) { (void)entry; }
+
+int cyw43_arch_init(void) { return 0; }
+
+void cyw43_arch_gpio_put(unsigned pin, bool value) {
+    (void)pin; (void)value;
+    sim_counters.cyw43_puts++;
+    sim_wait_until(sim_now() + SIM_CYW43_PUT_US);
+}
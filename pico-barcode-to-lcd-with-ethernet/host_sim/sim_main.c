@@ -0,0 +1,529 @@
+// Host-Simulation der Firmware: Scheduler, Trace-Einspielung und Auswertung
+//
+// Aufruf:
+//   host_sim <trace> [--poll-us N] [--tail-ms N] [--ack-us N] [--outage START_MS:LEN_MS]
+//            [--half-open START_MS] [--flash FILE] [--ch9121-factory] [--ch9121-no-query] [--lcd-abort N] [--dump] [--verbose]
+//
+// Trace-Format (eine Zeile pro HID-Report, nach Zeit sortiert, '#' = Kommentar):
+//   <t_us> <dev_addr> <instance> <8 Report-Bytes hex>
+//   z.B. "1200 1 0 02 00 04 00 00 00 00 00" = Shift + 'a' an Gerät 1, Instanz 0
+// Zeiten sind relativ zum Ende der Initialisierung beider Cores.
+//
+// Die Simulation führt immer den Core mit der kleineren virtuellen Uhr einen
+// Schleifendurchlauf weit aus (core0_poll/core1_poll aus app.h). Jeder Durchlauf kostet
+// --poll-us plus die modellierte Zeit blockierender Aufrufe (I2C, UART, CYW43, sleep).
+// Gemessen werden pro Scan:
+//   - erster HID-Report -> Stoppbit des letzten Bytes seines Rahmens (Ende-zu-Ende)
+//   - Terminator (Enter) -> Barcode vollständig auf dem LCD
+//   - Terminator -> letztes Byte seines Rahmens
+// sowie Busverkehr (UART-/I2C-Bytes, CYW43-Zugriffe) und die Zähler der Firmware.
+// Ein Server-Modell übernimmt Einträge nur lückenlos in Nummernfolge (wie mysql_bridge.py)
+// und bestätigt jeden SCANS-Rahmen nach --ack-us mit einem kumulativen ACK (0 = nie);
+// PING-Rahmen beantwortet es ebenso nach --ack-us mit PONG.
+// Während --outage (ab Start der Auswertung) verwirft der CH9121 alle Bytes in beide
+// Richtungen und meldet keine TCP-Verbindung, wie beim Neuaufbau der Verbindung.
+// Ab --half-open kommt ebenfalls nichts mehr durch, das Modul meldet aber weiter eine
+// Verbindung (halboffen); erst ein Reset über RES_PIN stellt sie wieder her.
+// --flash lädt das Flash-Abbild (Scan-Journal) vor dem Start aus FILE und schreibt es am
+// Ende zurück; zwei Läufe hintereinander entsprechen einem Neustart der Firmware. Scans
+// früherer Starts, die der Server dann aus dem Journal erhält, zählen gesondert.
+// Das CH9121-Modell ist bereits wie ch9121_config (main.c) eingestellt (Warmstart);
+// mit --ch9121-factory startet es mit den Werkseinstellungen.
+// Mit --ch9121-no-query beantwortet es keine Abfragen (nur Set-Kommandos).
+// --lcd-abort N bricht jeden N-ten LCD-Frame mitten in einem Byte mit NACK ab.
+// Mit --dump schickt die Simulation nach dem Trace das Kommando "STATS" an die Firmware
+// und gibt deren Antwort (TEXT-Rahmen, siehe scan_stats.h) mit aus.
+
+#include "sim.h"
+#include "app.h"
+#include "keymap.h"
+#include "scan_ring.h"
+#include "net_uart.h"
+#include "lcd_1602_i2c.h"
+#include "core_stats.h"
+#include "net_frame.h"
+#include "net_tx.h"
+#include "scan_journal.h"
+#include "net_link.h"
+#include "hardware/flash.h"
+#include "CH9121.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+
+// Ein im Trace enthaltener Scan (aus den Reports dekodiert wie in hid_app.c)
+typedef struct {
+    char code[SCAN_CODE_MAX];
+    uint8_t dev_addr, instance;
+    uint64_t t_first;           // Erster Report mit neuem Tastendruck
+    uint64_t t_term;            // Report mit Enter
+    uint64_t t_uart;            // Stoppbit des letzten Rahmenbytes (0 = nicht angekommen)
+    uint64_t t_lcd;             // Barcode vollständig in Zeile 1 (0 = nie angezeigt)
+} sim_scan_t;
+
+static sim_scan_t *scans;
+static size_t scan_count, scan_cap;
+static size_t uart_cursor;      // Nächster erwarteter Scan auf UART0
+static size_t lcd_cursor;       // Ältester noch nicht angezeigter Scan
+static size_t uart_lost;        // Scans, die auf UART0 übersprungen wurden
+static size_t uart_unknown;     // Einträge ohne passenden Scan
+static size_t uart_frames;      // Empfangene SCANS-Rahmen
+
+// Server-Modell
+static uint64_t ack_us = 2000;              // Verzögerung der Bestätigung
+static uint64_t outage_start, outage_end;   // Verbindungsabbruch (absolute Zeiten)
+static uint64_t half_open = UINT64_MAX;     // Halboffene Verbindung ab (absolute Zeit)
+static size_t bridge_accepted, bridge_replayed, bridge_dups, bridge_gaps, bridge_acks, outage_bytes;
+
+// Empfangsstand pro Start der Firmware (wie mysql_bridge.py)
+typedef struct {
+    uint16_t boot;
+    uint32_t expected;          // Nächste erwartete Scan-Nummer
+} sim_bridge_boot_t;
+
+static sim_bridge_boot_t bridge_boots[16];
+static size_t bridge_boot_count;
+
+// Liefert den Empfangsstand eines Starts; ein neuer beginnt beim ersten Rahmen
+static sim_bridge_boot_t *bridge_boot_state(uint16_t boot, uint32_t first_seq) {
+    for (size_t i = 0; i < bridge_boot_count; ++i) {
+        if (bridge_boots[i].boot == boot) return &bridge_boots[i];
+    }
+    size_t const i = bridge_boot_count < 16 ? bridge_boot_count++ : 15;
+    bridge_boots[i] = (sim_bridge_boot_t){ boot, first_seq };
+    return &bridge_boots[i];
+}
+
+extern CH9121_Config ch9121_config;
+
+static uint16_t journal_boot;               // Startzähler der Firmware in diesem Lauf
+static bool sim_booted;
+static net_frame_parser_t uart_parser;
+static uint8_t uart_payload[NET_FRAME_PAYLOAD_MAX];
+
+// TEXT-Rahmen der Firmware (Statistik-Dump)
+static char dump_text[4096];
+static size_t dump_len;
+
+// Assembler-Zustand pro (dev_addr, instance) für die Dekodierung des Traces
+typedef struct {
+    uint8_t prev[8];
+    char buf[SCAN_CODE_MAX];
+    uint8_t len;
+    uint64_t t_first;
+} sim_kbd_t;
+
+static sim_kbd_t sim_kbd[256][4];
+
+static sim_scan_t *scan_add(void) {
+    if (scan_count == scan_cap) {
+        scan_cap = scan_cap ? scan_cap * 2 : 256;
+        scans = realloc(scans, scan_cap * sizeof(*scans));
+        if (!scans) { fprintf(stderr, "sim: out of memory\n"); exit(1); }
+    }
+    sim_scan_t *s = &scans[scan_count++];
+    memset(s, 0, sizeof(*s));
+    return s;
+}
+
+// Dekodiert einen Report wie process_kbd_report() und merkt sich fertige Scans
+static void trace_decode(uint64_t t, uint8_t dev, uint8_t inst, const uint8_t r[8]) {
+    sim_kbd_t *k = &sim_kbd[dev][inst & 3];
+
+    for (int i = 2; i < 8; ++i) {
+        if (!r[i] || memchr(&k->prev[2], r[i], 6)) continue;
+        uint8_t const ch = keymap_decode(r[0], r[i]);
+        if (ch == '\r') {
+            if (k->len) {
+                sim_scan_t *s = scan_add();
+                memcpy(s->code, k->buf, k->len);
+                s->dev_addr = dev;
+                s->instance = inst;
+                s->t_first = k->t_first;
+                s->t_term = t;
+                k->len = 0;
+            }
+        } else if (ch >= 32 && ch <= 126) {
+            if (k->len == 0) k->t_first = t;
+            if (k->len < SCAN_CODE_MAX - 1) k->buf[k->len++] = (char)ch;
+        }
+    }
+    memcpy(k->prev, r, 8);
+}
+
+// Liest den Trace und stellt die Reports ab t_offset ein
+// Rückgabe: Zeitpunkt des letzten Reports
+static uint64_t trace_load(const char *path, uint64_t t_offset) {
+    FILE *f = fopen(path, "r");
+    char line[256];
+    uint64_t t_last = t_offset;
+
+    if (!f) { perror(path); exit(1); }
+    while (fgets(line, sizeof(line), f)) {
+        unsigned long long t;
+        unsigned dev, inst, b[8];
+        if (line[0] == '#' || line[0] == '\n') continue;
+        if (sscanf(line, "%llu %u %u %x %x %x %x %x %x %x %x", &t, &dev, &inst,
+                   &b[0], &b[1], &b[2], &b[3], &b[4], &b[5], &b[6], &b[7]) != 11) {
+            fprintf(stderr, "sim: bad trace line: %s", line);
+            exit(1);
+        }
+        uint8_t r[8];
+        for (int i = 0; i < 8; ++i) r[i] = (uint8_t)b[i];
+        uint64_t const ts = t_offset + t;
+        if (ts < t_last) { fprintf(stderr, "sim: trace not sorted at t=%llu\n", t); exit(1); }
+        sim_usb_push_report(ts, (uint8_t)dev, (uint8_t)inst, r);
+        trace_decode(ts, (uint8_t)dev, (uint8_t)inst, r);
+        t_last = ts;
+    }
+    fclose(f);
+    return t_last;
+}
+
+// Ordnet einen empfangenen Barcode dem nächsten passenden Scan zu
+static void uart_match(const char *code, uint64_t t_us) {
+    for (size_t i = uart_cursor; i < scan_count; ++i) {
+        if (strcmp(scans[i].code, code) == 0) {
+            scans[i].t_uart = t_us;
+            uart_lost += i - uart_cursor;
+            uart_cursor = i + 1;
+            return;
+        }
+    }
+    uart_unknown++;
+}
+
+// UART0: Rahmen zusammensetzen, neue SCANS-Einträge den Scans zuordnen und bestätigen
+static void on_uart_byte(uint8_t byte, uint64_t t_us) {
+    if (!sim_booted) return;
+    if (!sim_ch9121_link_up(t_us)) {
+        outage_bytes++;
+        return;
+    }
+    if (!net_frame_parse(&uart_parser, byte)) return;
+
+    uint8_t const *p = uart_payload;
+    if (uart_parser.type == NET_FRAME_PING) {
+        uint64_t const t_pong = t_us + ack_us;
+        if (sim_ch9121_link_up(t_pong)) {
+            uint8_t frame[NET_FRAME_PAYLOAD_MAX + NET_FRAME_OVERHEAD];
+            sim_uart_inject_rx(frame, net_frame_wrap(frame, NET_FRAME_PONG, p, uart_parser.len), t_pong);
+        }
+        return;
+    }
+    if (uart_parser.type == NET_FRAME_TEXT && uart_parser.len >= 4) {
+        dump_len += (size_t)snprintf(dump_text + dump_len, sizeof(dump_text) - dump_len, "  %.*s\n",
+                                     (int)(uart_parser.len - 4), (const char *)&p[4]);
+        if (dump_len >= sizeof(dump_text)) dump_len = sizeof(dump_text) - 1;
+        return;
+    }
+    if (uart_parser.type != NET_FRAME_SCANS || uart_parser.len < NET_SCANS_HEAD) return;
+
+    uart_frames++;
+    uint16_t const boot = (uint16_t)(p[4] | p[5] << 8);
+    uint32_t seq = (uint32_t)p[10] | (uint32_t)p[11] << 8 | (uint32_t)p[12] << 16 | (uint32_t)p[13] << 24;
+    sim_bridge_boot_t *b = bridge_boot_state(boot, seq);
+    size_t pos = NET_SCANS_HEAD;
+    for (uint8_t n = p[14] & (uint8_t)~NET_SCANS_EARLIER; n; --n, ++seq) {
+        while (pos < uart_parser.len && (p[pos] & 0x80)) pos++;     // age_ms (LEB128)
+        if (pos + 3 > uart_parser.len) break;
+        char code[SCAN_CODE_MAX];
+        uint8_t len;
+        size_t const used = net_code_unpack(code, sizeof(code), &p[pos + 2], &len);
+        if (!used) break;
+        pos += 2 + used;
+        if (seq == b->expected) {
+            b->expected++;
+            bridge_accepted++;
+            // Scans früherer Starts (aus dem Journal) gehören nicht zu diesem Trace
+            if (boot == journal_boot) uart_match(code, t_us);
+            else bridge_replayed++;
+        } else if ((int32_t)(seq - b->expected) < 0) {
+            bridge_dups++;
+        } else {
+            bridge_gaps++;
+        }
+    }
+
+    // Kumulative Bestätigung (geht während eines Abbruchs verloren)
+    uint64_t const t_ack = t_us + ack_us;
+    if (ack_us && sim_ch9121_link_up(t_ack)) {
+        uint8_t ack[NET_ACK_LEN], frame[NET_ACK_LEN + NET_FRAME_OVERHEAD];
+        memcpy(ack, p, 6);
+        for (int i = 0; i < 4; ++i) ack[6 + i] = (uint8_t)(b->expected >> (8 * i));
+        sim_uart_inject_rx(frame, net_frame_wrap(frame, NET_FRAME_ACK, ack, sizeof(ack)), t_ack);
+        bridge_acks++;
+    }
+}
+
+// LCD: nach jedem DDRAM-Schreibzugriff prüfen, ob Zeile 1 jetzt einen Scan zeigt
+static void on_lcd_write(uint64_t t_us) {
+    char row[17], want[17];
+
+    if (!sim_booted) return;
+    sim_lcd_row(1, row);
+
+    // Neuester bereits terminierter Scan zuerst (ältere wurden ggf. übersprungen)
+    size_t end = lcd_cursor;
+    while (end < scan_count && scans[end].t_term <= t_us) end++;
+    for (size_t i = end; i-- > lcd_cursor;) {
+        snprintf(want, sizeof(want), "%-16.16s", scans[i].code);
+        if (strcmp(row, want) == 0) {
+            scans[i].t_lcd = t_us;
+            lcd_cursor = i + 1;
+            return;
+        }
+    }
+}
+
+static int cmp_u64(const void *a, const void *b) {
+    uint64_t const x = *(const uint64_t *)a, y = *(const uint64_t *)b;
+    return (x > y) - (x < y);
+}
+
+// Gibt min/p50/p99/max einer Latenzreihe aus
+static void print_latency(const char *name, uint64_t *v, size_t n) {
+    if (!n) { printf("  %-28s n=0\n", name); return; }
+    qsort(v, n, sizeof(*v), cmp_u64);
+    uint64_t sum = 0;
+    for (size_t i = 0; i < n; ++i) sum += v[i];
+    printf("  %-28s n=%zu min=%llu p50=%llu p99=%llu max=%llu avg=%llu us\n", name, n,
+           (unsigned long long)v[0], (unsigned long long)v[n / 2], (unsigned long long)v[(n * 99) / 100],
+           (unsigned long long)v[n - 1], (unsigned long long)(sum / n));
+}
+
+static void print_core(int core, uint64_t window_us) {
+    core_stats_t st;
+    core_stats_get((uint8_t)core, &st);
+    printf("  core %d: loops=%lu busy_loops=%lu busy=%.1f%% max_loop=%lu us\n", core, (unsigned long)st.loops,
+           (unsigned long)st.busy_loops, window_us ? 100.0 * (double)st.busy_us / (double)window_us : 0.0,
+           (unsigned long)st.max_loop_us);
+}
+
+static void usage(void) {
+    fprintf(stderr, "usage: host_sim <trace> [--poll-us N] [--tail-ms N] [--ack-us N] [--outage START_MS:LEN_MS] "
+                    "[--half-open START_MS] [--flash FILE] [--ch9121-factory] [--ch9121-no-query] "
+                    "[--lcd-abort N] [--dump] [--verbose]\n");
+    exit(2);
+}
+
+int main(int argc, char **argv) {
+    const char *trace = NULL, *flash = NULL;
+    uint64_t poll_us = 1, tail_ms = 500;
+    bool verbose = false, dump = false, factory = false, no_query = false;
+    uint32_t lcd_abort = 0;
+
+    for (int i = 1; i < argc; ++i) {
+        if (!strcmp(argv[i], "--poll-us") && i + 1 < argc) poll_us = strtoull(argv[++i], NULL, 0);
+        else if (!strcmp(argv[i], "--tail-ms") && i + 1 < argc) tail_ms = strtoull(argv[++i], NULL, 0);
+        else if (!strcmp(argv[i], "--ack-us") && i + 1 < argc) ack_us = strtoull(argv[++i], NULL, 0);
+        else if (!strcmp(argv[i], "--outage") && i + 1 < argc) {
+            char *end;
+            outage_start = strtoull(argv[++i], &end, 0) * 1000u;
+            outage_end = outage_start + (*end == ':' ? strtoull(end + 1, NULL, 0) * 1000u : 0);
+        }
+        else if (!strcmp(argv[i], "--half-open") && i + 1 < argc) half_open = strtoull(argv[++i], NULL, 0) * 1000u;
+        else if (!strcmp(argv[i], "--flash") && i + 1 < argc) flash = argv[++i];
+        else if (!strcmp(argv[i], "--ch9121-factory")) factory = true;
+        else if (!strcmp(argv[i], "--ch9121-no-query")) no_query = true;
+        else if (!strcmp(argv[i], "--lcd-abort") && i + 1 < argc) lcd_abort = (uint32_t)strtoul(argv[++i], NULL, 0);
+        else if (!strcmp(argv[i], "--verbose")) verbose = true;
+        else if (!strcmp(argv[i], "--dump")) dump = true;
+        else if (argv[i][0] == '-' || trace) usage();
+        else trace = argv[i];
+    }
+    if (!trace || !poll_us) usage();
+
+    // Ausgaben der Firmware (printf) nur mit --verbose
+    fflush(stdout);
+    int const saved_stdout = dup(STDOUT_FILENO);
+    if (!verbose) {
+        int const devnull = open("/dev/null", O_WRONLY);
+        dup2(devnull, STDOUT_FILENO);
+        close(devnull);
+    }
+
+    net_frame_parser_init(&uart_parser, uart_payload, sizeof(uart_payload));
+    sim_uart_set_tx_cb(on_uart_byte);
+    sim_lcd_set_cb(on_lcd_write);
+
+    // Flash gelöscht oder aus dem vorigen Lauf
+    memset(sim_flash_mem, 0xFF, sizeof(sim_flash_mem));
+    if (flash) {
+        FILE *f = fopen(flash, "rb");
+        if (f) {
+            if (fread(sim_flash_mem, 1, sizeof(sim_flash_mem), f) != sizeof(sim_flash_mem)) {
+                fprintf(stderr, "host_sim: %s: short flash image\n", flash);
+                return 1;
+            }
+            fclose(f);
+        }
+    }
+
+    // CH9121-EEPROM wie von einem früheren Start konfiguriert
+    if (!factory) {
+        CH9121_Config const *c = &ch9121_config;
+        uint8_t const port[2][2] = { { c->local_port & 0xFF, c->local_port >> 8 },
+                                     { c->target_port & 0xFF, c->target_port >> 8 } };
+        uint8_t const baud[4] = { c->baud_rate & 0xFF, (c->baud_rate >> 8) & 0xFF, (c->baud_rate >> 16) & 0xFF,
+                                  c->baud_rate >> 24 };
+        sim_ch9121_set_param(CMD_MODE, &c->mode, 1);
+        sim_ch9121_set_param(CMD_LOCAL_IP, c->local_ip, 4);
+        sim_ch9121_set_param(CMD_SUBNET_MASK, c->subnet_mask, 4);
+        sim_ch9121_set_param(CMD_GATEWAY, c->gateway, 4);
+        sim_ch9121_set_param(CMD_TARGET_IP1, c->target_ip, 4);
+        sim_ch9121_set_param(CMD_LOCAL_PORT1, port[0], 2);
+        sim_ch9121_set_param(CMD_TARGET_PORT1, port[1], 2);
+        sim_ch9121_set_param(CMD_UART1_BAUD1, baud, 4);
+    }
+
+    sim_ch9121_set_no_query(no_query);
+    sim_i2c_set_abort(lcd_abort);
+
+    // Initialisierung wie main(): Core 0, dann Core 1 ab dem Startzeitpunkt
+    sim_core = 0;
+    core0_setup();
+    sim_set_clock(1, sim_clock(0));
+    sim_core = 1;
+    core1_setup();
+    scan_journal_stats_t js;
+    scan_journal_get_stats(&js);
+    journal_boot = js.boot;
+
+    uint64_t const t_boot = (sim_clock(0) > sim_clock(1) ? sim_clock(0) : sim_clock(1));
+    sim_set_clock(0, t_boot);
+    sim_set_clock(1, t_boot);
+    uint64_t const t_last = trace_load(trace, t_boot);
+    outage_start += t_boot;
+    outage_end += t_boot;
+    if (half_open != UINT64_MAX) half_open += t_boot;
+    sim_ch9121_set_link(outage_start, outage_end, half_open);
+    uint64_t const t_end = t_last + tail_ms * 1000u;
+    // STATS-Kommando erst zum Zeitpunkt einstellen; der RX-Puffer des Modells ist eine
+    // Warteschlange, frühere ACKs dürfen nicht dahinter warten
+    uint64_t t_dump = dump ? t_last + tail_ms * 500u : UINT64_MAX;
+    sim_counters_t const setup = sim_counters;
+    memset(&sim_counters, 0, sizeof(sim_counters));
+    sim_booted = true;
+
+    while (sim_clock(0) < t_end || sim_clock(1) < t_end) {
+        sim_core = (sim_clock(0) <= sim_clock(1)) ? 0 : 1;
+        if (sim_now() >= t_dump) {
+            uint8_t cmd[5 + NET_FRAME_OVERHEAD];
+            sim_uart_inject_rx(cmd, net_frame_wrap(cmd, NET_FRAME_CMD, "STATS", 5), t_dump);
+            t_dump = UINT64_MAX;
+        }
+        sim_service_irqs();
+        if (sim_core == 0) core0_poll(); else core1_poll();
+        sim_wait_until(sim_now() + poll_us);
+    }
+
+    fflush(stdout);
+    dup2(saved_stdout, STDOUT_FILENO);
+    close(saved_stdout);
+
+    if (flash) {
+        FILE *f = fopen(flash, "wb");
+        if (!f || fwrite(sim_flash_mem, 1, sizeof(sim_flash_mem), f) != sizeof(sim_flash_mem)) {
+            fprintf(stderr, "host_sim: cannot write %s\n", flash);
+            return 1;
+        }
+        fclose(f);
+    }
+
+    // Auswertung
+    uint64_t *e2e = calloc(scan_count + 1, sizeof(uint64_t));
+    uint64_t *lcd = calloc(scan_count + 1, sizeof(uint64_t));
+    uint64_t *net = calloc(scan_count + 1, sizeof(uint64_t));
+    size_t n_e2e = 0, n_lcd = 0, n_net = 0;
+    for (size_t i = 0; i < scan_count; ++i) {
+        if (scans[i].t_uart) {
+            e2e[n_e2e++] = scans[i].t_uart - scans[i].t_first;
+            net[n_net++] = scans[i].t_uart - scans[i].t_term;
+        }
+        if (scans[i].t_lcd) lcd[n_lcd++] = scans[i].t_lcd - scans[i].t_term;
+    }
+    uint64_t const window = t_end - t_boot;
+
+    printf("host_sim: %s (layout %s, boot %llu us, window %llu us, poll %llu us)\n", trace, keymap_layout,
+           (unsigned long long)t_boot, (unsigned long long)window, (unsigned long long)poll_us);
+    // Die CH9121-Konfiguration läuft in core1_poll() weiter, ihre Kommandos fallen in die Auswertung
+    CH9121_Stats cs;
+    CH9121_get_stats(&cs);
+    printf("setup: ch9121 %s in %lu us (cmds=%llu retries=%lu timeouts=%lu written=%u eeprom saves=%llu), "
+           "flash programs=%llu erases=%llu\n",
+           cs.state == CH9121_DONE ? "configured" : cs.state == CH9121_FAILED ? "failed" : "unfinished",
+           (unsigned long)cs.config_us, (unsigned long long)(setup.ch9121_cmds + sim_counters.ch9121_cmds),
+           (unsigned long)cs.retries, (unsigned long)cs.timeouts, cs.written,
+           (unsigned long long)(setup.ch9121_saves + sim_counters.ch9121_saves),
+           (unsigned long long)setup.flash_programs, (unsigned long long)setup.flash_erases);
+    printf("scans: %zu in trace, %zu on UART in %zu frames, %zu lost, %zu unknown, %zu shown on LCD\n", scan_count,
+           n_net, uart_frames, uart_lost + (scan_count - uart_cursor), uart_unknown, n_lcd);
+    printf("bridge: accepted=%zu (%zu from earlier boots) acks=%zu duplicates=%zu out-of-order=%zu boots=%zu, "
+           "outage dropped %zu B\n", bridge_accepted, bridge_replayed, bridge_acks, bridge_dups, bridge_gaps,
+           bridge_boot_count, outage_bytes);
+    printf("latency:\n");
+    print_latency("first report -> UART done", e2e, n_e2e);
+    print_latency("terminator -> UART done", net, n_net);
+    print_latency("terminator -> LCD shown", lcd, n_lcd);
+
+    lcd_1602_i2c_stats_t ls;
+    net_uart_stats_t ns;
+    scan_ring_stats_t rs;
+    lcd_1602_i2c_get_stats(&ls);
+    net_uart_get_stats(&ns);
+    scan_ring_get_stats(&rs);
+
+    printf("bus:\n");
+    printf("  uart0: tx=%llu B rx=%llu B (%.1f B/scan, %.2f scans/frame, crc errors=%lu)\n",
+           (unsigned long long)sim_counters.uart_tx_bytes, (unsigned long long)sim_counters.uart_rx_bytes,
+           scan_count ? (double)sim_counters.uart_tx_bytes / (double)scan_count : 0.0,
+           uart_frames ? (double)n_net / (double)uart_frames : 0.0, (unsigned long)uart_parser.crc_errors);
+    printf("  i2c0:  %llu B in %llu xfers, %llu us bus (%.1f B/scan), lcd instr=%llu violations=%llu "
+           "aborts=%llu\n", (unsigned long long)sim_counters.i2c_bytes, (unsigned long long)sim_counters.i2c_xfers,
+           (unsigned long long)sim_counters.i2c_bus_us,
+           scan_count ? (double)sim_counters.i2c_bytes / (double)scan_count : 0.0,
+           (unsigned long long)sim_counters.lcd_instr, (unsigned long long)sim_counters.lcd_violations,
+           (unsigned long long)sim_counters.i2c_aborts);
+    printf("  cyw43: %llu puts, irqs=%llu\n", (unsigned long long)sim_counters.cyw43_puts,
+           (unsigned long long)sim_counters.irqs);
+    printf("firmware:\n");
+    printf("  scan_ring: published=%lu overflows=%lu high_water=%lu\n", (unsigned long)rs.published,
+           (unsigned long)rs.overflows, (unsigned long)rs.high_water);
+    printf("  net_uart: tx=%lu dropped=%lu/%lu msgs high_water=%u\n", (unsigned long)ns.tx_bytes,
+           (unsigned long)ns.dropped_bytes, (unsigned long)ns.dropped_msgs, ns.high_water);
+    net_tx_stats_t ts;
+    net_tx_get_stats(&ts);
+    printf("  net_tx: frames=%lu records=%lu retransmits=%lu timeouts=%lu fast=%lu acks=%lu dup_acks=%lu "
+           "in_flight=%u window_high=%u\n", (unsigned long)ts.frames, (unsigned long)ts.records,
+           (unsigned long)ts.retransmits, (unsigned long)ts.timeouts, (unsigned long)ts.fast_retransmits,
+           (unsigned long)ts.acks, (unsigned long)ts.dup_acks, ts.in_flight, ts.window_high);
+    net_link_stats_t lk;
+    net_link_get_stats(&lk);
+    printf("  net_link: state=%d pings=%lu pongs=%lu degraded=%lu downs=%lu status=%lu (%lu unanswered) "
+           "resets=%lu (model %llu) reconnects=%lu last=%lu ms max=%lu ms reset->up=%lu ms\n", (int)lk.state,
+           (unsigned long)lk.pings, (unsigned long)lk.pongs, (unsigned long)lk.degraded, (unsigned long)lk.downs,
+           (unsigned long)lk.status_queries, (unsigned long)lk.status_failures, (unsigned long)lk.resets,
+           (unsigned long long)sim_counters.ch9121_resets, (unsigned long)lk.reconnects,
+           (unsigned long)lk.last_reconnect_ms, (unsigned long)lk.max_reconnect_ms, (unsigned long)lk.last_reset_ms);
+    scan_journal_get_stats(&js);
+    printf("  journal: boot=%u appended=%lu replayed=%lu trimmed=%lu recovered=%lu live=%lu pages=%u "
+           "programs=%lu erases=%lu forced=%lu full=%lu errors=%lu\n", js.boot, (unsigned long)js.appended,
+           (unsigned long)js.replayed, (unsigned long)js.trimmed, (unsigned long)js.recovered,
+           (unsigned long)js.live, js.pages_used, (unsigned long)js.programs, (unsigned long)js.erases,
+           (unsigned long)js.forced_erases, (unsigned long)js.full, (unsigned long)js.flash_errors);
+    printf("  flash: erases=%llu programs=%llu lockout=%llu us\n", (unsigned long long)sim_counters.flash_erases,
+           (unsigned long long)sim_counters.flash_programs, (unsigned long long)sim_counters.flash_lockout_us);
+    printf("  lcd: bursts=%lu frames=%lu bytes=%lu bus=%lu us aborts=%u\n", (unsigned long)ls.bursts,
+           (unsigned long)ls.frames, (unsigned long)ls.bytes, (unsigned long)ls.bus_us, ls.aborts);
+    print_core(0, window);
+    print_core(1, window);
+    if (dump) printf("device dump:\n%s", dump_text);
+
+    free(e2e);
+    free(lcd);
+    free(net);
+    return 0;
+}
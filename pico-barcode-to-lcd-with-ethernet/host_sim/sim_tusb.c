@@ -0,0 +1,73 @@
+// Host-Simulation: TinyUSB-Host-Ersatz
+//
+// Die Reports einer Trace-Datei werden vorab eingestellt und in tuh_task() zugestellt,
+// sobald die Uhr von Core 0 ihren Zeitpunkt erreicht hat. Jede (dev_addr, instance)
+// meldet sich als Boot-Tastatur und wird vor ihrem ersten Report gemountet.
+
+#include "sim.h"
+#include "tusb.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+typedef struct {
+    uint64_t t_us;
+    uint8_t dev_addr;
+    uint8_t instance;
+    uint8_t report[8];
+} sim_usb_event_t;
+
+static sim_usb_event_t *usb_events;
+static size_t usb_count, usb_cap, usb_next;
+
+// Gemountete Schnittstellen (Bit pro Instanz, Index = Geräteadresse)
+static uint32_t usb_mounted[256];
+
+void sim_usb_push_report(uint64_t t_us, uint8_t dev_addr, uint8_t instance, const uint8_t report[8]) {
+    if (usb_count == usb_cap) {
+        usb_cap = usb_cap ? usb_cap * 2 : 1024;
+        usb_events = realloc(usb_events, usb_cap * sizeof(*usb_events));
+        if (!usb_events) { fprintf(stderr, "sim: out of memory\n"); exit(1); }
+    }
+    sim_usb_event_t *ev = &usb_events[usb_count++];
+    ev->t_us = t_us;
+    ev->dev_addr = dev_addr;
+    ev->instance = instance;
+    memcpy(ev->report, report, 8);
+}
+
+bool sim_usb_pending(void) { return usb_next < usb_count; }
+
+bool tuh_init(uint8_t rhport) {
+    (void)rhport;
+    return true;
+}
+
+void tuh_task(void) {
+    while (usb_next < usb_count && usb_events[usb_next].t_us <= sim_now()) {
+        sim_usb_event_t const *ev = &usb_events[usb_next++];
+        uint32_t const bit = 1u << (ev->instance & 31);
+
+        if (!(usb_mounted[ev->dev_addr] & bit)) {
+            usb_mounted[ev->dev_addr] |= bit;
+            tuh_hid_mount_cb(ev->dev_addr, ev->instance, NULL, 0);
+        }
+        tuh_hid_report_received_cb(ev->dev_addr, ev->instance, ev->report, 8);
+    }
+}
+
+uint8_t tuh_hid_interface_protocol(uint8_t dev_addr, uint8_t idx) {
+    (void)dev_addr; (void)idx;
+    return HID_ITF_PROTOCOL_KEYBOARD;
+}
+
+uint8_t tuh_hid_parse_report_descriptor(tuh_hid_report_info_t *arr, uint8_t arr_count, uint8_t const *desc_report,
+                                        uint16_t desc_len) {
+    (void)arr; (void)arr_count; (void)desc_report; (void)desc_len;
+    return 0;
+}
+
+bool tuh_hid_receive_report(uint8_t dev_addr, uint8_t idx) {
+    (void)dev_addr; (void)idx;
+    return true;
+}
@@ -0,0 +1,35 @@
+// Layout-abhängige Keycode -> ASCII Tabelle (wird beim Build von tools/gen_keymap.py erzeugt)
+//
+// Flache Tabelle mit 4 Ebenen à 256 Keycodes:
+//   Ebene 0: ohne Modifier, 1: Shift, 2: AltGr, 3: Shift + AltGr
+// Das Layout wird über die CMake-Variable KEYBOARD_LAYOUT gewählt (z.B. DE, US).
+
+#pragma once
+
+#include <stdint.h>
+
+#define KEYMAP_PLANES   4
+#define KEYMAP_KEYCODES 256
+
+// Tabelle liegt im SRAM (nicht const -> .data), damit der Zugriff nicht über den XIP-Cache geht
+extern uint8_t keymap_table[KEYMAP_PLANES * KEYMAP_KEYCODES];
+
+// Name des eingebauten Layouts (z.B. "DE")
+extern const char keymap_layout[];
+
+// Offset der Modifier-Ebene für jedes Modifier-Byte (0, 256, 512 oder 768)
+// Shift:  LEFTSHIFT (0x02) oder RIGHTSHIFT (0x20)
+// AltGr:  RIGHTALT (0x40) oder LEFTCTRL + LEFTALT (0x01 + 0x04, Windows-Emulation)
+extern uint16_t keymap_plane_offset[256];
+
+// Berechnet den Tabellenindex ohne Verzweigungen
+// Parameter modifier: Modifier-Byte des HID-Tastatur-Reports
+// Parameter keycode: HID-Keycode
+static inline uint32_t keymap_index(uint8_t modifier, uint8_t keycode) {
+    return (uint32_t)keymap_plane_offset[modifier] + keycode;
+}
+
+// Dekodiert einen Keycode in ein ASCII-Zeichen (0 = kein druckbares Zeichen)
+static inline uint8_t keymap_decode(uint8_t modifier, uint8_t keycode) {
+    return keymap_table[keymap_index(modifier, keycode)];
+}
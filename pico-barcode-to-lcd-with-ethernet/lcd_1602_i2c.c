@@ -6,6 +6,9 @@
 
 #include "lcd_1602_i2c.h"
 #include "hardware/i2c.h"
+#include "hardware/dma.h"
+#include "hardware/irq.h"
+#include "hardware/sync.h"
 #include "pico/stdlib.h"
 #include <string.h>
 
@@ -66,58 +69,307 @@ static int lcd_addr = 0x27;
 #define LCD_MODE_CHAR 1          // Modus für Zeichen (RS=1)
 #define LCD_MODE_CMD  0          // Modus für Befehle (RS=0)
 
-// Schreibt ein einzelnes Byte über I2C an das LCD-Modul
-// Parameter val: Zu sendendes Byte (kombiniert Daten und Steuersignale)
-static void lcd_write_raw(uint8_t val) {
-    i2c_write_blocking(LCD_I2C_INSTANCE, lcd_addr, &val, 1, false);
+// Displaygröße
+#define LCD_ROWS 2
+#define LCD_COLS 16
+
+// I2C-Takt des LCD-Busses (PCF8574 unterstützt laut Datenblatt 100 kHz,
+// die gängigen Backpacks laufen in der Praxis problemlos mit 400 kHz Fast-Mode)
+#ifndef LCD_I2C_BAUD
+#define LCD_I2C_BAUD (400 * 1000)
+#endif
+
+// HD44780 Timing (Datenblatt, fosc = 270 kHz)
+#define LCD_T_EXEC_US     37     // Ausführungszeit der meisten Befehle und Zeichen
+#define LCD_T_CLEAR_US    1520   // Ausführungszeit von Clear Display / Return Home
+
+// Zeitbudget pro Aufruf von lcd_1602_i2c_task() in Mikrosekunden
+// Danach gibt der Renderer die CPU an die Hauptschleife (tuh_task) zurück.
+#ifndef LCD_TASK_BUDGET_US
+#define LCD_TASK_BUDGET_US 500
+#endif
+
+// Bytes pro übertragenem LCD-Byte: je Nibble Daten, Enable high, Enable low
+#define LCD_BYTES_PER_INSTR 6
+
+// Maximale Anzahl Füllbytes pro Befehl (reicht bis 1 MHz Fast-Mode Plus)
+#define LCD_PAD_MAX 4
+
+// Maximale Burst-Länge: Cursor-Befehl + 16 Zeichen inkl. Füllbytes
+#define LCD_BURST_MAX ((LCD_COLS + 1) * (LCD_BYTES_PER_INSTR + LCD_PAD_MAX))
+
+// DMA-Modus: Ein kompletter Frame (alle geänderten Zellen beider Zeilen) wird als
+// Pinzustands-Strom vorberechnet und per DMA (getaktet über den I2C-TX-DREQ) in den
+// I2C-FIFO geschoben. Das STOP_DET-Interrupt des I2C-Blocks markiert das Frame-Ende.
+// Mit LCD_USE_DMA=0 wird stattdessen blockierend in Bursts gesendet.
+#ifndef LCD_USE_DMA
+#define LCD_USE_DMA 1
+#endif
+
+// Maximale Frame-Länge: beide Zeilen vollständig neu
+#define LCD_FRAME_MAX (LCD_ROWS * LCD_BURST_MAX)
+
+// Abstand der Versuche, das LCD nach einem Abbruch neu zu initialisieren, solange es nicht antwortet
+#ifndef LCD_RESYNC_RETRY_US
+#define LCD_RESYNC_RETRY_US 1000000
+#endif
+
+// Shadow-Inhalt einer Zelle, deren Anzeige unbekannt ist (kommt im Framebuffer nie vor)
+#define LCD_CELL_UNKNOWN '\0'
+
+// Shadow-Framebuffer und Render-Queue
+// lcd_fb:     Soll-Inhalt, wird von lcd_1602_i2c_write_line() geschrieben (kein I2C-Verkehr)
+// lcd_shadow: Inhalt, der bereits auf dem Display steht
+// lcd_dirty:  Bitmaske pro Zeile, Bit n = Zelle n weicht vom Display ab
+// lcd_sent:     In die laufende Übertragung kodierte Zeichen
+// lcd_inflight: Bitmaske pro Zeile der Zellen in der laufenden Übertragung; sie gelten erst
+//               nach deren fehlerfreiem Ende als angezeigt (lcd_frame_end())
+static char lcd_fb[LCD_ROWS][LCD_COLS];
+static char lcd_shadow[LCD_ROWS][LCD_COLS];
+static uint16_t lcd_dirty[LCD_ROWS];
+static char lcd_sent[LCD_ROWS][LCD_COLS];
+static uint16_t lcd_inflight[LCD_ROWS];
+
+// Aktuelle DDRAM-Adresse des LCD-Cursors (wird nach jedem Zeichen automatisch erhöht)
+// 0xFF = unbekannt, d.h. vor dem nächsten Zeichen muss der Cursor gesetzt werden
+static uint8_t lcd_cursor = 0xFF;
+
+// Nach einem Abbruch mitten in einem Byte ist der 4-Bit-Modus des LCD um ein Nibble versetzt;
+// vor dem nächsten Frame läuft daher die Init-Sequenz erneut (frühestens ab lcd_resync_at)
+static bool lcd_resync = false;
+static uint32_t lcd_resync_at;
+
+// Busdauer eines I2C-Bytes (8 Datenbits + ACK) in Mikrosekunden, aufgerundet
+// Wird in lcd_1602_i2c_init() aus der tatsächlich eingestellten Baudrate berechnet.
+static uint32_t lcd_byte_us = 90;
+
+// Anzahl Füllbytes nach einem Befehl, damit das LCD ihn ausführen kann
+// Zwischen fallender Enable-Flanke und der nächsten steigenden liegen ohnehin
+// zwei Bytes auf dem Bus; nur die darüber hinausgehende Zeit wird aufgefüllt.
+static uint8_t lcd_pad_exec = 0;
+
+// Gemessene Busstatistik (siehe lcd_1602_i2c_get_stats())
+static lcd_1602_i2c_stats_t lcd_stats;
+
+#if LCD_USE_DMA
+// DMA-Zustand
+// lcd_dma_words: Frame im IC_DATA_CMD-Format (Bit 0-7 Daten, Bit 9 STOP beim letzten Wort)
+// lcd_dma_busy:  true vom Start des Frames bis zum STOP_DET-Interrupt
+static int lcd_dma_chan = -1;
+static uint16_t lcd_dma_words[LCD_FRAME_MAX];
+static volatile bool lcd_dma_busy = false;
+static volatile bool lcd_dma_aborted = false;
+static uint32_t lcd_dma_start_us;
+static uint16_t lcd_dma_len;
+
+// IRQ-Nummer des verwendeten I2C-Blocks
+#define LCD_I2C_IRQ (i2c_get_index(LCD_I2C_INSTANCE) ? I2C1_IRQ : I2C0_IRQ)
+#endif
+
+// Sendet einen Burst von PCF8574-Pinzuständen als eine einzige I2C-Übertragung
+// Parameter buf: Pinzustände in Sendereihenfolge
+// Parameter len: Anzahl Bytes
+// 
+// Der PCF8574 übernimmt jedes Byte direkt nach dessen ACK an seine Ausgänge,
+// daher erzeugt eine Mehrbyte-Übertragung dieselben Flanken wie Einzelschreibvorgänge,
+// aber nur einmal START, Adresse und STOP.
+// Rückgabe: false, wenn die Übertragung abgebrochen wurde (NACK)
+static bool lcd_write_burst(const uint8_t *buf, size_t len) {
+    uint32_t const t0 = time_us_32();
+    bool const ok = i2c_write_blocking(LCD_I2C_INSTANCE, lcd_addr, buf, len, false) == (int)len;
+    uint32_t const dt = time_us_32() - t0;
+
+    if (!ok) lcd_stats.aborts++;
+
+    lcd_stats.bursts++;
+    lcd_stats.bytes += len;
+    lcd_stats.bus_us += dt;
+    lcd_stats.last_burst_us = dt;
+    lcd_stats.last_burst_bytes = (uint16_t)len;
+    lcd_stats.last_frame_end_us = t0 + dt;
+    return ok;
 }
 
-// Erzeugt einen Enable-Puls für das LCD
-// Parameter val: Aktueller Datenwert
+#if LCD_USE_DMA
+// Interrupt-Handler des I2C-Blocks: Frame-Ende (STOP_DET) oder Abbruch (NACK)
 // 
-// Das LCD benötigt einen Enable-Puls (high-low) um Daten zu übernehmen.
-// Timing gemäß HD44780-Spezifikation: >450ns für Enable high, >450ns für Enable low
-static void lcd_toggle(uint8_t val) {
-    sleep_us(600);                               // Warte vor Enable-Puls
-    lcd_write_raw(val | LCD_ENABLE_BIT);         // Enable high
-    sleep_us(600);                               // Enable high halten
-    lcd_write_raw(val & ~LCD_ENABLE_BIT);        // Enable low
-    sleep_us(600);                               // Warte nach Enable-Puls
+// Bei einem Abbruch verwirft der I2C-Block den Rest des FIFOs und sendet selbst
+// ein STOP; der DMA-Kanal wird dann ebenfalls angehalten.
+static void lcd_i2c_irq_handler(void) {
+    i2c_hw_t *hw = i2c_get_hw(LCD_I2C_INSTANCE);
+    uint32_t const stat = hw->intr_stat;
+
+    if (stat & I2C_IC_INTR_STAT_R_TX_ABRT_BITS) {
+        (void)hw->clr_tx_abrt;
+        dma_channel_abort((uint)lcd_dma_chan);
+        lcd_dma_aborted = true;
+        lcd_stats.aborts++;
+    }
+    if (stat & I2C_IC_INTR_STAT_R_STOP_DET_BITS) {
+        (void)hw->clr_stop_det;
+        hw->intr_mask = 0;
+
+        uint32_t const now = time_us_32();
+        uint32_t const dt = now - lcd_dma_start_us;
+        lcd_stats.frames++;
+        lcd_stats.bursts++;
+        lcd_stats.bytes += lcd_dma_len;
+        lcd_stats.bus_us += dt;
+        lcd_stats.last_burst_us = dt;
+        lcd_stats.last_burst_bytes = lcd_dma_len;
+        lcd_stats.last_frame_end_us = now;
+        lcd_dma_busy = false;
+    }
 }
 
-// Sendet ein 8-Bit-Wert im 4-Bit-Modus an das LCD
+// Richtet DMA-Kanal und I2C-Interrupt für den Frame-Versand ein
+static void lcd_dma_init(void) {
+    i2c_hw_t *hw = i2c_get_hw(LCD_I2C_INSTANCE);
+
+    lcd_dma_chan = dma_claim_unused_channel(true);
+    dma_channel_config c = dma_channel_get_default_config((uint)lcd_dma_chan);
+    channel_config_set_transfer_data_size(&c, DMA_SIZE_16);
+    channel_config_set_read_increment(&c, true);
+    channel_config_set_write_increment(&c, false);
+    channel_config_set_dreq(&c, i2c_get_dreq(LCD_I2C_INSTANCE, true));
+    dma_channel_configure((uint)lcd_dma_chan, &c, &hw->data_cmd, lcd_dma_words, 0, false);
+
+    hw->dma_cr = I2C_IC_DMA_CR_TDMAE_BITS;
+    hw->intr_mask = 0;
+    irq_set_exclusive_handler(LCD_I2C_IRQ, lcd_i2c_irq_handler);
+    irq_set_enabled(LCD_I2C_IRQ, true);
+}
+
+// Startet den DMA-Versand eines vorberechneten Frames
+// Parameter frame: Pinzustände in Sendereihenfolge
+// Parameter len: Anzahl Bytes (>= 1)
+// 
+// Die CPU wandelt nur den Puffer ins IC_DATA_CMD-Format; den Bus bedient der DMA.
+static void lcd_dma_start(const uint8_t *frame, size_t len) {
+    i2c_hw_t *hw = i2c_get_hw(LCD_I2C_INSTANCE);
+
+    for (size_t i = 0; i < len; ++i) lcd_dma_words[i] = frame[i];
+    lcd_dma_words[len - 1] |= I2C_IC_DATA_CMD_STOP_BITS;
+    lcd_dma_len = (uint16_t)len;
+
+    // Zieladresse setzen (nur bei deaktiviertem I2C-Block möglich)
+    hw->enable = 0;
+    hw->tar = (uint32_t)lcd_addr;
+    hw->enable = 1;
+
+    (void)hw->clr_stop_det;
+    (void)hw->clr_tx_abrt;
+    lcd_dma_aborted = false;
+    lcd_dma_busy = true;
+    lcd_dma_start_us = time_us_32();
+    hw->intr_mask = I2C_IC_INTR_MASK_M_STOP_DET_BITS | I2C_IC_INTR_MASK_M_TX_ABRT_BITS;
+    dma_channel_transfer_from_buffer_now((uint)lcd_dma_chan, lcd_dma_words, len);
+}
+#endif
+
+// Wartet, bis ein laufender DMA-Frame abgeschlossen ist
+// Vor jeder blockierenden Übertragung nötig, da beide denselben I2C-Block nutzen.
+static void lcd_wait_idle(void) {
+#if LCD_USE_DMA
+    while (lcd_dma_busy) tight_loop_contents();
+#endif
+}
+
+// Kodiert ein Byte im 4-Bit-Modus als Pinzustands-Folge
+// Parameter out: Zielpuffer (mind. LCD_BYTES_PER_INSTR + pad Bytes)
 // Parameter value: Zu sendendes Byte
 // Parameter mode: LCD_MODE_CMD für Befehle, LCD_MODE_CHAR für Zeichen
+// Parameter pad: Anzahl zusätzlicher Füllbytes (Enable low) für die Ausführungszeit
+// Rückgabe: Anzahl geschriebener Bytes
 // 
-// Im 4-Bit-Modus werden 8 Bit in zwei 4-Bit-Nibbles gesendet:
-// Zuerst die oberen 4 Bits, dann die unteren 4 Bits
-static void lcd_send(uint8_t value, uint8_t mode) {
+// Zuerst die oberen 4 Bits, dann die unteren 4 Bits, jeweils: Daten anlegen,
+// Enable high, Enable low (fallende Flanke übernimmt das Nibble).
+// Bei >= 100 kHz dauert jedes Byte >= 22 us und erfüllt damit die HD44780-Pulsbreiten
+// (>= 450 ns Enable high/low, >= 1 us Zykluszeit) ohne zusätzliche Wartezeit.
+static size_t lcd_encode(uint8_t *out, uint8_t value, uint8_t mode, uint8_t pad) {
     // Obere 4 Bits: kombiniert mit Mode-Flag und Backlight
     uint8_t high = mode | (value & 0xF0) | LCD_BACKLIGHT;
     // Untere 4 Bits: nach links verschoben, kombiniert mit Mode-Flag und Backlight
     uint8_t low  = mode | ((value << 4) & 0xF0) | LCD_BACKLIGHT;
-    
-    lcd_write_raw(high); lcd_toggle(high);       // Sendet oberes Nibble
-    lcd_write_raw(low);  lcd_toggle(low);        // Sendet unteres Nibble
+    size_t n = 0;
+
+    out[n++] = high; out[n++] = high | LCD_ENABLE_BIT; out[n++] = high;
+    out[n++] = low;  out[n++] = low  | LCD_ENABLE_BIT; out[n++] = low;
+    while (pad--) out[n++] = low;
+    return n;
+}
+
+// Berechnet die Füllbytes für eine Ausführungszeit
+// Parameter exec_us: Ausführungszeit des Befehls laut Datenblatt
+static uint8_t lcd_pad_for(uint32_t exec_us) {
+    uint32_t bytes = (exec_us + lcd_byte_us - 1) / lcd_byte_us;
+    if (bytes <= 2) return 0;
+    return (bytes - 2 > LCD_PAD_MAX) ? LCD_PAD_MAX : (uint8_t)(bytes - 2);
+}
+
+// Sendet ein 8-Bit-Wert im 4-Bit-Modus an das LCD
+// Parameter value: Zu sendendes Byte
+// Parameter mode: LCD_MODE_CMD für Befehle, LCD_MODE_CHAR für Zeichen
+// Rückgabe: false, wenn die Übertragung abgebrochen wurde
+static bool lcd_send(uint8_t value, uint8_t mode) {
+    uint8_t buf[LCD_BYTES_PER_INSTR + LCD_PAD_MAX];
+    lcd_wait_idle();
+    return lcd_write_burst(buf, lcd_encode(buf, value, mode, lcd_pad_exec));
 }
 
 // Sendet einen Befehl an das LCD
 // Parameter cmd: LCD-Befehlsbyte
-static void lcd_command(uint8_t cmd) { lcd_send(cmd, LCD_MODE_CMD); }
-
-// Sendet ein Zeichen an das LCD
-// Parameter c: ASCII-Zeichen
-static void lcd_char(uint8_t c) { lcd_send(c, LCD_MODE_CHAR); }
+static bool lcd_command(uint8_t cmd) { return lcd_send(cmd, LCD_MODE_CMD); }
 
 // Löscht das gesamte Display und setzt den Cursor auf Position (0,0)
-void lcd_1602_i2c_clear(void) { lcd_command(LCD_CLEARDISPLAY); sleep_ms(2); }
+// Framebuffer und Render-Queue werden ebenfalls zurückgesetzt.
+void lcd_1602_i2c_clear(void) {
+    lcd_command(LCD_CLEARDISPLAY); sleep_us(LCD_T_CLEAR_US);
+
+    memset(lcd_fb, ' ', sizeof(lcd_fb));
+    memset(lcd_shadow, ' ', sizeof(lcd_shadow));
+    memset(lcd_dirty, 0, sizeof(lcd_dirty));
+    memset(lcd_inflight, 0, sizeof(lcd_inflight));
+    lcd_cursor = 0x00;
+}
+
+// Init-Sequenz nach HD44780-Spezifikation
+// Rückgabe: false, wenn das LCD nicht geantwortet hat (NACK)
+// 
+// Bringt das LCD aus jedem Zustand in den 4-Bit-Modus: nach dem Einschalten (8 Bit) ebenso
+// wie nach einem abgebrochenen Frame, der es um ein Nibble versetzt hat. Der DDRAM-Inhalt
+// bleibt erhalten.
+static bool lcd_init_sequence(void) {
+    bool ok = true;
+
+    // Sendet dreimal 0x03 im 8-Bit-Modus (Soft-Reset-Sequenz)
+    ok &= lcd_command(0x03); sleep_ms(5);
+    ok &= lcd_command(0x03); sleep_ms(5);
+    ok &= lcd_command(0x03); sleep_ms(5);
+    
+    // Wechselt in den 4-Bit-Modus
+    ok &= lcd_command(0x02); // 4-bit
+
+    // Konfiguriert das LCD: 4-Bit-Interface, 2 Zeilen, 5x8 Zeichen
+    ok &= lcd_command(LCD_FUNCTIONSET | LCD_2LINE);
+    
+    // Setzt Entry-Modus: Cursor bewegt sich nach rechts, kein Display-Shift
+    ok &= lcd_command(LCD_ENTRYMODESET | LCD_ENTRYLEFT);
+    
+    // Schaltet Display ein, Cursor aus, Blinken aus
+    ok &= lcd_command(LCD_DISPLAYCONTROL | LCD_DISPLAYON);
+    return ok;
+}
 
 // Initialisiert das LCD-Display
 // Führt die Initialisierungssequenz gemäß HD44780-Spezifikation durch
 void lcd_1602_i2c_init(void) {
-    // I2C Setup (100kHz ausreichend)
-    // Initialisiert die I2C-Schnittstelle mit 100 kHz
-    i2c_init(LCD_I2C_INSTANCE, 100 * 1000);
+    // I2C Setup
+    // Initialisiert die I2C-Schnittstelle mit LCD_I2C_BAUD (Standard 400 kHz) und
+    // leitet das Burst-Timing aus der tatsächlich eingestellten Baudrate ab
+    uint baud = i2c_init(LCD_I2C_INSTANCE, LCD_I2C_BAUD);
+    lcd_byte_us = (9u * 1000000u + baud - 1) / baud;
+    lcd_pad_exec = lcd_pad_for(LCD_T_EXEC_US);
     
     // Konfiguriert die GPIO-Pins für I2C-Funktion
     gpio_set_function(LCD_I2C_SDA_PIN, GPIO_FUNC_I2C);
@@ -127,69 +379,179 @@ void lcd_1602_i2c_init(void) {
     gpio_pull_up(LCD_I2C_SDA_PIN);
     gpio_pull_up(LCD_I2C_SCL_PIN);
 
+#if LCD_USE_DMA
+    // DMA-Kanal und I2C-Interrupt für den Frame-Versand
+    lcd_dma_init();
+#endif
+
     // Init Sequenz
     // Initialisierungssequenz nach Power-On (mind. 40ms warten)
     sleep_ms(50);
-    
-    // Sendet dreimal 0x03 im 8-Bit-Modus (Soft-Reset-Sequenz)
-    lcd_command(0x03); sleep_ms(5);
-    lcd_command(0x03); sleep_ms(5);
-    lcd_command(0x03); sleep_ms(5);
-    
-    // Wechselt in den 4-Bit-Modus
-    lcd_command(0x02); // 4-bit
-
-    // Konfiguriert das LCD: 4-Bit-Interface, 2 Zeilen, 5x8 Zeichen
-    lcd_command(LCD_FUNCTIONSET | LCD_2LINE);
-    
-    // Setzt Entry-Modus: Cursor bewegt sich nach rechts, kein Display-Shift
-    lcd_command(LCD_ENTRYMODESET | LCD_ENTRYLEFT);
-    
-    // Schaltet Display ein, Cursor aus, Blinken aus
-    lcd_command(LCD_DISPLAYCONTROL | LCD_DISPLAYON);
+    lcd_init_sequence();
     
     // Löscht das Display
     lcd_1602_i2c_clear();
 }
 
-// Setzt den Cursor auf eine bestimmte Position
+// Berechnet die DDRAM-Adresse einer Zelle
 // Parameter line: Zeilennummer (0 oder 1)
 // Parameter pos: Spaltenposition (0-15)
 // 
 // Das LCD verwendet DDRAM-Adressen: Zeile 0 beginnt bei 0x00, Zeile 1 bei 0x40
-static void lcd_set_cursor(uint8_t line, uint8_t pos) {
-    uint8_t addr = (line == 0) ? (0x80 + pos) : (0xC0 + pos);
-    lcd_command(addr);
+static inline uint8_t lcd_cell_addr(uint8_t line, uint8_t pos) {
+    return (line == 0) ? pos : (0x40 + pos);
+}
+
+// Kodiert die nächste Folge geänderter Zellen als Pinzustands-Strom
+// Parameter out: Zielpuffer
+// Parameter cap: Kapazität des Zielpuffers (mind. LCD_BURST_MAX für eine volle Zeile)
+// Parameter max_cells: Maximale Anzahl Zeichen in dieser Folge (>= 1)
+// Rückgabe: Anzahl geschriebener Bytes, 0 wenn das Display aktuell ist
+// 
+// Zusammenhängende geänderte Zellen einer Zeile werden hinter einem einzigen
+// Cursor-Befehl gesendet; liegt der Cursor bereits richtig, entfällt auch dieser.
+// Die Zellen wandern in lcd_inflight; der Shadow folgt erst mit lcd_frame_end().
+static size_t lcd_build_run(uint8_t *out, size_t cap, uint8_t max_cells) {
+    size_t const instr_max = LCD_BYTES_PER_INSTR + lcd_pad_exec;
+
+    for (uint8_t line = 0; line < LCD_ROWS; ++line) {
+        if (!lcd_dirty[line]) continue;
+
+        size_t n = 0;
+        uint8_t pos = (uint8_t)__builtin_ctz(lcd_dirty[line]);
+        uint8_t addr = lcd_cell_addr(line, pos);
+
+        if (cap < 2 * instr_max) return 0;  // Kein Platz für Cursor + ein Zeichen
+        if (lcd_cursor != addr) n += lcd_encode(&out[n], 0x80 | addr, LCD_MODE_CMD, lcd_pad_exec);
+
+        while (pos < LCD_COLS && (lcd_dirty[line] & (1u << pos)) && max_cells-- && n + instr_max <= cap) {
+            n += lcd_encode(&out[n], (uint8_t)lcd_fb[line][pos], LCD_MODE_CHAR, lcd_pad_exec);
+            lcd_sent[line][pos] = lcd_fb[line][pos];
+            lcd_inflight[line] |= (uint16_t)(1u << pos);
+            lcd_dirty[line] &= (uint16_t)~(1u << pos);
+            pos++;
+        }
+
+        lcd_cursor = lcd_cell_addr(line, pos);
+        return n;
+    }
+    return 0;
 }
 
-// Schreibt eine Textzeile auf das LCD
+// Schließt die letzte Übertragung ab (DMA: nach STOP_DET, aus lcd_1602_i2c_task())
+// Parameter ok: false, wenn sie abgebrochen wurde
+// 
+// Erst hier gelten die Zellen als angezeigt. Nach einem Abbruch ist ihr Inhalt unbekannt:
+// sie werden erneut markiert, Cursor und 4-Bit-Modus des LCD neu aufgesetzt.
+static void lcd_frame_end(bool ok) {
+    for (uint8_t line = 0; line < LCD_ROWS; ++line) {
+        for (uint8_t pos = 0; pos < LCD_COLS; ++pos) {
+            uint16_t const bit = (uint16_t)(1u << pos);
+            if (!(lcd_inflight[line] & bit)) continue;
+            lcd_shadow[line][pos] = ok ? lcd_sent[line][pos] : LCD_CELL_UNKNOWN;
+            // Während der Übertragung geschriebene Zeilen mit dem neuen Shadow vergleichen
+            if (lcd_fb[line][pos] != lcd_shadow[line][pos]) lcd_dirty[line] |= bit;
+            else lcd_dirty[line] &= (uint16_t)~bit;
+        }
+        lcd_inflight[line] = 0;
+    }
+    if (!ok) {
+        lcd_cursor = 0xFF;
+        lcd_resync = true;
+        lcd_resync_at = time_us_32();
+    }
+}
+
+// Setzt das LCD nach einem Abbruch neu auf, bevor wieder Zellen gesendet werden
+// Rückgabe: true, wenn gesendet werden darf
+// 
+// Blockiert für die Init-Sequenz (ca. 15 ms); antwortet das LCD nicht, folgt der nächste
+// Versuch erst nach LCD_RESYNC_RETRY_US.
+static bool lcd_resync_poll(void) {
+    if (!lcd_resync) return true;
+    if ((int32_t)(time_us_32() - lcd_resync_at) < 0) return false;
+    if (!lcd_init_sequence()) {
+        lcd_resync_at = time_us_32() + LCD_RESYNC_RETRY_US;
+        return false;
+    }
+    lcd_resync = false;
+    return true;
+}
+
+// Schreibt eine Textzeile in den Framebuffer
 // Parameter line: Zeilennummer (0 oder 1)
 // Parameter text: Null-terminierter String (max. 16 Zeichen)
 // 
-// Die Zeile wird mit Leerzeichen aufgefüllt, um vorherige Inhalte zu löschen
+// Die Zeile wird mit Leerzeichen aufgefüllt, um vorherige Inhalte zu löschen.
+// Es findet kein I2C-Verkehr statt: nur Zellen, die vom Display-Inhalt abweichen,
+// werden markiert und später von lcd_1602_i2c_task() gesendet.
 void lcd_1602_i2c_write_line(uint8_t line, const char* text) {
     if (line > 1) return;  // Ungültige Zeilennummer
     
-    lcd_set_cursor(line, 0);
-    
-    // Puffer für 16 Zeichen + Null-Terminierung
-    char buf[17];
     size_t len = strlen(text);
     
     // Begrenzt die Länge auf 16 Zeichen
-    if (len > 16) len = 16;
-    
-    // Kopiert den Text in den Puffer
-    memcpy(buf, text, len);
+    if (len > LCD_COLS) len = LCD_COLS;
     
-    // Füllt den Rest mit Leerzeichen auf
-    for (size_t i = len; i < 16; ++i) buf[i] = ' ';
-    buf[16] = '\0';
-    
-    // Sendet alle 16 Zeichen an das Display
-    for (size_t i = 0; i < 16; ++i) {
-        lcd_char(buf[i]);
+    uint16_t dirty = 0;
+    for (size_t i = 0; i < LCD_COLS; ++i) {
+        // Füllt den Rest mit Leerzeichen auf
+        char c = (i < len) ? text[i] : ' ';
+        lcd_fb[line][i] = c;
+        if (c != lcd_shadow[line][i]) dirty |= (uint16_t)(1u << i);
     }
+    lcd_dirty[line] = dirty;
+}
+
+// Arbeitet die Render-Queue ab (aus der Hauptschleife aufrufen)
+// 
+// DMA-Modus: Ist kein Frame unterwegs, werden alle geänderten Zellen beider Zeilen
+// in einen Frame kodiert und per DMA gestartet; die CPU-Kosten beschränken sich auf
+// das Aufbauen des Puffers.
+// Blockierender Modus: Die Burst-Länge wird so gewählt, dass ein Aufruf etwa
+// LCD_TASK_BUDGET_US auf dem Bus verbringt (mindestens ein Zeichen).
+void lcd_1602_i2c_task(void) {
+#if LCD_USE_DMA
+    static uint8_t frame[LCD_FRAME_MAX];
+    size_t n = 0, run;
+
+    if (lcd_dma_busy) return;
+    if (lcd_inflight[0] | lcd_inflight[1]) lcd_frame_end(!lcd_dma_aborted);
+    if (!lcd_resync_poll()) return;
+    while ((run = lcd_build_run(&frame[n], sizeof(frame) - n, LCD_COLS)) > 0) n += run;
+    if (n) lcd_dma_start(frame, n);
+#else
+    uint8_t buf[LCD_BURST_MAX];
+    uint32_t cells = LCD_TASK_BUDGET_US / (LCD_BYTES_PER_INSTR * lcd_byte_us);
+    if (!lcd_resync_poll()) return;
+    size_t n = lcd_build_run(buf, sizeof(buf), cells ? (uint8_t)(cells > LCD_COLS ? LCD_COLS : cells) : 1);
+    if (n) lcd_frame_end(lcd_write_burst(buf, n));
+#endif
+}
+
+// Sendet alle ausstehenden Änderungen und wartet, bis das Display aktuell ist
+void lcd_1602_i2c_flush(void) {
+    do {
+        lcd_wait_idle();
+        lcd_1602_i2c_task();
+    } while (lcd_1602_i2c_busy());
+}
+
+// Abfrage des Display-Zustands
+// Rückgabe: true, solange ein Frame übertragen wird oder Zellen auf Versand warten
+bool lcd_1602_i2c_busy(void) {
+#if LCD_USE_DMA
+    if (lcd_dma_busy) return true;
+#endif
+    return (lcd_dirty[0] | lcd_dirty[1] | lcd_inflight[0] | lcd_inflight[1]) != 0;
+}
+
+// Liefert die gemessene Busstatistik des LCD-Treibers
+// Parameter out: Zielstruktur
+void lcd_1602_i2c_get_stats(lcd_1602_i2c_stats_t *out) {
+    uint32_t const irq = save_and_disable_interrupts();
+    *out = lcd_stats;
+    restore_interrupts(irq);
 }
 
 // Zeigt einen gescannten Barcode auf dem LCD an
@@ -197,6 +559,8 @@ void lcd_1602_i2c_write_line(uint8_t line, const char* text) {
 // 
 // Zeile 0: "CODE:"
 // Zeile 1: Der Barcode (bis zu 16 Zeichen)
+// 
+// Aktualisiert nur den Framebuffer; die Übertragung erfolgt in lcd_1602_i2c_task().
 void lcd_1602_i2c_show_barcode(const char* code) {
     lcd_1602_i2c_write_line(0, "CODE:");
     lcd_1602_i2c_write_line(1, code);
@@ -4,6 +4,19 @@
 #pragma once
 
 #include <stdint.h>
+#include <stdbool.h>
+
+// Gemessene I2C-Busstatistik des LCD-Treibers
+typedef struct {
+    uint32_t bursts;            // Anzahl I2C-Übertragungen
+    uint32_t bytes;             // Gesendete PCF8574-Bytes
+    uint32_t bus_us;            // Summe der Busdauer aller Übertragungen
+    uint32_t last_burst_us;     // Dauer der letzten Übertragung
+    uint16_t last_burst_bytes;  // Länge der letzten Übertragung
+    uint16_t aborts;            // Abgebrochene Übertragungen (NACK), danach Neuinitialisierung
+    uint32_t frames;            // Per DMA übertragene Frames
+    uint32_t last_frame_end_us; // Zeitstempel (time_us_32) des Endes der letzten Übertragung
+} lcd_1602_i2c_stats_t;
 
 // Initialisiert I2C und das LCD (löscht Display)
 void lcd_1602_i2c_init(void);
@@ -12,7 +25,20 @@ void lcd_1602_i2c_init(void);
 void lcd_1602_i2c_clear(void);
 
 // Schreibt bis zu 16 Zeichen in eine Zeile (0 oder 1), kürzt falls länger.
+// Aktualisiert nur den Framebuffer, die Übertragung übernimmt lcd_1602_i2c_task().
 void lcd_1602_i2c_write_line(uint8_t line, const char* text);
 
 // Komfort: Zeigt einen Barcode (Zeile 0: "CODE:", Zeile 1: eigentlicher Code, gekürzt)
 void lcd_1602_i2c_show_barcode(const char* code);
+
+// Sendet geänderte Zellen in kleinen, zeitbegrenzten Schritten (aus der Hauptschleife aufrufen)
+void lcd_1602_i2c_task(void);
+
+// Sendet alle ausstehenden Änderungen und wartet, bis das Display aktuell ist
+void lcd_1602_i2c_flush(void);
+
+// true, solange ein Frame übertragen wird oder Zellen auf Versand warten
+bool lcd_1602_i2c_busy(void);
+
+// Liefert die gemessene Busstatistik (Übertragungen, Bytes, Busdauer)
+void lcd_1602_i2c_get_stats(lcd_1602_i2c_stats_t *out);
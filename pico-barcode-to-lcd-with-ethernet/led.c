@@ -0,0 +1,120 @@
+// LED-Rückmeldung über die CYW43-LED (siehe led.h)
+
+#include "led.h"
+#include "pico/cyw43_arch.h"
+#include "pico/time.h"
+#include <stdio.h>
+
+// Ein Schritt eines Musters
+typedef struct {
+    uint8_t on;                 // Pegel der LED
+    uint16_t ms;                // Dauer
+} led_step_t;
+
+typedef struct {
+    const led_step_t* steps;
+    uint8_t count;
+} led_pattern_def_t;
+
+static const led_step_t led_steps_key[]       = { {0, 300} };
+static const led_step_t led_steps_scan[]      = { {0, 3000} };
+static const led_step_t led_steps_duplicate[] = { {0, 250}, {1, 250}, {0, 250} };
+static const led_step_t led_steps_error[]     = { {0, 60}, {1, 60}, {0, 60}, {1, 60}, {0, 60}, {1, 60}, {0, 60},
+                                                  {1, 60}, {0, 60} };
+
+#define LED_STEPS(s) { s, sizeof(s) / sizeof(s[0]) }
+static const led_pattern_def_t led_patterns[LED_PATTERN_COUNT] = {
+    [LED_PATTERN_KEY]       = LED_STEPS(led_steps_key),
+    [LED_PATTERN_SCAN]      = LED_STEPS(led_steps_scan),
+    [LED_PATTERN_DUPLICATE] = LED_STEPS(led_steps_duplicate),
+    [LED_PATTERN_ERROR]     = LED_STEPS(led_steps_error),
+};
+
+// Anforderung beider Cores: Bit 0-7 Muster, Bit 8-31 fortlaufende Nummer
+static volatile uint32_t g_request;
+
+static bool g_ready;                // CYW43 initialisiert
+static bool g_level;                // Zuletzt geschriebener Pegel
+static uint32_t g_seen;             // Zuletzt übernommene Anforderung
+static bool g_link_down;            // Hintergrund beim letzten Neuberechnen
+static const led_pattern_def_t* g_pattern;  // Laufendes Muster, NULL = Hintergrund
+static uint8_t g_step;              // Aktueller Schritt des Musters
+static uint32_t g_t_step;           // Beginn des Schritts bzw. des Blinkens (time_us_32)
+static uint32_t g_t_next;           // Nächster Schaltzeitpunkt
+static bool g_timed;                // g_t_next gültig (sonst Dauerlicht bis zur nächsten Anforderung)
+static led_stats_t g_stats;
+
+void led_init(void) {
+    if (cyw43_arch_init()) {
+        printf("CYW43 init failed\r\n");
+        return;
+    }
+    g_ready = true;
+    g_level = true;
+    cyw43_arch_gpio_put(CYW43_WL_GPIO_LED_PIN, 1);
+    g_stats.transitions++;
+}
+
+void led_signal(led_pattern_t pattern) {
+    // Gehen zwei Anforderungen gleichzeitig ein, gewinnt eine; für die LED genügt das
+    g_request = ((g_request + 0x100u) & ~0xFFu) | (uint32_t)pattern;
+}
+
+// Pegel zum Zeitpunkt now bestimmen und den nächsten Schaltzeitpunkt festlegen
+static bool led_level_at(uint32_t now, bool link_down) {
+    // Abgelaufene Schritte überspringen (falls led_service() länger nicht dran war)
+    while (g_pattern) {
+        uint32_t const step_us = (uint32_t)g_pattern->steps[g_step].ms * 1000u;
+        if (now - g_t_step < step_us) {
+            g_t_next = g_t_step + step_us;
+            g_timed = true;
+            return g_pattern->steps[g_step].on;
+        }
+        g_t_step += step_us;
+        if (++g_step == g_pattern->count) {
+            g_pattern = NULL;
+            g_t_step = now;
+        }
+    }
+    if (!link_down) {
+        g_timed = false;
+        return true;
+    }
+    // Blinken, Phase ab dem Ende des letzten Musters bzw. dem Ausfall
+    uint32_t const half_us = LED_LINK_DOWN_MS * 1000u;
+    uint32_t const phase = (now - g_t_step) / half_us;
+    g_t_next = g_t_step + (phase + 1u) * half_us;
+    g_timed = true;
+    return (phase & 1u) == 0;
+}
+
+bool led_service(bool link_down) {
+    uint32_t const now = time_us_32();
+    uint32_t const request = g_request;
+
+    if (request != g_seen) {
+        // Neues Muster beginnt sofort
+        g_seen = request;
+        g_pattern = &led_patterns[(request & 0xFFu) % LED_PATTERN_COUNT];
+        g_step = 0;
+        g_t_step = now;
+        g_stats.requests++;
+    } else if (link_down != g_link_down) {
+        if (!g_pattern) g_t_step = now;
+    } else if (!g_timed || (int32_t)(now - g_t_next) < 0) {
+        return false;
+    }
+    g_link_down = link_down;
+    g_stats.evaluations++;
+
+    bool const level = led_level_at(now, link_down);
+    if (level == g_level || !g_ready) return false;
+    cyw43_arch_gpio_put(CYW43_WL_GPIO_LED_PIN, level);
+    g_level = level;
+    g_stats.transitions++;
+    return true;
+}
+
+void led_get_stats(led_stats_t* out) {
+    *out = g_stats;
+}
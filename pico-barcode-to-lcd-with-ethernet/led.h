@@ -0,0 +1,52 @@
+// LED-Rückmeldung über die CYW43-LED: Muster für Zeichen, Scan, Doppellesung, Fehler und
+// Verbindungsausfall
+//
+// Die LED des Pico 2 W hängt am WLAN-Chip; jedes Schalten ist eine SPI-Transaktion zum CYW43.
+// Der Treiber merkt sich den zuletzt geschriebenen Pegel und spricht den CYW43 nur bei einem
+// Wechsel an. led_service() rechnet das Muster nur neu, wenn der nächste Schaltzeitpunkt
+// erreicht ist, ein neues Muster angefordert wurde oder sich der Verbindungszustand ändert;
+// sonst kostet ein Aufruf zwei Vergleiche.
+//
+// Ein Muster ist eine Folge von Schritten (Pegel, Dauer) aus einer Tabelle. Ein angefordertes
+// Muster läuft einmal ab und ersetzt ein noch laufendes; danach gilt der Hintergrund:
+// Dauerlicht, solange die Verbindung steht, langsames Blinken, solange sie unten ist.
+// led_signal() von beiden Cores, die übrigen Funktionen nur von Core 1 (besitzt den CYW43).
+
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// Halbe Periode des Blinkens bei Verbindungsausfall
+#ifndef LED_LINK_DOWN_MS
+#define LED_LINK_DOWN_MS 500
+#endif
+
+typedef enum {
+    LED_PATTERN_KEY = 0,        // Zeichen empfangen: kurz aus
+    LED_PATTERN_SCAN,           // Scan angenommen: 3 s aus
+    LED_PATTERN_DUPLICATE,      // Doppellesung verworfen: zweimal langsam blinken
+    LED_PATTERN_ERROR,          // Prüfzeichen falsch: schnell blinken
+    LED_PATTERN_COUNT
+} led_pattern_t;
+
+// Zähler des LED-Treibers
+typedef struct {
+    uint32_t requests;          // Übernommene Muster (schnell aufeinander folgende überschreiben sich)
+    uint32_t evaluations;       // Neuberechnungen des Pegels
+    uint32_t transitions;       // Zugriffe auf den CYW43 (Pegelwechsel)
+} led_stats_t;
+
+// Initialisiert den CYW43 und schaltet die LED ein (Core 1)
+void led_init(void);
+
+// Fordert ein Muster an; ersetzt ein laufendes (von beiden Cores, ein 32-Bit-Store)
+void led_signal(led_pattern_t pattern);
+
+// Schaltet die LED nach Muster und Verbindungszustand (jeden Schleifendurchlauf aufrufen)
+// Parameter link_down: true, solange die Verbindung zum Server unten ist
+// Rückgabe: true, wenn der CYW43 angesprochen wurde
+bool led_service(bool link_down);
+
+// Liefert die Zähler
+void led_get_stats(led_stats_t* out);
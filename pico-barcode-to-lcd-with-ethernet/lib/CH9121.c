@@ -1,69 +1,157 @@
 #include "CH9121.h"
 #include <stdio.h>
+#include <string.h>
 
 // ============================================================================
 // HELPER FUNCTIONS
 // ============================================================================
 
-// Send configuration command with 1 data byte
-static void send_ch9121_command_1byte(UCHAR cmd, UCHAR data) {
-    UCHAR packet[4] = {0x57, 0xAB, cmd, data};
-    for (int i = 0; i < 4; i++) {
-        uart_putc(UART_ID0, packet[i]);
+// Configuration parameters in the order they are written
+typedef struct {
+    UCHAR set;                  // Set command
+    UCHAR get;                  // Query command
+    const char *name;
+} ch9121_param_t;
+
+static const ch9121_param_t ch9121_params[] = {
+    { CMD_MODE,         CMD_GET_MODE,         "Mode" },
+    { CMD_LOCAL_IP,     CMD_GET_LOCAL_IP,     "Local IP" },
+    { CMD_SUBNET_MASK,  CMD_GET_SUBNET_MASK,  "Subnet Mask" },
+    { CMD_GATEWAY,      CMD_GET_GATEWAY,      "Gateway" },
+    { CMD_TARGET_IP1,   CMD_GET_TARGET_IP1,   "Target IP" },
+    { CMD_LOCAL_PORT1,  CMD_GET_LOCAL_PORT1,  "Local Port" },
+    { CMD_TARGET_PORT1, CMD_GET_TARGET_PORT1, "Target Port" },
+    { CMD_UART1_BAUD1,  CMD_GET_UART1_BAUD1,  "Baud Rate" },
+};
+
+#define CH9121_PARAM_COUNT (sizeof(ch9121_params) / sizeof(ch9121_params[0]))
+
+// Encode one parameter as sent on the wire (ports and baud rate little-endian)
+// Returns the number of data bytes
+static UBYTE ch9121_param_encode(const CH9121_Config *config, UCHAR cmd, UCHAR out[4]) {
+    switch (cmd) {
+    case CMD_MODE:         out[0] = config->mode; return 1;
+    case CMD_LOCAL_IP:     memcpy(out, config->local_ip, 4); return 4;
+    case CMD_SUBNET_MASK:  memcpy(out, config->subnet_mask, 4); return 4;
+    case CMD_GATEWAY:      memcpy(out, config->gateway, 4); return 4;
+    case CMD_TARGET_IP1:   memcpy(out, config->target_ip, 4); return 4;
+    case CMD_LOCAL_PORT1:
+        out[0] = config->local_port & 0xFF;
+        out[1] = config->local_port >> 8;
+        return 2;
+    case CMD_TARGET_PORT1:
+        out[0] = config->target_port & 0xFF;
+        out[1] = config->target_port >> 8;
+        return 2;
+    case CMD_UART1_BAUD1:
+        for (int i = 0; i < 4; i++) out[i] = (config->baud_rate >> (8 * i)) & 0xFF;
+        return 4;
+    default:
+        return 0;
     }
-    DEV_Delay_ms(10);
 }
 
-// Send configuration command with 2 data bytes (for ports)
-static void send_ch9121_command_2bytes(UCHAR cmd, UWORD data) {
-    UCHAR packet[5] = {0x57, 0xAB, cmd, (data & 0xFF), (data >> 8)};
-    for (int i = 0; i < 5; i++) {
-        uart_putc(UART_ID0, packet[i]);
+// Store one parameter read back from the module
+static void ch9121_param_decode(CH9121_Config *config, UCHAR cmd, const UCHAR in[4]) {
+    switch (cmd) {
+    case CMD_MODE:         config->mode = in[0]; break;
+    case CMD_LOCAL_IP:     memcpy(config->local_ip, in, 4); break;
+    case CMD_SUBNET_MASK:  memcpy(config->subnet_mask, in, 4); break;
+    case CMD_GATEWAY:      memcpy(config->gateway, in, 4); break;
+    case CMD_TARGET_IP1:   memcpy(config->target_ip, in, 4); break;
+    case CMD_LOCAL_PORT1:  config->local_port = in[0] | (in[1] << 8); break;
+    case CMD_TARGET_PORT1: config->target_port = in[0] | (in[1] << 8); break;
+    case CMD_UART1_BAUD1:
+        config->baud_rate = in[0] | (in[1] << 8) | (in[2] << 16) | ((UDOUBLE)in[3] << 24);
+        break;
     }
-    DEV_Delay_ms(10);
 }
-// Send configuration command with 4 data bytes (for IP addresses)
-static void send_ch9121_command_4bytes(UCHAR cmd, UCHAR data[4]) {
-    UCHAR packet[7] = {0x57, 0xAB, cmd, data[0], data[1], data[2], data[3]};
-    for (int i = 0; i < 7; i++) {
-        uart_putc(UART_ID0, packet[i]);
-    }
-    DEV_Delay_ms(10);
-}
-
-// Send configuration command with 4 data bytes (for baud rate)
-static void send_ch9121_baud_rate(UCHAR cmd, UDOUBLE baud) {
-    UCHAR packet[7] = {
-        0x57, 0xAB, cmd,
-        (baud & 0xFF),
-        (baud >> 8) & 0xFF,
-        (baud >> 16) & 0xFF,
-        (baud >> 24) & 0xFF
-    };
-    for (int i = 0; i < 7; i++) {
-        uart_putc(UART_ID0, packet[i]);
+
+// Print one parameter
+static void ch9121_param_print(const ch9121_param_t *param, const CH9121_Config *config, const char *state) {
+    UCHAR v[4];
+    UBYTE const len = ch9121_param_encode(config, param->set, v);
+
+    if (len == 4 && param->set != CMD_UART1_BAUD1) {
+        printf("  - %s: %d.%d.%d.%d (%s)\n", param->name, v[0], v[1], v[2], v[3], state);
+    } else if (param->set == CMD_MODE) {
+        printf("  - %s: %s (%s)\n", param->name, config->mode == TCP_CLIENT ? "TCP Client" : "Other", state);
+    } else {
+        unsigned long const value = (param->set == CMD_UART1_BAUD1) ? (unsigned long)config->baud_rate
+                                                                     : (unsigned long)(v[0] | (v[1] << 8));
+        printf("  - %s: %lu (%s)\n", param->name, value, state);
     }
-    DEV_Delay_ms(10);
 }
 
-// Save configuration to CH9121 EEPROM (makes settings permanent)
-static void save_ch9121_config() {
-    UCHAR packet[3] = {0x57, 0xAB, 0x0D};
-    
-    // Command 1: Prepare to save
-    packet[2] = 0x0D;
-    for (int i = 0; i < 3; i++) uart_putc(UART_ID0, packet[i]);
-    DEV_Delay_ms(200);
-    
-    // Command 2: Confirm save
-    packet[2] = 0x0E;
-    for (int i = 0; i < 3; i++) uart_putc(UART_ID0, packet[i]);
-    DEV_Delay_ms(200);
-    
-    // Command 3: Execute save
-    packet[2] = 0x5E;
-    for (int i = 0; i < 3; i++) uart_putc(UART_ID0, packet[i]);
-    DEV_Delay_ms(200);
+// ============================================================================
+// COMMAND ENGINE
+// ============================================================================
+
+// Result of ch9121_cmd_poll()
+typedef enum { CMD_BUSY = 0, CMD_OK, CMD_FAILED } ch9121_cmd_result_t;
+
+// Command in flight: packet, expected reply and retry state
+static struct {
+    UCHAR packet[7];
+    UBYTE packet_len;
+    UCHAR reply[4];
+    UBYTE reply_len;            // Expected reply bytes
+    UBYTE got;                  // Reply bytes received so far
+    bool ack;                   // Reply must be CH9121_ACK
+    UDOUBLE timeout_us;
+    UDOUBLE t_sent;
+    UBYTE tries, max_tries;
+} g_cmd;
+
+static CH9121_Stats g_stats;
+
+// (Re)send the current packet; stale bytes in the RX FIFO are dropped first
+// The packet (at most 7 bytes) fits into the UART FIFO, so this never blocks.
+static void ch9121_cmd_send(void) {
+    while (uart_is_readable(UART_ID0)) (void)uart_getc(UART_ID0);
+    uart_write_blocking(UART_ID0, g_cmd.packet, g_cmd.packet_len);
+    g_cmd.got = 0;
+    g_cmd.t_sent = time_us_32();
+    g_stats.commands++;
+}
+
+// Start a command (57 AB cmd data...)
+// reply_len: bytes the module answers with; ack: reply must be CH9121_ACK
+static void ch9121_cmd_start(UCHAR cmd, const UCHAR *data, UBYTE len, UBYTE reply_len, bool ack,
+                             UDOUBLE timeout_us, UBYTE max_tries) {
+    g_cmd.packet[0] = 0x57;
+    g_cmd.packet[1] = 0xAB;
+    g_cmd.packet[2] = cmd;
+    if (len) memcpy(&g_cmd.packet[3], data, len);
+    g_cmd.packet_len = 3 + len;
+    g_cmd.reply_len = reply_len;
+    g_cmd.ack = ack;
+    g_cmd.timeout_us = timeout_us;
+    g_cmd.tries = 1;
+    g_cmd.max_tries = max_tries;
+    ch9121_cmd_send();
+}
+
+// Collect the reply of the command in flight; resend on timeout or error status
+static ch9121_cmd_result_t ch9121_cmd_poll(void) {
+    while (g_cmd.got < g_cmd.reply_len && uart_is_readable(UART_ID0)) {
+        g_cmd.reply[g_cmd.got++] = (UCHAR)uart_getc(UART_ID0);
+    }
+
+    if (g_cmd.got == g_cmd.reply_len) {
+        if (!g_cmd.ack || g_cmd.reply[0] == CH9121_ACK) return CMD_OK;
+        g_stats.errors++;
+    } else if (time_us_32() - g_cmd.t_sent < g_cmd.timeout_us) {
+        return CMD_BUSY;
+    } else {
+        g_stats.timeouts++;
+    }
+
+    if (g_cmd.tries >= g_cmd.max_tries) return CMD_FAILED;
+    g_cmd.tries++;
+    g_stats.retries++;
+    ch9121_cmd_send();
+    return CMD_BUSY;
 }
 
 /**
@@ -80,14 +168,105 @@ void DEV_Delay_us(UDOUBLE xus)
 }
 
 
+// ============================================================================
+// CONFIGURATION STATE MACHINE
+// ============================================================================
+
+// Sequence started by CH9121_configure_begin() / CH9121_status_begin() / CH9121_reset_begin()
+typedef enum { SEQ_CONFIGURE = 0, SEQ_STATUS, SEQ_RESET } ch9121_seq_t;
+
+static ch9121_seq_t g_seq;
+static UDOUBLE g_t_reset;           // RES_PIN pulled low
+static CH9121_Config *g_want;       // Desired settings
+static CH9121_Config g_current;     // Settings read back from the module
+static size_t g_param;              // Current parameter (CH9121_READ / CH9121_WRITE)
+static bool g_readable;             // Module answered all queries
+
+// Start the command of the current state
+static void ch9121_state_enter(CH9121_State state) {
+    UCHAR v[4];
+    CH9121_Config const ref = {0};
+    UBYTE len;
+
+    g_stats.state = state;
+    switch (state) {
+    case CH9121_ENTER:
+        // Module is in configuration mode as soon as it answers a query
+        ch9121_cmd_start(CMD_GET_MODE, NULL, 0, 1, false, CH9121_REPLY_TIMEOUT_US, CH9121_ENTER_TRIES);
+        break;
+    case CH9121_READ:
+        len = ch9121_param_encode(&ref, ch9121_params[g_param].set, v);
+        ch9121_cmd_start(ch9121_params[g_param].get, NULL, 0, len, false, CH9121_REPLY_TIMEOUT_US,
+                         CH9121_CMD_TRIES);
+        break;
+    case CH9121_WRITE:
+        // Without readback every parameter is written once (the module may not answer)
+        len = ch9121_param_encode(g_want, ch9121_params[g_param].set, v);
+        ch9121_cmd_start(ch9121_params[g_param].set, v, len, 1, true, CH9121_REPLY_TIMEOUT_US,
+                         g_readable ? CH9121_CMD_TRIES : 1);
+        break;
+    case CH9121_SAVE:
+        printf("\nSaving configuration to CH9121 EEPROM...\n");
+        ch9121_cmd_start(CMD_SAVE, NULL, 0, 1, true, CH9121_SAVE_TIMEOUT_US, g_readable ? CH9121_CMD_TRIES : 1);
+        break;
+    case CH9121_EXECUTE:
+        ch9121_cmd_start(CMD_EXECUTE, NULL, 0, 1, true, CH9121_SAVE_TIMEOUT_US, g_readable ? CH9121_CMD_TRIES : 1);
+        break;
+    case CH9121_EXIT:
+        ch9121_cmd_start(CMD_EXIT, NULL, 0, 1, true, CH9121_REPLY_TIMEOUT_US, 1);
+        break;
+    case CH9121_STATUS:
+        // First command after CFG_PIN goes low, so it is retried like the probe
+        ch9121_cmd_start(CMD_GET_STATUS1, NULL, 0, 1, false, CH9121_REPLY_TIMEOUT_US, CH9121_ENTER_TRIES);
+        break;
+    case CH9121_DONE:
+    case CH9121_FAILED:
+        // Exit configuration mode (CFG_PIN = HIGH)
+        gpio_put(CFG_PIN, 1);
+        if (g_seq != SEQ_CONFIGURE) break;
+        g_stats.config_us = time_us_32() - g_stats.config_us;
+        printf("\n==============================================\n");
+        if (g_stats.written) {
+            printf("CH9121 configuration complete (%u parameters saved to EEPROM).\n", g_stats.written);
+        } else {
+            printf("CH9121 already configured, EEPROM untouched.\n");
+        }
+        printf("==============================================\n");
+        break;
+    default:
+        break;
+    }
+}
+
+// Next parameter that has to be written (CH9121_WRITE) or the save step
+static void ch9121_next_write(void) {
+    UCHAR want[4], have[4];
+
+    for (; g_param < CH9121_PARAM_COUNT; g_param++) {
+        const ch9121_param_t *param = &ch9121_params[g_param];
+        UBYTE const len = ch9121_param_encode(g_want, param->set, want);
+        ch9121_param_encode(&g_current, param->set, have);
+        if (!g_readable || memcmp(want, have, len) != 0) {
+            ch9121_state_enter(CH9121_WRITE);
+            return;
+        }
+        ch9121_param_print(param, g_want, "unchanged");
+    }
+    ch9121_state_enter(g_stats.written ? CH9121_SAVE : CH9121_EXIT);
+}
+
 /******************************************************************************
-function:	CH9121_configure
+function:	CH9121_configure_begin
 parameter:
     config: CH9121_Config structure with all configuration parameters
-Info:  Configure CH9121 and save settings permanently to EEPROM
+Info:  Enter configuration mode and start reading the module's settings;
+       CH9121_poll() advances the configuration
 ******************************************************************************/
-void CH9121_configure(CH9121_Config *config)
+void CH9121_configure_begin(CH9121_Config *config)
 {
+    g_seq = SEQ_CONFIGURE;
+    g_stats.tcp_status = -1;
+
     // Initialize UART0 for communication with CH9121
     uart_init(UART_ID0, BAUD_RATE);  // CH9121 config mode uses 9600 baud
     gpio_set_function(UART_TX_PIN0, GPIO_FUNC_UART);
@@ -105,62 +284,136 @@ void CH9121_configure(CH9121_Config *config)
     // Enter configuration mode (CFG_PIN = LOW)
     printf("Entering CH9121 configuration mode...\n");
     gpio_put(CFG_PIN, 0);
-    DEV_Delay_ms(500);
-    
-    // Send all configuration parameters
-    printf("Configuring CH9121...\n");
-    
-    DEV_Delay_ms(100);
-    send_ch9121_command_1byte(CMD_MODE, config->mode);
-    printf("  - Mode: %s\n", config->mode == 1 ? "TCP Client" : "Other");
-    
-    DEV_Delay_ms(100);
-    send_ch9121_command_4bytes(CMD_LOCAL_IP, config->local_ip);
-    printf("  - Local IP: %d.%d.%d.%d\n", 
-           config->local_ip[0], config->local_ip[1], 
-           config->local_ip[2], config->local_ip[3]);
-    
-    DEV_Delay_ms(100);
-    send_ch9121_command_4bytes(CMD_SUBNET_MASK, config->subnet_mask);
-    printf("  - Subnet Mask: %d.%d.%d.%d\n",
-           config->subnet_mask[0], config->subnet_mask[1],
-           config->subnet_mask[2], config->subnet_mask[3]);
-    
-    DEV_Delay_ms(100);
-    send_ch9121_command_4bytes(CMD_GATEWAY, config->gateway);
-    printf("  - Gateway: %d.%d.%d.%d\n",
-           config->gateway[0], config->gateway[1],
-           config->gateway[2], config->gateway[3]);
-    
-    DEV_Delay_ms(100);
-    send_ch9121_command_4bytes(CMD_TARGET_IP1, config->target_ip);
-    printf("  - Target IP: %d.%d.%d.%d\n",
-           config->target_ip[0], config->target_ip[1],
-           config->target_ip[2], config->target_ip[3]);
-    
-    DEV_Delay_ms(100);
-    send_ch9121_command_2bytes(CMD_LOCAL_PORT1, config->local_port);
-    printf("  - Local Port: %d\n", config->local_port);
-    
-    DEV_Delay_ms(100);
-    send_ch9121_command_2bytes(CMD_TARGET_PORT1, config->target_port);
-    printf("  - Target Port: %d\n", config->target_port);
-    
-    DEV_Delay_ms(100);
-    send_ch9121_baud_rate(CMD_UART1_BAUD1, config->baud_rate);
-    printf("  - Baud Rate: %d\n", config->baud_rate);
-    
-    // Save configuration to EEPROM (permanent storage)
-    DEV_Delay_ms(100);
-    printf("\nSaving configuration to CH9121 EEPROM...\n");
-    save_ch9121_config();
-    
-    // Exit configuration mode (CFG_PIN = HIGH)
-    DEV_Delay_ms(100);
+
+    g_want = config;
+    g_param = 0;
+    g_readable = false;
+    g_stats.written = 0;
+    g_stats.config_us = time_us_32();
+    ch9121_state_enter(CH9121_ENTER);
+}
+
+/******************************************************************************
+function:	CH9121_status_begin
+Info:  Enter configuration mode and query the TCP connection state
+       (UART0 must have been released by the data path)
+******************************************************************************/
+void CH9121_status_begin(void)
+{
+    g_seq = SEQ_STATUS;
+    g_stats.status_queries++;
+    g_stats.tcp_status = -1;
+
+    uart_init(UART_ID0, BAUD_RATE);  // CH9121 config mode uses 9600 baud
+    gpio_put(CFG_PIN, 0);
+    ch9121_state_enter(CH9121_STATUS);
+}
+
+/******************************************************************************
+function:	CH9121_reset_begin
+Info:  Pull RES_PIN low; CH9121_poll() releases it after CH9121_RESET_PULSE_US
+******************************************************************************/
+void CH9121_reset_begin(void)
+{
+    g_seq = SEQ_RESET;
+    g_stats.resets++;
     gpio_put(CFG_PIN, 1);
-    
-    printf("\n==============================================\n");
-    printf("CH9121 configuration complete!\n");
-    printf("Settings are permanently saved to EEPROM.\n");
-    printf("==============================================\n");
+    gpio_put(RES_PIN, 0);
+    g_t_reset = time_us_32();
+    g_stats.state = CH9121_RESET;
+}
+
+/******************************************************************************
+function:	CH9121_poll
+Info:  Advance the running sequence without blocking (call from the main loop)
+       Returns the current state; CH9121_DONE / CH9121_FAILED when finished
+******************************************************************************/
+CH9121_State CH9121_poll(void)
+{
+    CH9121_State const state = g_stats.state;
+    if (state == CH9121_IDLE || state == CH9121_DONE || state == CH9121_FAILED) return state;
+
+    // Hard reset: no command, only the pulse length
+    if (state == CH9121_RESET) {
+        if (time_us_32() - g_t_reset < CH9121_RESET_PULSE_US) return state;
+        gpio_put(RES_PIN, 1);
+        g_stats.state = CH9121_DONE;
+        return CH9121_DONE;
+    }
+
+    ch9121_cmd_result_t const result = ch9121_cmd_poll();
+    if (result == CMD_BUSY) return state;
+    bool const ok = (result == CMD_OK);
+
+    switch (state) {
+    case CH9121_ENTER:
+        if (!ok) {
+            // No answer to the probe: write every parameter once, then save as before readback
+            printf("CH9121 not answering queries, writing all parameters...\n");
+            g_readable = false;
+            g_param = 0;
+            ch9121_next_write();
+            break;
+        }
+        printf("Configuring CH9121...\n");
+        ch9121_state_enter(CH9121_READ);
+        break;
+    case CH9121_READ:
+        if (ok) ch9121_param_decode(&g_current, ch9121_params[g_param].set, g_cmd.reply);
+        if (ok && ++g_param < CH9121_PARAM_COUNT) {
+            ch9121_state_enter(CH9121_READ);
+            break;
+        }
+        // Readback complete (or not supported: write everything)
+        g_readable = ok;
+        g_param = 0;
+        ch9121_next_write();
+        break;
+    case CH9121_WRITE:
+        ch9121_param_print(&ch9121_params[g_param], g_want, ok ? "written" : "no acknowledge");
+        g_stats.written++;
+        g_param++;
+        ch9121_next_write();
+        break;
+    case CH9121_SAVE:
+        if (!ok) printf("  - save not acknowledged\n");
+        ch9121_state_enter(CH9121_EXECUTE);
+        break;
+    case CH9121_EXECUTE:
+        if (!ok) printf("  - apply not acknowledged\n");
+        ch9121_state_enter(CH9121_EXIT);
+        break;
+    case CH9121_STATUS:
+        if (!ok) {
+            ch9121_state_enter(CH9121_FAILED);
+            break;
+        }
+        g_stats.tcp_status = (g_cmd.reply[0] == 0x01) ? 1 : 0;
+        ch9121_state_enter(CH9121_EXIT);
+        break;
+    case CH9121_EXIT:
+        ch9121_state_enter(CH9121_DONE);
+        break;
+    default:
+        break;
+    }
+    return g_stats.state;
+}
+
+/******************************************************************************
+function:	CH9121_configure
+parameter:
+    config: CH9121_Config structure with all configuration parameters
+Info:  Blocking variant: run the state machine to completion
+******************************************************************************/
+int CH9121_configure(CH9121_Config *config)
+{
+    CH9121_configure_begin(config);
+    while (CH9121_poll() != CH9121_DONE && g_stats.state != CH9121_FAILED) tight_loop_contents();
+    return g_stats.state == CH9121_DONE ? (int)g_stats.written : -1;
+}
+
+void CH9121_get_stats(CH9121_Stats *out)
+{
+    *out = g_stats;
 }
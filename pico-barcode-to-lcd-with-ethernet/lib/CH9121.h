@@ -43,6 +43,33 @@
 #define CMD_TARGET_IP1      0x15    // Set target IP
 #define CMD_TARGET_PORT1    0x16    // Set target port
 #define CMD_UART1_BAUD1     0x21    // Set UART baud rate
+#define CMD_SAVE            0x0D    // Save parameters to EEPROM
+#define CMD_EXECUTE         0x0E    // Apply parameters and reset the module
+#define CMD_EXIT            0x5E    // Leave serial configuration mode
+
+// Query commands (answer with the current value, same byte order as the set commands)
+#define CMD_GET_MODE        0x60    // 1 byte
+#define CMD_GET_LOCAL_IP    0x61    // 4 bytes
+#define CMD_GET_SUBNET_MASK 0x62    // 4 bytes
+#define CMD_GET_GATEWAY     0x63    // 4 bytes
+#define CMD_GET_LOCAL_PORT1 0x64    // 2 bytes
+#define CMD_GET_TARGET_IP1  0x65    // 4 bytes
+#define CMD_GET_TARGET_PORT1 0x66   // 2 bytes
+#define CMD_GET_UART1_BAUD1 0x71    // 4 bytes
+#define CMD_GET_STATUS1     0x03    // 1 byte: TCP connection of port 1 (0x01 = connected)
+
+#define CH9121_ACK          0xAA    // Reply to set, save and execute commands
+
+// Reply timeouts: parameter commands and EEPROM save
+#define CH9121_REPLY_TIMEOUT_US 50000
+#define CH9121_SAVE_TIMEOUT_US  500000
+
+// Attempts per command, and for the first query after CFG_PIN goes low (~500 ms)
+#define CH9121_CMD_TRIES        3
+#define CH9121_ENTER_TRIES      10
+
+// Length of the RES_PIN pulse for a hard reset
+#define CH9121_RESET_PULSE_US   10000
 
 // ============================================================================
 // CONFIGURATION STRUCTURE
@@ -58,17 +85,84 @@ typedef struct {
     UCHAR mode;                 // Mode: 0=TCP Server, 1=TCP Client, 2=UDP Server, 3=UDP Client
 } CH9121_Config;
 
+// ============================================================================
+// CONFIGURATION STATE
+// ============================================================================
+typedef enum {
+    CH9121_IDLE = 0,            // Not started
+    CH9121_ENTER,               // Waiting for the module to answer in configuration mode
+    CH9121_READ,                // Reading the current settings
+    CH9121_WRITE,               // Writing a parameter that differs
+    CH9121_SAVE,                // Saving to EEPROM
+    CH9121_EXECUTE,             // Applying the new settings
+    CH9121_EXIT,                // Leaving configuration mode
+    CH9121_STATUS,              // Querying the TCP connection state
+    CH9121_RESET,               // RES_PIN held low
+    CH9121_DONE,                // Finished, module in data mode
+    CH9121_FAILED               // Status query not answered, data mode anyway
+} CH9121_State;
+
+typedef struct {
+    CH9121_State state;         // Current state
+    UDOUBLE commands;           // Commands sent (including retries)
+    UDOUBLE retries;            // Commands sent again
+    UDOUBLE timeouts;           // Commands without a reply in time
+    UDOUBLE errors;             // Replies other than CH9121_ACK
+    UWORD written;              // Parameters written
+    UDOUBLE config_us;          // Duration of the configuration
+    UDOUBLE status_queries;     // CH9121_status_begin() calls
+    UDOUBLE resets;             // CH9121_reset_begin() calls
+    int8_t tcp_status;          // Last status query: 1 connected, 0 not connected, -1 no answer
+} CH9121_Stats;
+
 // ============================================================================
 // FUNCTION DECLARATIONS
 // ============================================================================
 
 /**
- * Configure CH9121 module with network settings
- * Settings are permanently saved to CH9121's internal EEPROM
+ * Start configuring the CH9121 module (non-blocking)
+ * Reads the current settings back and writes only the parameters that differ;
+ * the EEPROM save sequence runs only if something changed. If the module does
+ * not answer the queries, all parameters are written and saved.
+ * Every command waits for the module's reply and is retried on timeout or error.
+ * 
+ * @param config Pointer to CH9121_Config structure with all parameters (kept)
+ */
+void CH9121_configure_begin(CH9121_Config *config);
+
+/**
+ * Start a TCP connection status query (non-blocking)
+ * Enters configuration mode at 9600 baud, sends CMD_GET_STATUS1 and leaves again;
+ * the result is CH9121_Stats.tcp_status. The caller must release UART0 first
+ * (see net_uart_suspend()) and take it back afterwards.
+ */
+void CH9121_status_begin(void);
+
+/**
+ * Start a hard reset through RES_PIN (non-blocking)
+ * The module reboots and reconnects with the settings in its EEPROM.
+ */
+void CH9121_reset_begin(void);
+
+/**
+ * Advance the running sequence (call from the main loop until it is finished)
+ * 
+ * @return CH9121_DONE or CH9121_FAILED when finished, otherwise the current state
+ */
+CH9121_State CH9121_poll(void);
+
+/**
+ * Configure CH9121 module with network settings (blocking)
  * 
  * @param config Pointer to CH9121_Config structure with all parameters
+ * @return Number of parameters written (0 = module already configured)
+ */
+int CH9121_configure(CH9121_Config *config);
+
+/**
+ * Counters of the command engine
  */
-void CH9121_configure(CH9121_Config *config);
+void CH9121_get_stats(CH9121_Stats *out);
 
 /**
  * Delay functions
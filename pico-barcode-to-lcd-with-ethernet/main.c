@@ -4,22 +4,28 @@
 #include "hardware/uart.h"
 #include "bsp/board_api.h"
 #include "tusb.h"
-#include "pico/cyw43_arch.h"
+#include "pico/multicore.h"
+#include "pico/unique_id.h"
+#include "pico/flash.h"
 
 #include "CH9121.h"
 #include "lcd_1602_i2c.h"
+#include "net_uart.h"
+#include "scan_ring.h"
+#include "core_stats.h"
+#include "scan_stats.h"
+#include "net_frame.h"
+#include "net_tx.h"
+#include "scan_journal.h"
+#include "net_link.h"
+#include "scan_check.h"
+#include "scan_dedup.h"
+#include "led.h"
+#include "app.h"
 
-// UART0 is used for data communication with CH9121 (network traffic)
-// UART0 wird für die Datenkommunikation mit dem CH9121-Modul verwendet (Netzwerkverkehr)
-#define UART_ID0        uart0
-#define UART_TX_PIN0    0
-#define UART_RX_PIN0    1
-
-// Funktionsdeklarationen für LED-Steuerung und HID-Verarbeitung
+// Funktionsdeklarationen für HID-Verarbeitung
 void hid_app_task(void);
-void led_request_off_ms(uint32_t ms);
-void led_service(void);
-void cyw43_led_init(void);
+uint32_t hid_app_report_count(void);
 
 /*
  Projekt für die Kommunikation zwischen Barcode-Scanner, LCD 1602 I2C (PCF8574-Chip!) und CH9121-Modul 
@@ -80,45 +86,458 @@ CH9121_Config ch9121_config = {
         .mode         = TCP_CLIENT            // Betriebsmodus: TCP-Client
 };
 
-// LED Deadline Logic
-// Globale Variable für die LED-Ausschaltverzögerung (in Millisekunden)
-static uint32_t g_led_off_until = 0;
+// Auslastungszähler pro Core
+static core_stats_t g_core_stats[2];
+
+// Verbucht einen Schleifendurchlauf in den Auslastungszählern
+// Parameter st: Zähler des aktuellen Cores
+// Parameter t0: Startzeitpunkt des Durchlaufs (time_us_32)
+// Parameter busy: true, wenn in diesem Durchlauf Arbeit angefallen ist
+static inline void core_stats_account(core_stats_t* st, uint32_t t0, bool busy) {
+    uint32_t const dt = time_us_32() - t0;
+    st->loops++;
+    if (busy) { st->busy_loops++; st->busy_us += dt; }
+    if (dt > st->max_loop_us) st->max_loop_us = dt;
+}
+
+void core_stats_get(uint8_t core, core_stats_t* out) {
+    *out = g_core_stats[core & 1];
+}
+
+// Latenzmessung LCD: Terminator-Zeitstempel des Barcodes, der gerade übertragen wird
+static struct {
+    bool pending;
+    uint32_t t_term;        // Terminator des angezeigten Scans
+    uint32_t t_shown;       // Zeitpunkt von lcd_1602_i2c_show_barcode()
+} g_lcd_lat;
+
+// Geräte-ID in jedem Rahmen (Standard: aus der eindeutigen Flash-ID des Boards)
+#ifndef NET_DEVICE_ID
+#define NET_DEVICE_ID 0
+#endif
+
+static uint32_t g_device_id;
+static uint16_t g_boot;             // Startzähler aus dem Journal
+static uint32_t g_net_seq;          // Scan-Nummer innerhalb dieses Starts
+static uint32_t g_t_last_scan;      // Letzter Scan der Ethernet-Senke (Scan-Pausen)
+static bool g_net_ready;            // CH9121 konfiguriert, UART0 im Datenbetrieb
+
+// Senke LCD: zeigt den neuesten Barcode an
+// Rückgabe: true, wenn Einträge verarbeitet wurden
+// 
+// Liegen mehrere Scans an, wird nur der letzte in den Framebuffer geschrieben;
+// die dazwischenliegenden wären ohnehin sofort überschrieben worden.
+static bool lcd_sink_poll(void) {
+    const scan_record_t* rec;
+    const scan_record_t* last = NULL;
+    char code[SCAN_CODE_MAX];
+    uint32_t t_term = 0;
+    uint8_t flags = 0;
+
+    while ((rec = scan_ring_peek(SCAN_SINK_LCD)) != NULL) {
+        memcpy(code, rec->code, (size_t)rec->len + 1);
+        t_term = rec->t_us;
+        flags = rec->flags;
+        last = rec;
+        scan_ring_release(SCAN_SINK_LCD);
+    }
+    if (!last) return false;
+
+    // Zeigt den Barcode auf dem LCD an; mit falschem Prüfzeichen als fragwürdig
+    lcd_1602_i2c_show_barcode(code);
+    if (flags & SCAN_FLAG_CHECK) lcd_1602_i2c_write_line(0, "PRUEFZIFFER?");
+    g_lcd_lat.pending = true;
+    g_lcd_lat.t_term = t_term;
+    g_lcd_lat.t_shown = time_us_32();
+    return true;
+}
 
-// Schaltet die eingebaute LED ein
-static inline void led_on(void)  { cyw43_arch_gpio_put(CYW43_WL_GPIO_LED_PIN, 1); }
+// Latenzmessung LCD: trägt die Anzeigedauer ein, sobald der Frame draußen ist
+static void lcd_latency_poll(void) {
+    if (!g_lcd_lat.pending || lcd_1602_i2c_busy()) return;
 
-// Schaltet die eingebaute LED aus
-static inline void led_off(void) { cyw43_arch_gpio_put(CYW43_WL_GPIO_LED_PIN, 0); }
+    // Ende der letzten Übertragung; gab es seit der Anzeige keine (Inhalt unverändert),
+    // gilt der Barcode ab sofort als angezeigt
+    lcd_1602_i2c_stats_t st;
+    lcd_1602_i2c_get_stats(&st);
+    uint32_t done = st.last_frame_end_us;
+    if ((int32_t)(done - g_lcd_lat.t_shown) < 0) done = time_us_32();
 
-// Fordert das Ausschalten der LED für eine bestimmte Anzahl von Millisekunden an
-// Parameter ms: Anzahl der Millisekunden, für die die LED ausgeschaltet bleiben soll
-void led_request_off_ms(uint32_t ms) { g_led_off_until = board_millis() + ms; led_off(); }
+    scan_stats_record(SCAN_LAT_LCD, done - g_lcd_lat.t_term);
+    g_lcd_lat.pending = false;
+}
 
-// Service-Funktion für die LED-Steuerung
-// Überprüft, ob die LED-Ausschaltverzögerung abgelaufen ist und schaltet die LED entsprechend ein oder aus
-void led_service(void) { uint32_t now = board_millis(); if ((int32_t)(now - g_led_off_until) < 0) led_off(); else led_on(); }
+// Ermittelt die Geräte-ID (NET_DEVICE_ID oder die gefaltete Board-ID)
+static uint32_t net_device_id(void) {
+    if (NET_DEVICE_ID) return NET_DEVICE_ID;
 
-// Netzwerk-Senden über UART0 -> CH9121
-// Sendet eine Textzeile über UART0 an das CH9121-Modul zur Weiterleitung über Ethernet
-// Parameter line: Null-terminierter String, der gesendet werden soll
-void net_send_line(const char* line) {
-        uart_puts(UART_ID0, line);
+    pico_unique_board_id_t id;
+    pico_get_unique_board_id(&id);
+    uint32_t v = 0;
+    for (int i = 0; i < PICO_UNIQUE_BOARD_ID_SIZE_BYTES; ++i) v = (v << 8 | v >> 24) ^ id.id[i];
+    return v;
 }
 
-// Initialisiert das CYW43-Modul und die LED
-// Das CYW43-Modul steuert die integrierte LED auf dem Pico W/WH
-void cyw43_led_init(void) {
-    if (cyw43_arch_init()) {
-        printf("CYW43 init failed\r\n");
-    } else {
-        // LED initial ausschalten
-        cyw43_arch_gpio_put(CYW43_WL_GPIO_LED_PIN, 0);
+// Senke Ethernet: übernimmt Barcodes ins Sendefenster, net_tx_poll() sendet sie in
+// SCANS-Rahmen über UART0 -> CH9121 und wiederholt unbestätigte
+// Rückgabe: true, wenn Einträge verarbeitet wurden
+// 
+// Ist das Fenster voll (Server bestätigt nicht), gehen neue Scans ins Journal im Flash,
+// bis es wieder leer ist; freie Plätze im Fenster füllt das Journal in Nummernfolge nach.
+// Nur wenn auch das Journal voll ist, bleiben die Scans im Scan-Ring liegen.
+static bool net_sink_poll(void) {
+    const scan_record_t* rec;
+    net_scan_t scan;
+    bool busy = false;
+
+    while ((rec = scan_ring_peek(SCAN_SINK_NET)) != NULL) {
+        uint32_t const now = time_us_32();
+        scan = (net_scan_t){
+            .boot = g_boot,
+            .seq = g_net_seq,
+            .t_ms = (uint32_t)(time_us_64() / 1000u) - (now - rec->t_us) / 1000u,
+            .t_us = rec->t_us,
+            .t_first_us = rec->t_first_us,
+            .live = true,
+            .scanner = rec->dev_addr,
+            .len = rec->len,
+        };
+        memcpy(scan.code, rec->code, (size_t)rec->len + 1);
+
+        // Direkt ins Fenster, solange im Journal nichts Älteres wartet
+        if (scan_journal_empty() && !net_tx_full()) {
+            net_tx_push(&scan);
+        } else {
+            scan.live = false;
+            scan.journaled = true;
+            if (!scan_journal_append(&scan)) break;
+        }
+        scan_stats_record(SCAN_LAT_SCANNER, rec->t_us - rec->t_first_us);
+        scan_ring_release(SCAN_SINK_NET);
+        g_net_seq++;
+        g_t_last_scan = now;
+        busy = true;
+    }
+
+    // Wiedergabe aus dem Journal, sobald das Fenster Platz hat
+    while (!net_tx_full() && scan_journal_read(&scan)) {
+        net_tx_push(&scan);
+        busy = true;
     }
+    // Gesendet wird nur bei stehender Verbindung (net_link.h); bis dahin sammelt das Fenster,
+    // danach das Journal
+    if (net_link_sendable()) busy |= net_tx_poll();
+
+    // Journal sichern; das nächste Segment nur in Scan-Pausen vorab löschen
+    scan_journal_poll(time_us_32() - g_t_last_scan >= SCAN_JOURNAL_QUIET_MS * 1000u);
+    return busy;
 }
 
-// Hauptfunktion des Programms
-// Initialisiert alle Komponenten und startet die Hauptschleife
-int main(void) {
+// Zeilen des Dumps nach den Histogrammen (scan_stats_format_line())
+enum {
+    STATS_LINE_NET = 0,
+    STATS_LINE_JOURNAL,
+    STATS_LINE_CH9121,
+    STATS_LINE_LINK,
+    STATS_LINE_DEDUP,
+    STATS_LINE_CHECK,
+    STATS_LINE_CORE,
+    STATS_LINE_COUNT
+};
+
+static scan_stats_t g_dump_stats;   // Stand der Histogramme bei Anforderung des Dumps
+static int g_dump_line = -1;        // Nächste zu sendende Zeile, -1 = kein Dump offen
+
+// Formatiert Zeile 'line' des Dumps (Histogramme, dann die Zähler der übrigen Module)
+// Rückgabe: false, wenn es die Zeile nicht gibt
+static bool stats_format_line(unsigned line, char* buf, size_t cap) {
+    if (scan_stats_format_line(&g_dump_stats, line, buf, cap)) return true;
+    line -= SCAN_LAT_COUNT + 1;
+
+    switch (line) {
+    case STATS_LINE_NET: {
+        // Zähler des Sendefensters
+        net_tx_stats_t tx;
+        net_tx_get_stats(&tx);
+        snprintf(buf, cap,
+                 "#NET frames=%lu records=%lu retransmits=%lu timeouts=%lu fast=%lu acks=%lu dup_acks=%lu "
+                 "in_flight=%u window_high=%u rto_ms=%lu",
+                 (unsigned long)tx.frames, (unsigned long)tx.records, (unsigned long)tx.retransmits,
+                 (unsigned long)tx.timeouts, (unsigned long)tx.fast_retransmits, (unsigned long)tx.acks,
+                 (unsigned long)tx.dup_acks, tx.in_flight, tx.window_high, (unsigned long)(tx.rto_us / 1000));
+        return true;
+    }
+    case STATS_LINE_JOURNAL: {
+        // Zähler des Journals
+        scan_journal_stats_t js;
+        scan_journal_get_stats(&js);
+        snprintf(buf, cap,
+                 "#JOURNAL boot=%u appended=%lu replayed=%lu trimmed=%lu recovered=%lu live=%lu pages=%u/%u "
+                 "programs=%lu erases=%lu forced=%lu full=%lu errors=%lu",
+                 js.boot, (unsigned long)js.appended, (unsigned long)js.replayed, (unsigned long)js.trimmed,
+                 (unsigned long)js.recovered, (unsigned long)js.live, js.pages_used, js.pages,
+                 (unsigned long)js.programs, (unsigned long)js.erases, (unsigned long)js.forced_erases,
+                 (unsigned long)js.full, (unsigned long)js.flash_errors);
+        return true;
+    }
+    case STATS_LINE_CH9121: {
+        // Zähler der CH9121-Konfiguration
+        CH9121_Stats cs;
+        CH9121_get_stats(&cs);
+        snprintf(buf, cap,
+                 "#CH9121 state=%d written=%u commands=%lu retries=%lu timeouts=%lu errors=%lu config_ms=%lu",
+                 (int)cs.state, cs.written, (unsigned long)cs.commands, (unsigned long)cs.retries,
+                 (unsigned long)cs.timeouts, (unsigned long)cs.errors, (unsigned long)(cs.config_us / 1000));
+        return true;
+    }
+    case STATS_LINE_LINK: {
+        // Zähler der Verbindungsüberwachung
+        net_link_stats_t ns;
+        net_link_get_stats(&ns);
+        snprintf(buf, cap,
+                 "#LINK state=%d pings=%lu pongs=%lu rtt_us=%lu degraded=%lu downs=%lu status=%lu/%lu resets=%lu "
+                 "reconnects=%lu reconnect_ms=%lu max_ms=%lu reset_ms=%lu",
+                 (int)ns.state, (unsigned long)ns.pings, (unsigned long)ns.pongs, (unsigned long)ns.rtt_us,
+                 (unsigned long)ns.degraded, (unsigned long)ns.downs, (unsigned long)ns.status_failures,
+                 (unsigned long)ns.status_queries, (unsigned long)ns.resets, (unsigned long)ns.reconnects,
+                 (unsigned long)ns.last_reconnect_ms, (unsigned long)ns.max_reconnect_ms,
+                 (unsigned long)ns.last_reset_ms);
+        return true;
+    }
+    case STATS_LINE_DEDUP: {
+        // Zähler der Doppellesungs-Unterdrückung
+        scan_dedup_stats_t ds;
+        scan_dedup_get_stats(&ds);
+        snprintf(buf, cap, "#DEDUP window_ms=%lu checked=%lu suppressed=%lu evicted=%lu",
+                 (unsigned long)ds.window_ms, (unsigned long)ds.checked, (unsigned long)ds.suppressed,
+                 (unsigned long)ds.evicted);
+        return true;
+    }
+    case STATS_LINE_CHECK: {
+        // Zähler der Prüfzeichen-Kontrolle: pro Symbologie Einstellung (-/F/D), geprüft/ungültig
+        static const char actions[] = { '-', 'F', 'D' };
+        scan_check_stats_t cks;
+        scan_check_get_stats(&cks);
+        int pos = snprintf(buf, cap, "#CHECK");
+        for (unsigned i = 0; i < SCAN_SYM_COUNT; ++i) {
+            pos += snprintf(buf + pos, cap - (size_t)pos, " %s=%c%lu/%lu", scan_check_name((scan_sym_t)i),
+                            actions[cks.action[i]], (unsigned long)cks.checked[i], (unsigned long)cks.invalid[i]);
+        }
+        snprintf(buf + pos, cap - (size_t)pos, " unchecked=%lu flagged=%lu dropped=%lu",
+                 (unsigned long)cks.unchecked, (unsigned long)cks.flagged, (unsigned long)cks.dropped);
+        return true;
+    }
+    case STATS_LINE_CORE: {
+        // Schleifendurchläufe beider Cores seit dem Start und Zugriffe auf die CYW43-LED
+        core_stats_t c0, c1;
+        led_stats_t ls;
+        core_stats_get(0, &c0);
+        core_stats_get(1, &c1);
+        led_get_stats(&ls);
+        snprintf(buf, cap,
+                 "#CORE uptime_ms=%lu loops0=%lu busy0=%lu max0_us=%lu loops1=%lu busy1=%lu max1_us=%lu "
+                 "led_requests=%lu led_evals=%lu led_puts=%lu",
+                 (unsigned long)(time_us_64() / 1000u), (unsigned long)c0.loops, (unsigned long)c0.busy_loops,
+                 (unsigned long)c0.max_loop_us, (unsigned long)c1.loops, (unsigned long)c1.busy_loops,
+                 (unsigned long)c1.max_loop_us, (unsigned long)ls.requests, (unsigned long)ls.evaluations,
+                 (unsigned long)ls.transitions);
+        return true;
+    }
+    default:
+        return false;
+    }
+}
+
+// Fordert den Dump der Latenz-Histogramme und Zähler an (Kommando "STATS")
+static void stats_dump(void) {
+    scan_stats_get(&g_dump_stats);
+    g_dump_line = 0;
+}
+
+// Sendet die nächste Zeile des Dumps als TEXT-Rahmen über den CH9121
+// Rückgabe: true, wenn eine Zeile gesendet wurde
+//
+// Der Dump ist größer als der TX-Ringpuffer; jede Zeile geht erst hinaus, wenn sie ganz
+// hineinpasst, damit weder Zeilen noch Scans verloren gehen. Der Zwischenserver schreibt
+// TEXT-Rahmen nicht in die Datenbank, sondern ins Log.
+static bool stats_dump_poll(void) {
+    static uint8_t frame[4 + 240 + NET_FRAME_OVERHEAD];
+    static size_t frame_len;
+
+    if (g_dump_line < 0) return false;
+    if (!frame_len) {
+        uint8_t payload[4 + 240];
+        for (int i = 0; i < 4; ++i) payload[i] = (uint8_t)(g_device_id >> (8 * i));
+        if (!stats_format_line((unsigned)g_dump_line, (char*)&payload[4], sizeof(payload) - 4)) {
+            g_dump_line = -1;
+            return false;
+        }
+        frame_len = net_frame_wrap(frame, NET_FRAME_TEXT, payload, (uint16_t)(4 + strlen((char*)&payload[4])));
+    }
+    // Scans haben Vorrang: nur senden, solange danach noch Platz für einen vollen SCANS-Rahmen bleibt
+    if (net_uart_tx_space() < frame_len + NET_FRAME_PAYLOAD_MAX + NET_FRAME_OVERHEAD) return false;
+    net_send(frame, frame_len);
+    frame_len = 0;
+    g_dump_line++;
+    return true;
+}
+
+// Kommando "DEDUP <ms>": Fenster der Doppellesungs-Unterdrückung setzen (0 = aus)
+// Ungültige Ziffern oder Werte über SCAN_DEDUP_MAX_MS werden ignoriert.
+static void cmd_dedup(const uint8_t* cmd, uint16_t len) {
+    uint32_t ms = 0;
+    for (uint16_t i = 6; i < len; ++i) {
+        if (cmd[i] < '0' || cmd[i] > '9') return;
+        ms = ms * 10u + (uint32_t)(cmd[i] - '0');
+        if (ms > SCAN_DEDUP_MAX_MS) return;     // Vor dem Überlauf abbrechen
+    }
+    scan_dedup_set_window(ms);
+}
+
+// Kommando "CHECK <Symbologie> <OFF|FLAG|DROP>": Umgang mit falschen Prüfzeichen setzen
+static void cmd_check(const uint8_t* cmd, uint16_t len) {
+    static const char* const actions[] = { "OFF", "FLAG", "DROP" };
+    const char* const arg = (const char*)&cmd[6];
+    const char* const sp = memchr(arg, ' ', len - 6u);
+    if (!sp) return;
+
+    scan_sym_t const sym = scan_check_find(arg, (size_t)(sp - arg));
+    size_t const n = len - 6u - (size_t)(sp - arg) - 1u;
+    for (unsigned a = 0; a < 3; ++a) {
+        if (strlen(actions[a]) == n && memcmp(sp + 1, actions[a], n) == 0) {
+            scan_check_set_action(sym, (scan_check_action_t)a);
+        }
+    }
+}
+
+// Rahmen vom Server (über den CH9121)
+//   jeder        -> net_link_on_rx() (Verbindung lebt; nach einem Ausfall sofort wiederholen)
+//   ACK          -> net_tx_on_ack(), bestätigte Scans aus dem Journal freigeben
+//   CMD "STATS"  -> stats_dump() (Zeilen gehen über stats_dump_poll() hinaus)
+//   CMD "DEDUP <ms>" -> Fenster der Doppellesungs-Unterdrückung
+//   CMD "CHECK <Symbologie> <OFF|FLAG|DROP>" -> Prüfzeichen-Kontrolle einstellen
+// Rückgabe: true, wenn Bytes empfangen wurden
+static bool cmd_poll(void) {
+    static uint8_t cmd[16];
+    static net_frame_parser_t parser;
+    uint8_t buf[32];
+    size_t n = net_uart_read(buf, sizeof(buf));
+
+    if (!parser.payload) net_frame_parser_init(&parser, cmd, sizeof(cmd));
+    for (size_t i = 0; i < n; ++i) {
+        if (!net_frame_parse(&parser, buf[i])) continue;
+        if (net_link_on_rx(parser.type, cmd, parser.len)) net_tx_restart();
+        if (parser.type == NET_FRAME_ACK) {
+            uint32_t const journaled = net_tx_on_ack(cmd, parser.len);
+            if (journaled) scan_journal_trim(journaled);
+        } else if (parser.type == NET_FRAME_CMD && parser.len == 5 && memcmp(cmd, "STATS", 5) == 0) {
+            stats_dump();
+        } else if (parser.type == NET_FRAME_CMD && parser.len > 6 && memcmp(cmd, "DEDUP ", 6) == 0) {
+            cmd_dedup(cmd, parser.len);
+        } else if (parser.type == NET_FRAME_CMD && parser.len > 6 && memcmp(cmd, "CHECK ", 6) == 0) {
+            cmd_check(cmd, parser.len);
+        }
+    }
+    return n > 0;
+}
+
+// Senke LED: LED-Feedback für jeden Barcode
+// Rückgabe: true, wenn Einträge verarbeitet wurden
+//
+// Liegen mehrere Scans an, zählt nur der letzte (ein neues Muster ersetzt das laufende).
+static bool led_sink_poll(void) {
+    const scan_record_t* rec;
+    bool busy = false;
+    uint8_t flags = 0;
+
+    while ((rec = scan_ring_peek(SCAN_SINK_LED)) != NULL) {
+        flags = rec->flags;
+        scan_ring_release(SCAN_SINK_LED);
+        busy = true;
+    }
+    // LED-Feedback: 3 Sekunden aus, bei falschem Prüfzeichen schnelles Blinken
+    if (busy) led_signal((flags & SCAN_FLAG_CHECK) ? LED_PATTERN_ERROR : LED_PATTERN_SCAN);
+    return busy;
+}
+
+// Initialisierung von Core 1
+// Core 1 besitzt LCD (I2C0 + DMA), CH9121 (UART0) und die CYW43-LED und arbeitet den
+// Scan-Ring ab. Core 0 bleibt ausschließlich für USB-Host-Polling und HID-Dekodierung.
+void core1_setup(void) {
+    // Initialisiert die CYW43-LED
+    led_init();
+
+    // Initialisiert das LCD 1602 I2C-Display (I2C-Interrupt läuft damit auf Core 1)
+    lcd_1602_i2c_init();
+
+    // CH9121 konfigurieren
+    // Liest die Einstellungen des CH9121 zurück und schreibt nur abweichende Parameter
+    // (EEPROM wird nur bei Änderungen beschrieben). Die Kommandos laufen ohne Blockieren
+    // in core1_poll() weiter (net_config_poll()), LCD und Scans arbeiten währenddessen.
+    CH9121_configure_begin(&ch9121_config);
+
+    // Journal lesen; der Startzähler lässt den Server neu beginnende Scan-Nummern erkennen,
+    // unbestätigte Scans früherer Starts gehen vor den neuen hinaus
+    g_device_id = net_device_id();
+    g_boot = scan_journal_init();
+    net_tx_init(g_device_id, g_boot);
+}
+
+// Treibt die Konfiguration des CH9121 voran; danach UART0 in den Datenbetrieb schalten
+// und die Verbindung überwachen (Keepalive, Statusabfrage, Reset über RES_PIN)
+// Rückgabe: true, wenn etwas zu tun war
+static bool net_config_poll(void) {
+    if (g_net_ready) return net_link_poll();
+
+    CH9121_State const state = CH9121_poll();
+    if (state != CH9121_DONE && state != CH9121_FAILED) return true;
+
+    // UART0 für Datenverkehr mit CH9121
+    // Initialisiert UART0 mit der konfigurierten Baudrate und den interrupt-getriebenen
+    // Sendepfad (TX/RX über GPIO 0/1)
+    net_uart_init(ch9121_config.baud_rate);
+    net_link_init(g_device_id, ch9121_config.baud_rate);
+    g_net_ready = true;
+    return true;
+}
+
+// Ein Durchlauf der Hauptschleife von Core 1
+void core1_poll(void) {
+    uint32_t const t0 = time_us_32();
+    bool busy = false;
+
+    busy |= net_config_poll();
+
+    // Senken arbeiten den Scan-Ring unabhängig voneinander ab
+    busy |= lcd_sink_poll();
+    busy |= net_sink_poll();
+    busy |= led_sink_poll();
+
+    // LCD Renderer
+    // Sendet geänderte Display-Zellen (DMA-Frame oder kleine Bursts)
+    if (lcd_1602_i2c_busy()) busy = true;
+    lcd_1602_i2c_task();
+    lcd_latency_poll();
+
+    // Bestätigungen und Kommandos vom Server, angeforderter Dump
+    if (g_net_ready) busy |= cmd_poll();
+    if (g_net_ready) busy |= stats_dump_poll();
+
+    // LED Service
+    // Schaltet die LED nach dem laufenden Muster; der CYW43 wird nur bei einem Wechsel angesprochen
+    busy |= led_service(g_net_ready && net_link_state() == NET_LINK_DOWN);
+
+    core_stats_account(&g_core_stats[1], t0, busy);
+}
+
+// Einstiegspunkt von Core 1
+static void core1_main(void) {
+    core1_setup();
+    while (1) core1_poll();
+}
+
+// Initialisierung von Core 0 (Board, Standard-I/O, TinyUSB Host)
+void core0_setup(void) {
     // Board/TinyUSB
     // Initialisiert die Board-spezifischen Funktionen und Standard-I/O
     board_init();
@@ -126,46 +545,42 @@ int main(void) {
 
     printf("USB-HID Barcode -> LCD + Ethernet (CH9121)\r\n");
 
-    // Initialisiert die CYW43-LED
-    cyw43_led_init();
-    
-    // Initialisiert das LCD 1602 I2C-Display
-    lcd_1602_i2c_init();
-
     // TinyUSB Host initialisieren
     // Ermöglicht dem Pico, als USB-Host für den Barcode-Scanner zu fungieren
     tuh_init(BOARD_TUH_RHPORT);
     if (board_init_after_tusb) { board_init_after_tusb(); }
 
-    // CH9121 konfigurieren
-    // Sendet die Konfigurationsparameter an das CH9121-Modul
-    CH9121_configure(&ch9121_config);
+    // Core 1 darf Core 0 für Schreibzugriffe auf das Journal im Flash anhalten
+    flash_safe_execute_core_init();
+}
 
-    // UART0 für Datenverkehr mit CH9121
-    // Initialisiert UART0 mit der konfigurierten Baudrate
-    uart_init(UART_ID0, ch9121_config.baud_rate);
+// Ein Durchlauf der Hauptschleife von Core 0
+// Führt die USB-Tasks aus; Barcodes gehen über den Scan-Ring an Core 1
+void core0_poll(void) {
+    static uint32_t reports = 0;
+    uint32_t const t0 = time_us_32();
+
+    // TinyUSB Host Polling
+    // Verarbeitet USB-Host-Events (z.B. HID-Reports vom Barcode-Scanner)
+    tuh_task();
     
-    // Setzt die GPIO-Pins für UART-Funktionalität
-    gpio_set_function(UART_TX_PIN0, GPIO_FUNC_UART);
-    gpio_set_function(UART_RX_PIN0, GPIO_FUNC_UART);
-
-    // kurze Wartezeit
-    // Gibt dem System Zeit, alle Initialisierungen abzuschließen
-    sleep_ms(500);
-
-    // Hauptschleife
-    // Führt kontinuierlich die erforderlichen Tasks aus
-    while (1) {
-        // TinyUSB Host Polling
-        // Verarbeitet USB-Host-Events (z.B. HID-Reports vom Barcode-Scanner)
-        tuh_task();
-        
-        // HID App (Barcode Verarbeitung)
-        // Verarbeitet empfangene Barcode-Daten
-        hid_app_task();
-        
-        // LED Service
-        // Aktualisiert den LED-Status basierend auf der Verzögerungslogik
-        led_service();
-    }
+    // HID App (Barcode Verarbeitung)
+    // Verarbeitet empfangene Barcode-Daten
+    hid_app_task();
+
+    uint32_t const now_reports = hid_app_report_count();
+    core_stats_account(&g_core_stats[0], t0, now_reports != reports);
+    reports = now_reports;
+}
+
+// Hauptfunktion des Programms
+// Initialisiert USB auf Core 0, startet Core 1 und pollt danach nur noch den USB-Host
+int main(void) {
+    core0_setup();
+
+    // Core 1 übernimmt LCD, CH9121 und LED (inkl. deren Initialisierung)
+    multicore_launch_core1(core1_main);
+
+    // Hauptschleife Core 0
+    while (1) core0_poll();
 }
@@ -1,65 +1,495 @@
+import argparse
+import selectors
 import socket
+import threading
+import time
 import mysql.connector
-from datetime import datetime
+from datetime import datetime, timedelta
 
-# MySQL Verbindung herstellen
-print("Verbinde mit MySQL...")
-conn = mysql.connector.connect(
+import net_frame
+import scan_spool
+
+# TCP-Port, auf dem die CH9121-Module (TCP-Client) sich verbinden
+PORT = 5000
+
+# Abstand in Sekunden, in dem die Latenz-Statistik der Firmware angefordert wird
+# (CMD-Rahmen "STATS", Antwort als TEXT-Rahmen), 0 = nie
+STATS_INTERVAL = 0
+
+# Neue Scans landen zuerst im lokalen Spool (scan_spool.py) und werden bestätigt (ACK),
+# sobald sie dort per fsync gesichert sind. Ein Hintergrund-Thread überträgt sie in MySQL;
+# ist die Datenbank nicht erreichbar, wächst nur der Spool.
+SPOOL_DIR = "spool"
+
+# Gruppen-Commit in den Spool: neue Scans aller Verbindungen werden gesammelt und
+# gemeinsam gesichert (ein fsync), sobald BATCH_ROWS Zeilen anliegen oder die älteste
+# BATCH_MS Millisekunden wartet
+BATCH_ROWS = 500
+BATCH_MS = 20
+
+# Übertragung in MySQL: höchstens so viele Zeilen pro INSERT und Transaktion; nach einem
+# Fehler erneuter Versuch mit wachsendem Abstand bis DRAIN_RETRY_MAX_S Sekunden
+DRAIN_ROWS = 500
+DRAIN_RETRY_MAX_S = 30
+
+# Abstand in Sekunden, in dem die Statistik von Spool und MySQL ausgegeben wird, 0 = nie
+BATCH_REPORT_INTERVAL = 10
+
+# Jeden neuen Scan ausgeben (unter hoher Last abschalten: die Ausgabe kostet mehr als das
+# Sichern, siehe tools/bridge_bench.py)
+LOG_SCANS = True
+
+# MySQL Verbindungsdaten
+MYSQL_CONFIG = dict(
     host="localhost",
     port=3306,
     user="root",
     password="cpaun2022",
-    database="ch9121_test"
+    database="ch9121_test",
+    connection_timeout=5,
 )
-cursor = conn.cursor()
-print("MySQL Verbindung erfolgreich\n")
+
+# Port, Spool-Verzeichnis und Ausgabe lassen sich beim Aufruf überschreiben
+parser = argparse.ArgumentParser(description="Zwischenserver CH9121 -> MySQL")
+parser.add_argument("--port", type=int, default=PORT, help=f"TCP-Port (Standard {PORT})")
+parser.add_argument("--spool", default=SPOOL_DIR, help=f"Spool-Verzeichnis (Standard {SPOOL_DIR})")
+parser.add_argument("--quiet", action="store_true", help="neue Scans nicht einzeln ausgeben")
+args = parser.parse_args()
+PORT, SPOOL_DIR = args.port, args.spool
+LOG_SCANS = LOG_SCANS and not args.quiet
+
+# Empfangsstand pro Gerät und Start: (device_id, boot) -> nächste erwartete Scan-Nummer
+# Die Firmware wiederholt unbestätigte Scans; nur lückenlos folgende werden übernommen,
+# Wiederholungen bereits gesicherter Scans werden übersprungen. Nach einem Neustart
+# schickt sie zuerst die Scans früherer Starts aus ihrem Journal, danach die neuen.
+# Bleibt über Verbindungsabbrüche hinweg erhalten; nach einem Neustart des Zwischenservers
+# kommt er aus dem Spool (Checkpoint und offene Datensätze). Für sonst unbekannte
+# Geräte/Starts fragt der Hintergrund-Thread die Tabelle ab (siehe handle_scans). Der
+# eindeutige Schlüssel (device_id, boot, seq) fängt Doppelte darüber hinaus ab (siehe
+# Create_MySQL_Database.sql).
+expected = {}
+
+
+# Zeitbasis pro Gerät/Start: (device_id, boot) -> Empfangszeit minus t_send_ms eines Rahmens
+# des laufenden Starts, also der Startzeitpunkt des Geräts. Scans früherer Starts kommen nach
+# einem Neustart aus dem Journal; ihr Alter ist nur relativ zum jüngsten Scan des Rahmens
+# bekannt. Ihr timestamp ergibt sich aus dieser Zeitbasis (device_ms + Start), sonst bleibt
+# er leer (NULL) statt einer plausibel wirkenden, aber um die Ausfallzeit falschen Zeit.
+boot_epoch = {}
+
+
+# Spalten einer Zeile in scanned_barcodes
+INSERT_COLUMNS = ("barcode", "timestamp", "device_id", "boot", "seq", "scanner", "device_ms")
+
+
+def insert_rows(cursor, rows):
+    """Ein mehrzeiliger INSERT; bereits gespeicherte Scans (device_id, boot, seq) bleiben unverändert."""
+    row_sql = "(" + ", ".join(["%s"] * len(INSERT_COLUMNS)) + ")"
+    sql = (f"INSERT INTO scanned_barcodes ({', '.join(INSERT_COLUMNS)}) VALUES "
+           + ", ".join([row_sql] * len(rows)) + " ON DUPLICATE KEY UPDATE id = id")
+    cursor.execute(sql, [v for row in rows for v in row])
+
+
+class BatchWriter:
+    """Sammelt neue Zeilen und sichert sie als Gruppe im Spool (ein fsync)."""
+
+    def __init__(self, spool, max_rows, max_ms):
+        self.spool = spool
+        self.max_rows = max_rows
+        self.max_ms = max_ms
+        self.rows = []          # Spaltenwerte wie INSERT_COLUMNS
+        self.next_seq = {}      # (device_id, boot) -> nächste Nummer inkl. gesammelter Zeilen
+        self.t_first = None     # Ankunft der ältesten gesammelten Zeile (time.monotonic)
+        # Statistik seit der letzten Ausgabe
+        self.flushes = 0
+        self.flushed_rows = 0
+        self.max_flush_rows = 0
+        self.flush_ms = 0.0
+        self.max_flush_ms = 0.0
+        self.max_wait_ms = 0.0
+
+    def expected(self, key):
+        """Nächste erwartete Scan-Nummer (gesammelt oder gesichert), None = unbekannt."""
+        if key in self.next_seq:
+            return self.next_seq[key]
+        return expected.get(key)
+
+    def pending(self, key):
+        """True, wenn für key gesammelte Zeilen auf das Sichern warten."""
+        return key in self.next_seq
+
+    def add(self, key, next_seq, rows):
+        """Übernimmt die neuen Zeilen eines Rahmens; next_seq = Nummer nach der letzten."""
+        if not rows:
+            return
+        if not self.rows:
+            self.t_first = time.monotonic()
+        self.rows.extend(rows)
+        self.next_seq[key] = next_seq
+
+    def timeout(self):
+        """Sekunden bis zum spätesten Sichern der gesammelten Zeilen, None = nichts gesammelt."""
+        if not self.rows:
+            return None
+        return max(0.0, self.t_first + self.max_ms / 1000 - time.monotonic())
+
+    def due(self):
+        return bool(self.rows) and (len(self.rows) >= self.max_rows or self.timeout() == 0.0)
+
+    def flush(self):
+        """Sichert alle gesammelten Zeilen im Spool.
+
+        Liefert die damit bestätigbaren Stände {(device_id, boot): next_seq}; bei einem
+        Fehler ein leeres dict (die Firmware wiederholt die Scans, ohne ACK).
+        """
+        if not self.rows:
+            return {}
+        rows, acks = self.rows, self.next_seq
+        wait_ms = (time.monotonic() - self.t_first) * 1000
+        self.rows, self.next_seq, self.t_first = [], {}, None
+
+        t0 = time.monotonic()
+        try:
+            self.spool.append(rows)
+            self.spool.sync()
+        except OSError as err:
+            print(f"  Spool Fehler: {err} ({len(rows)} Zeilen verworfen, werden wiederholt)")
+            return {}
+        ms = (time.monotonic() - t0) * 1000
+
+        expected.update(acks)
+        self.flushes += 1
+        self.flushed_rows += len(rows)
+        self.max_flush_rows = max(self.max_flush_rows, len(rows))
+        self.flush_ms += ms
+        self.max_flush_ms = max(self.max_flush_ms, ms)
+        self.max_wait_ms = max(self.max_wait_ms, wait_ms)
+        return acks
+
+    def report(self):
+        """Gibt Gruppengröße und Dauer des Sicherns seit dem letzten Aufruf aus."""
+        if self.flushes:
+            print(f"  Spool: {self.flushes} Gruppen, {self.flushed_rows} Zeilen "
+                  f"(Ø {self.flushed_rows / self.flushes:.1f}, max {self.max_flush_rows}), "
+                  f"fsync Ø {self.flush_ms / self.flushes:.1f} ms max {self.max_flush_ms:.1f} ms, "
+                  f"Wartezeit max {self.max_wait_ms:.1f} ms")
+        self.flushes = self.flushed_rows = self.max_flush_rows = 0
+        self.flush_ms = self.max_flush_ms = self.max_wait_ms = 0.0
+
+
+class Drainer(threading.Thread):
+    """Überträgt den Spool im Hintergrund in MySQL (eigene Verbindung, ein Commit pro Gruppe)."""
+
+    def __init__(self, spool, max_rows):
+        super().__init__(name="drain", daemon=True)
+        self.spool = spool
+        self.max_rows = max_rows
+        self.conn = None
+        # Stand unbekannter Geräte/Starts: vom Haupt-Thread angefragt, hier abgefragt, damit die
+        # Ereignisschleife nie auf MySQL wartet
+        self.lock = threading.Lock()
+        self.lookup_keys = set()    # Offene Anfragen
+        self.lookup_done = {}       # (device_id, boot) -> letzte gespeicherte Nummer, None = keine
+        # Statistik seit der letzten Ausgabe (nur Zähler, vom Haupt-Thread gelesen)
+        self.commits = 0
+        self.committed_rows = 0
+        self.commit_ms = 0.0
+        self.max_commit_ms = 0.0
+        self.errors = 0
+
+    def connect(self):
+        if self.conn is None:
+            print("Verbinde mit MySQL...")
+            self.conn = mysql.connector.connect(**MYSQL_CONFIG)
+            print("MySQL Verbindung erfolgreich\n")
+        return self.conn
+
+    def request_lookup(self, key):
+        """Fragt den gespeicherten Stand eines Geräts/Starts an, ohne zu warten (Haupt-Thread).
+
+        Liefert (True, letzte Nummer oder None), sobald die Antwort vorliegt, sonst (False, None).
+        """
+        with self.lock:
+            if key in self.lookup_done:
+                return True, self.lookup_done.pop(key)
+            self.lookup_keys.add(key)
+        self.spool.wake()
+        return False, None
+
+    def lookup(self, conn):
+        """Beantwortet offene Anfragen (eine Indexsuche je Gerät/Start)."""
+        with self.lock:
+            keys = list(self.lookup_keys)
+        cursor = conn.cursor()
+        for key in keys:
+            cursor.execute("SELECT MAX(seq) FROM scanned_barcodes WHERE device_id = %s AND boot = %s", key)
+            (last,) = cursor.fetchone()
+            with self.lock:
+                self.lookup_keys.discard(key)
+                self.lookup_done[key] = last
+
+    def run(self):
+        rows, position = [], None
+        delay = 1.0
+        while True:
+            if not rows:
+                rows, position = self.spool.read(self.max_rows, timeout=1.0)
+                if not rows and not self.lookup_keys:
+                    continue
+            t0 = time.monotonic()
+            try:
+                conn = self.connect()
+                if self.lookup_keys:
+                    self.lookup(conn)
+                if rows:
+                    insert_rows(conn.cursor(), rows)
+                    conn.commit()
+            except mysql.connector.Error as err:
+                # Zeilen bleiben im Spool und werden unverändert wiederholt
+                self.errors += 1
+                print(f"  MySQL Fehler: {err} ({len(rows)} Zeilen bleiben im Spool, "
+                      f"neuer Versuch in {delay:.0f} s)")
+                try:
+                    if self.conn is not None:
+                        self.conn.close()
+                except mysql.connector.Error:
+                    pass
+                self.conn = None
+                time.sleep(delay)
+                delay = min(delay * 2, DRAIN_RETRY_MAX_S)
+                continue
+            delay = 1.0
+            if not rows:
+                continue
+            ms = (time.monotonic() - t0) * 1000
+            self.spool.commit(position, len(rows))
+            self.commits += 1
+            self.committed_rows += len(rows)
+            self.commit_ms += ms
+            self.max_commit_ms = max(self.max_commit_ms, ms)
+            rows = []
+
+    def report(self):
+        """Gibt übertragene Zeilen, Dauer der Commits und den offenen Rest des Spools aus."""
+        backlog, segments = self.spool.stats()
+        if self.commits or backlog or self.errors:
+            avg = self.commit_ms / self.commits if self.commits else 0.0
+            print(f"  MySQL: {self.commits} Commits, {self.committed_rows} Zeilen, "
+                  f"Dauer Ø {avg:.1f} ms max {self.max_commit_ms:.1f} ms, {self.errors} Fehler; "
+                  f"im Spool offen: {backlog} Zeilen in {segments} Segment(en)")
+        self.commits = self.committed_rows = self.errors = 0
+        self.commit_ms = self.max_commit_ms = 0.0
+
+
+# Spool öffnen: noch nicht übertragene Scans eines früheren Laufs gehen zuerst in MySQL,
+# ihr Stand gilt als gesichert
+spool = scan_spool.Spool(SPOOL_DIR)
+expected.update(spool.next_seq)
+if spool.recovered:
+    print(f"Spool: {spool.recovered} noch nicht übertragene Scans vorgefunden")
+
+writer = BatchWriter(spool, BATCH_ROWS, BATCH_MS)
+drainer = Drainer(spool, DRAIN_ROWS)
+drainer.start()
+
+class Connection:
+    """Ein verbundenes CH9121-Modul: eigener Empfangspuffer und Sendepuffer."""
+
+    def __init__(self, sock, address):
+        self.sock = sock
+        self.address = address
+        self.decoder = net_frame.Decoder()
+        self.out = bytearray()
+        self.device_id = None
+        self.bad_frames = 0     # Verworfene SCANS-Rahmen mit gültiger CRC, aber kaputtem Inhalt
+        self.next_stats = time.monotonic() + STATS_INTERVAL
+
+    @property
+    def tag(self):
+        """Kennung für Ausgaben: Adresse und, sobald bekannt, Geräte-ID."""
+        tag = f"{self.address[0]}:{self.address[1]}"
+        return tag if self.device_id is None else f"{tag} Gerät {self.device_id:08x}"
+
+    def send(self, data):
+        """Stellt Daten in den Sendepuffer; geschrieben wird, sobald der Socket bereit ist."""
+        if not self.out:
+            selector.modify(self.sock, selectors.EVENT_READ | selectors.EVENT_WRITE, self)
+        self.out += data
+
+    def on_writable(self):
+        sent = self.sock.send(self.out)
+        del self.out[:sent]
+        if not self.out:
+            selector.modify(self.sock, selectors.EVENT_READ, self)
+
+    def on_readable(self):
+        """Liest verfügbare Bytes und verarbeitet alle vollständigen Rahmen.
+
+        Liefert False, wenn die Gegenseite die Verbindung geschlossen hat.
+        """
+        data = self.sock.recv(4096)
+        if not data:
+            return False
+        for ftype, payload in self.decoder.feed(data):
+            # Rahmen der Firmware beginnen mit der Geräte-ID
+            if ftype in (net_frame.SCANS, net_frame.TEXT, net_frame.PING) and len(payload) >= 4:
+                self.device_id = int.from_bytes(payload[:4], "little")
+            # Statistik-Dump der Firmware: nur ausgeben, nicht in die Datenbank
+            if ftype == net_frame.TEXT:
+                print(f"  [{self.tag}] {payload[4:].decode('utf-8', errors='replace')}")
+            elif ftype == net_frame.PING:
+                # Keepalive: sofort beantworten, die Firmware überwacht damit die Verbindung
+                self.send(net_frame.encode_pong(payload))
+            elif ftype == net_frame.SCANS:
+                # Kaputter Inhalt trotz gültiger CRC: Rahmen verwerfen, ohne ACK; die Firmware
+                # wiederholt ihn, die übrigen Verbindungen laufen weiter
+                try:
+                    handle_scans(self, payload)
+                except ValueError as err:
+                    self.bad_frames += 1
+                    print(f"  [{self.tag}] SCANS-Rahmen verworfen ({self.bad_frames} bisher): {err}")
+        if self.decoder.crc_errors:
+            print(f"  [{self.tag}] {self.decoder.crc_errors} Rahmen mit CRC-Fehler verworfen")
+            self.decoder.crc_errors = 0
+        return True
+
+
+# Verbindung, über die ein Gerät/Start zuletzt gesendet hat: ACKs nach dem Sichern gehen dorthin
+owners = {}
+
+
+def flush_and_ack():
+    """Gruppe im Spool sichern, danach kumulative Bestätigung aller betroffenen Geräte/Starts."""
+    for key, next_seq in writer.flush().items():
+        c = owners.get(key)
+        if c is not None:
+            c.send(net_frame.encode_ack(key[0], key[1], next_seq))
+
+
+def handle_scans(c, payload):
+    """Übernimmt die neuen Scans eines SCANS-Rahmens in die gemeinsame Gruppe."""
+    # Zeitstempel = Empfangszeit minus Alter des Scans beim Senden; bei Scans früherer
+    # Starts aus der Zeitbasis des Starts, sofern bekannt (siehe boot_epoch)
+    device_id, boot, t_send_ms, earlier, records = net_frame.decode_scans(payload)
+    key = (device_id, boot)
+    owners[key] = c
+    now = datetime.now()
+    if not earlier:
+        boot_epoch[key] = now - timedelta(milliseconds=t_send_ms)
+    epoch = boot_epoch.get(key)
+    next_seq = writer.expected(key)
+    if next_seq is None and records and records[0][0] != 0:
+        # Weder im Spool noch im Checkpoint: Stand aus der Tabelle (Hintergrund-Thread). Bis
+        # dahin weder übernehmen noch bestätigen; die Firmware wiederholt den Rahmen. Beim
+        # ersten Scan des Rahmens zu beginnen hieße, auf einer toten Verbindung verlorene
+        # Vorgänger kumulativ zu bestätigen.
+        done, last = drainer.request_lookup(key)
+        if not done:
+            return
+        if last is not None:
+            next_seq = (last + 1) & 0xFFFFFFFF
+        else:
+            print(f"  [{c.tag}] Start {boot}: keine gespeicherten Scans, Beginn bei #{records[0][0]}")
+    if next_seq is None:
+        # Neuer Start (Nummer 0) oder nichts gespeichert: Nummern beginnen bei diesem Rahmen
+        next_seq = records[0][0] if records else 0
+    new = []
+    for seq, age_ms, scanner, code in records:
+        if seq == next_seq:
+            new.append((seq, age_ms, scanner, code))
+            next_seq = (next_seq + 1) & 0xFFFFFFFF
+    # device_ms: Zeitstempel auf dem Gerät (ms seit dem Start boot)
+    rows = []
+    for seq, age_ms, scanner, code in new:
+        device_ms = (t_send_ms - age_ms) & 0xFFFFFFFF
+        if not earlier:
+            timestamp = now - timedelta(milliseconds=age_ms)
+        elif epoch is not None:
+            timestamp = epoch + timedelta(milliseconds=device_ms)
+        else:
+            timestamp = None
+        rows.append((code, timestamp, device_id, boot, seq, scanner, device_ms))
+    writer.add(key, next_seq, rows)
+    if LOG_SCANS:
+        for seq, _, scanner, code in new:
+            print(f"  [{c.tag}] Barcode empfangen: {code} (Scanner {scanner}, #{seq})")
+
+    # Nur Wiederholungen: sofort mit dem gesicherten Stand bestätigen; sonst nach dem Sichern
+    if not writer.pending(key) and key in expected:
+        c.send(net_frame.encode_ack(device_id, boot, expected[key]))
+    if len(writer.rows) >= writer.max_rows:
+        flush_and_ack()
+
+
+def close(c):
+    selector.unregister(c.sock)
+    c.sock.close()
+    for key in [k for k, owner in owners.items() if owner is c]:
+        del owners[key]
+    print(f"Verbindung von {c.tag} getrennt ({len(selector.get_map()) - 1} verbunden)")
+
 
 # TCP Server erstellen
+# Alle Module teilen einen Thread: ein Selector meldet lesbare/schreibbare Sockets, jede
+# Verbindung hat ihre eigenen Puffer, neue Scans aller Verbindungen landen in derselben
+# Gruppe (BatchWriter).
+selector = selectors.DefaultSelector()
 server_socket = socket.socket(socket.AF_INET, socket.SOCK_STREAM)
 server_socket.setsockopt(socket.SOL_SOCKET, socket.SO_REUSEADDR, 1)
-server_socket.bind(('0.0.0.0', 5000))  # Port 5000, lauscht auf allen Interfaces
-server_socket.listen(1)
+server_socket.bind(('0.0.0.0', PORT))  # Lauscht auf allen Interfaces
+server_socket.listen(128)
+server_socket.setblocking(False)
+selector.register(server_socket, selectors.EVENT_READ, None)
 
 print("=" * 50)
 print("MySQL Bridge Server gestartet")
-print("Port: 5000")
-print("Warte auf Verbindung vom Pico...")
+print(f"Port: {PORT}")
+print("Warte auf Verbindungen...")
 print("=" * 50)
 
+next_report = time.monotonic() + BATCH_REPORT_INTERVAL
+
 while True:
-    client_socket, address = server_socket.accept()
-    print(f"\nVerbindung von {address}")
-    
-    buffer = ""
-    
-    try:
-        while True:
-            data = client_socket.recv(1024)
-            if not data:
-                break
-            
-            # Daten zum Buffer hinzufügen
-            buffer += data.decode('utf-8', errors='ignore')
-            
-            # Verarbeite alle vollständigen Zeilen (getrennt durch \n)
-            while '\n' in buffer:
-                line, buffer = buffer.split('\n', 1)
-                barcode = line.strip()
-                
-                if barcode:
-                    try:
-                        sql = "INSERT INTO scanned_barcodes (barcode, timestamp) VALUES (%s, %s)"
-                        values = (barcode, datetime.now())
-                        cursor.execute(sql, values)
-                        conn.commit()
-                        print(f"  Barcode eingefügt: {barcode}")
-                    except mysql.connector.Error as err:
-                        print(f"  MySQL Fehler: {err}")
-
-    except Exception as e:
-        print(f"Verbindungsfehler: {e}")
-    
-    finally:
-        client_socket.close()
-        print(f"Verbindung von {address} getrennt")
-        print("Warte auf neue Verbindung...\n")
+    # Warten bis Daten kommen, höchstens bis zum nächsten fälligen Sichern bzw. Kommando
+    now = time.monotonic()
+    timeouts = [writer.timeout()]
+    if BATCH_REPORT_INTERVAL > 0:
+        timeouts.append(max(0.0, next_report - now))
+    if STATS_INTERVAL > 0:
+        timeouts += [max(0.0, key.data.next_stats - now) for key in selector.get_map().values() if key.data]
+    timeouts = [t for t in timeouts if t is not None]
+
+    for key, events in selector.select(min(timeouts) if timeouts else None):
+        if key.data is None:
+            sock, address = server_socket.accept()
+            sock.setblocking(False)
+            c = Connection(sock, address)
+            selector.register(sock, selectors.EVENT_READ, c)
+            print(f"\nVerbindung von {c.tag} ({len(selector.get_map()) - 1} verbunden)")
+            continue
+        c = key.data
+        try:
+            if events & selectors.EVENT_WRITE:
+                c.on_writable()
+            if events & selectors.EVENT_READ and not c.on_readable():
+                close(c)
+        except OSError as e:
+            print(f"Verbindungsfehler [{c.tag}]: {e}")
+            close(c)
+
+    # Gesammeltes speichern (auch von inzwischen getrennten Verbindungen; deren ACK holt
+    # die Firmware beim nächsten Rahmen nach, Wiederholungen gelten dann als gespeichert)
+    if writer.due():
+        flush_and_ack()
+
+    now = time.monotonic()
+    if BATCH_REPORT_INTERVAL > 0 and now >= next_report:
+        writer.report()
+        drainer.report()
+        next_report = now + BATCH_REPORT_INTERVAL
+    if STATS_INTERVAL > 0:
+        for key in list(selector.get_map().values()):
+            c = key.data
+            if c and now >= c.next_stats:
+                c.send(net_frame.encode_cmd("STATS"))
+                c.next_stats = now + STATS_INTERVAL
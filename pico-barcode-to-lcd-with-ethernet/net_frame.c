@@ -0,0 +1,186 @@
+// Binäres Rahmenformat zwischen Firmware und mysql_bridge.py (siehe net_frame.h)
+
+#include "net_frame.h"
+#include <string.h>
+
+// Zustände des Empfangsautomaten
+enum { PARSE_SOF0 = 0, PARSE_SOF1, PARSE_TYPE, PARSE_LEN0, PARSE_LEN1, PARSE_DATA, PARSE_CRC0, PARSE_CRC1 };
+
+static inline void put_u16(uint8_t* p, uint16_t v) {
+    p[0] = (uint8_t)v;
+    p[1] = (uint8_t)(v >> 8);
+}
+
+static inline void put_u32(uint8_t* p, uint32_t v) {
+    p[0] = (uint8_t)v;
+    p[1] = (uint8_t)(v >> 8);
+    p[2] = (uint8_t)(v >> 16);
+    p[3] = (uint8_t)(v >> 24);
+}
+
+uint16_t net_frame_crc16(uint16_t crc, const uint8_t* data, size_t len) {
+    while (len--) {
+        crc ^= (uint16_t)(*data++ << 8);
+        for (int i = 0; i < 8; ++i) crc = (crc & 0x8000) ? (uint16_t)((crc << 1) ^ 0x1021) : (uint16_t)(crc << 1);
+    }
+    return crc;
+}
+
+// Schreibt Kopf und CRC um bereits abgelegte Nutzdaten (out[NET_FRAME_HEAD..])
+static size_t net_frame_seal(uint8_t* out, uint8_t type, uint16_t len) {
+    out[0] = NET_FRAME_SOF0;
+    out[1] = NET_FRAME_SOF1;
+    out[2] = type;
+    put_u16(&out[3], len);
+    put_u16(&out[NET_FRAME_HEAD + len], net_frame_crc16(0xFFFF, &out[2], (size_t)len + 3));
+    return (size_t)len + NET_FRAME_OVERHEAD;
+}
+
+size_t net_frame_wrap(uint8_t* out, uint8_t type, const void* payload, uint16_t len) {
+    memmove(&out[NET_FRAME_HEAD], payload, len);
+    return net_frame_seal(out, type, len);
+}
+
+void net_batch_begin(net_batch_t* b, uint32_t device_id, uint16_t boot) {
+    b->device_id = device_id;
+    b->boot = boot;
+    b->body_len = 0;
+    b->worst = NET_SCANS_HEAD;
+    b->count = 0;
+}
+
+// true, wenn der Code nur aus Ziffern besteht (dann BCD-gepackt)
+static bool net_code_is_digits(const char* code, uint8_t len) {
+    for (uint8_t i = 0; i < len; ++i) {
+        if (code[i] < '0' || code[i] > '9') return false;
+    }
+    return true;
+}
+
+size_t net_code_pack(uint8_t* out, const char* code, uint8_t len) {
+    bool const packed = net_code_is_digits(code, len);
+
+    out[0] = (uint8_t)(len | (packed ? 0x80 : 0x00));
+    if (!packed) {
+        memcpy(&out[1], code, len);
+        return 1u + len;
+    }
+    for (uint8_t i = 0; i < len; i += 2) {
+        uint8_t const hi = (uint8_t)(code[i] - '0');
+        uint8_t const lo = (i + 1 < len) ? (uint8_t)(code[i + 1] - '0') : 0x0F;
+        out[1 + i / 2] = (uint8_t)((hi << 4) | lo);
+    }
+    return 1u + (len + 1u) / 2u;
+}
+
+size_t net_code_unpack(char* out, size_t cap, const uint8_t* in, uint8_t* len) {
+    uint8_t const n = in[0] & 0x7F;
+    if (n >= cap) return 0;
+
+    if (in[0] & 0x80) {
+        for (uint8_t i = 0; i < n; ++i) out[i] = (char)('0' + ((in[1 + i / 2] >> ((i & 1) ? 0 : 4)) & 0x0F));
+    } else {
+        memcpy(out, &in[1], n);
+    }
+    out[n] = '\0';
+    *len = n;
+    return 1u + ((in[0] & 0x80) ? (n + 1u) / 2u : n);
+}
+
+bool net_batch_add(net_batch_t* b, uint32_t seq, uint32_t t_ms, uint8_t scanner, const char* code, uint8_t len) {
+    if (len > 0x7F || b->count >= NET_FRAME_RECORDS_MAX) return false;
+    if (b->count && seq != b->first_seq + b->count) return false;
+    if (b->worst + NET_SCANS_RECORD_MAX + len > NET_FRAME_PAYLOAD_MAX) return false;
+
+    if (b->count == 0) b->first_seq = seq;
+    uint8_t* p = &b->body[b->body_len];
+    p[0] = scanner;
+    size_t const n = 1 + net_code_pack(&p[1], code, len);
+    b->body_len = (uint16_t)(b->body_len + n);
+    b->worst = (uint16_t)(b->worst + NET_SCANS_RECORD_MAX - 2 + n);
+    b->rec_end[b->count] = b->body_len;
+    b->rec_t_ms[b->count] = t_ms;
+    b->count++;
+    return true;
+}
+
+size_t net_batch_finish(net_batch_t* b, uint32_t t_send_ms, bool earlier) {
+    uint8_t* const payload = &b->buf[NET_FRAME_HEAD];
+    put_u32(&payload[0], b->device_id);
+    put_u16(&payload[4], b->boot);
+    put_u32(&payload[6], t_send_ms);
+    put_u32(&payload[10], b->first_seq);
+    payload[14] = (uint8_t)(b->count | (earlier ? NET_SCANS_EARLIER : 0));
+
+    size_t pos = NET_SCANS_HEAD;
+    uint16_t start = 0;
+    for (uint8_t i = 0; i < b->count; ++i) {
+        // age_ms als LEB128
+        uint32_t age_ms = t_send_ms - b->rec_t_ms[i];
+        while (age_ms >= 0x80) {
+            payload[pos++] = (uint8_t)(age_ms | 0x80);
+            age_ms >>= 7;
+        }
+        payload[pos++] = (uint8_t)age_ms;
+
+        memcpy(&payload[pos], &b->body[start], b->rec_end[i] - start);
+        pos += b->rec_end[i] - start;
+        start = b->rec_end[i];
+    }
+    return net_frame_seal(b->buf, NET_FRAME_SCANS, (uint16_t)pos);
+}
+
+void net_frame_parser_init(net_frame_parser_t* p, uint8_t* payload, uint16_t cap) {
+    memset(p, 0, sizeof(*p));
+    p->payload = payload;
+    p->cap = cap;
+}
+
+bool net_frame_parse(net_frame_parser_t* p, uint8_t byte) {
+    switch (p->state) {
+    case PARSE_SOF0:
+        if (byte == NET_FRAME_SOF0) p->state = PARSE_SOF1;
+        break;
+    case PARSE_SOF1:
+        p->state = (byte == NET_FRAME_SOF1) ? PARSE_TYPE : (byte == NET_FRAME_SOF0 ? PARSE_SOF1 : PARSE_SOF0);
+        break;
+    case PARSE_TYPE:
+        p->type = byte;
+        p->crc = net_frame_crc16(0xFFFF, &byte, 1);
+        p->state = PARSE_LEN0;
+        break;
+    case PARSE_LEN0:
+        p->len = byte;
+        p->crc = net_frame_crc16(p->crc, &byte, 1);
+        p->state = PARSE_LEN1;
+        break;
+    case PARSE_LEN1:
+        p->len |= (uint16_t)(byte << 8);
+        p->crc = net_frame_crc16(p->crc, &byte, 1);
+        p->pos = 0;
+        if (p->len > p->cap) {
+            p->oversize++;
+            p->state = PARSE_SOF0;
+        } else {
+            p->state = p->len ? PARSE_DATA : PARSE_CRC0;
+        }
+        break;
+    case PARSE_DATA:
+        p->payload[p->pos++] = byte;
+        if (p->pos == p->len) {
+            p->crc = net_frame_crc16(p->crc, p->payload, p->len);
+            p->state = PARSE_CRC0;
+        }
+        break;
+    case PARSE_CRC0:
+        p->crc ^= byte;
+        p->state = PARSE_CRC1;
+        break;
+    case PARSE_CRC1:
+        p->state = PARSE_SOF0;
+        if ((p->crc ^ (uint16_t)(byte << 8)) == 0) return true;
+        p->crc_errors++;
+        break;
+    }
+    return false;
+}
@@ -0,0 +1,145 @@
+// Binäres Rahmenformat zwischen Firmware und mysql_bridge.py (Gegenstück: net_frame.py)
+//
+// Rahmen (alle Mehrbyte-Felder Little Endian):
+//   0xA5 0x5A | Typ (1) | Länge (2) | Nutzdaten (Länge) | CRC-16 (2)
+// Die CRC (CCITT, Polynom 0x1021, Start 0xFFFF) läuft über Typ, Länge und Nutzdaten.
+// Ein Empfänger synchronisiert sich nach Fehlern auf das nächste 0xA5 0x5A neu.
+//
+// Nutzdaten NET_FRAME_SCANS (Firmware -> Server):
+//   device_id (4) | boot (2) | t_send_ms (4) | first_seq (4) | count (1) | Einträge
+//     boot:      Startzähler der Firmware (Scan-Nummern beginnen mit jedem Start neu);
+//                ein Rahmen enthält nur Scans eines Starts
+//     t_send_ms: Bezugszeit der Einträge in ms seit dem Start boot; für Scans des
+//                laufenden Starts der Sendezeitpunkt, sonst der Zeitstempel des jüngsten
+//     count:     Bit 0-6 Anzahl Einträge; Bit 7 (NET_SCANS_EARLIER): Scans eines früheren
+//                Starts aus dem Journal, ihr Alter ist nur relativ zum jüngsten bekannt
+//   Eintrag: age_ms (1-5) | scanner (1) | len (1) | code
+//     age_ms:  t_send_ms - Terminator-Zeitstempel, als LEB128 (7 Bit pro Byte,
+//              Bit 7 = weiteres Byte folgt); unter 128 ms genügt ein Byte
+//     scanner: USB-Geräteadresse des Scanners
+//     len:     Bit 7 gesetzt = reine Ziffernfolge, zwei Ziffern pro Byte (BCD,
+//              oberes Nibble zuerst, ungerade Länge mit 0xF aufgefüllt);
+//              Bit 0-6 = Anzahl Zeichen
+//   Die Scan-Nummern der Einträge sind fortlaufend ab first_seq.
+//
+// Nutzdaten NET_FRAME_TEXT (Firmware -> Server): device_id (4) | Text (UTF-8)
+// Nutzdaten NET_FRAME_ACK  (Server -> Firmware): device_id (4) | boot (2) | next_seq (4)
+//   Kumulative Bestätigung: alle Scans mit Nummer < next_seq sind gespeichert.
+// Nutzdaten NET_FRAME_CMD  (Server -> Firmware): Kommando als Text, z.B. "STATS"
+// Nutzdaten NET_FRAME_PING (Firmware -> Server): device_id (4) | t_us (4)
+//   Keepalive (siehe net_link.h); der Server antwortet mit NET_FRAME_PONG und denselben
+//   Nutzdaten, t_us ergibt die Umlaufzeit.
+
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#define NET_FRAME_SOF0 0xA5
+#define NET_FRAME_SOF1 0x5A
+
+// Startbytes + Typ + Länge vorne, CRC hinten
+#define NET_FRAME_HEAD     5
+#define NET_FRAME_OVERHEAD (NET_FRAME_HEAD + 2)
+
+// Maximale Nutzdatenlänge eines Rahmens
+#ifndef NET_FRAME_PAYLOAD_MAX
+#define NET_FRAME_PAYLOAD_MAX 512
+#endif
+
+// Maximale Anzahl Scans pro Rahmen
+#ifndef NET_FRAME_RECORDS_MAX
+#define NET_FRAME_RECORDS_MAX 16
+#endif
+#if NET_FRAME_RECORDS_MAX > 0x7F
+#error "NET_FRAME_RECORDS_MAX muss in Bit 0-6 von count passen"
+#endif
+
+// Kopf der SCANS-Nutzdaten; ein Eintrag belegt höchstens NET_SCANS_RECORD_MAX + Code
+#define NET_SCANS_HEAD       15
+#define NET_SCANS_EARLIER    0x80
+#define NET_SCANS_RECORD_MAX 7
+#define NET_ACK_LEN          10
+#define NET_PING_LEN         8
+
+typedef enum {
+    NET_FRAME_SCANS = 0x01,     // Gesammelte Scans
+    NET_FRAME_TEXT  = 0x02,     // Textzeile (Statistik, Log)
+    NET_FRAME_PING  = 0x03,     // Keepalive
+    NET_FRAME_ACK   = 0x81,     // Kumulative Bestätigung vom Server
+    NET_FRAME_CMD   = 0x82,     // Kommando vom Server
+    NET_FRAME_PONG  = 0x83,     // Antwort auf NET_FRAME_PING
+} net_frame_type_t;
+
+// CRC-16/CCITT (Polynom 0x1021, Start 0xFFFF, ohne Endinvertierung)
+uint16_t net_frame_crc16(uint16_t crc, const uint8_t* data, size_t len);
+
+// Verpackt Nutzdaten in einen Rahmen
+// Parameter out: Zielpuffer (mind. len + NET_FRAME_OVERHEAD)
+// Rückgabe: Rahmenlänge
+size_t net_frame_wrap(uint8_t* out, uint8_t type, const void* payload, uint16_t len);
+
+// Legt einen Code wie im Eintrag ab: len-Byte (Bit 7 = BCD), dann die Zeichen
+// Parameter out: Ziel (mind. 1 + len Bytes)
+// Rückgabe: geschriebene Bytes
+size_t net_code_pack(uint8_t* out, const char* code, uint8_t len);
+
+// Gegenstück zu net_code_pack()
+// Parameter out: Ziel der Größe cap, wird null-terminiert
+// Parameter len: Anzahl Zeichen
+// Rückgabe: gelesene Bytes (0 = Code passt nicht in out)
+size_t net_code_unpack(char* out, size_t cap, const uint8_t* in, uint8_t* len);
+
+// Ein SCANS-Rahmen im Aufbau
+// Die Einträge werden ohne age_ms in body gesammelt; net_batch_finish() setzt daraus
+// den Rahmen in buf zusammen, sobald die Sendezeit feststeht.
+typedef struct {
+    uint8_t buf[NET_FRAME_OVERHEAD + NET_FRAME_PAYLOAD_MAX];
+    uint8_t body[NET_FRAME_PAYLOAD_MAX];        // scanner | len | code je Eintrag
+    uint16_t body_len;
+    uint16_t worst;                             // Nutzdatenlänge bei längstem age_ms
+    uint8_t count;                              // Anzahl Einträge
+    uint32_t device_id;
+    uint16_t boot;
+    uint32_t first_seq;                         // Scan-Nummer des ersten Eintrags
+    uint16_t rec_end[NET_FRAME_RECORDS_MAX];    // Ende jedes Eintrags in body
+    uint32_t rec_t_ms[NET_FRAME_RECORDS_MAX];   // Terminator-Zeitstempel jedes Eintrags
+} net_batch_t;
+
+// Beginnt einen neuen SCANS-Rahmen
+void net_batch_begin(net_batch_t* b, uint32_t device_id, uint16_t boot);
+
+// Hängt einen Scan an
+// Parameter seq: Scan-Nummer (muss direkt auf den vorherigen Eintrag folgen)
+// Parameter t_ms: Terminator-Zeitstempel in ms seit dem Start
+// Parameter scanner: USB-Geräteadresse
+// Rückgabe: false, wenn der Scan nicht mehr hineinpasst oder nicht fortlaufend ist
+bool net_batch_add(net_batch_t* b, uint32_t seq, uint32_t t_ms, uint8_t scanner, const char* code, uint8_t len);
+
+// Setzt den Rahmen in b->buf zusammen (Bezugszeit, Alter der Einträge, Länge, CRC)
+// Parameter t_send_ms: Bezugszeit (nicht älter als der jüngste Eintrag)
+// Parameter earlier: Scans eines früheren Starts (setzt NET_SCANS_EARLIER)
+// Rückgabe: Rahmenlänge in b->buf
+size_t net_batch_finish(net_batch_t* b, uint32_t t_send_ms, bool earlier);
+
+// Empfangsautomat für Rahmen
+typedef struct {
+    uint8_t state;
+    uint8_t type;
+    uint16_t len;
+    uint16_t pos;
+    uint16_t crc;
+    uint8_t* payload;           // Puffer des Aufrufers
+    uint16_t cap;               // Größe des Puffers
+    uint32_t crc_errors;        // Verworfene Rahmen (CRC falsch)
+    uint32_t oversize;          // Verworfene Rahmen (länger als cap)
+} net_frame_parser_t;
+
+// Initialisiert den Empfangsautomaten mit einem Nutzdatenpuffer
+void net_frame_parser_init(net_frame_parser_t* p, uint8_t* payload, uint16_t cap);
+
+// Übernimmt ein empfangenes Byte
+// Rückgabe: true, wenn damit ein gültiger Rahmen vollständig ist
+//           (p->type, p->len und p->payload gelten bis zum nächsten Aufruf)
+bool net_frame_parse(net_frame_parser_t* p, uint8_t byte);
@@ -0,0 +1,131 @@
+"""
+Binäres Rahmenformat zwischen Firmware und mysql_bridge.py (Gegenstück: net_frame.h)
+
+Rahmen (Little Endian):
+    0xA5 0x5A | Typ (1) | Länge (2) | Nutzdaten | CRC-16/CCITT über Typ, Länge, Nutzdaten
+"""
+
+import binascii
+import struct
+
+SOF = b"\xa5\x5a"
+HEAD = 5
+OVERHEAD = HEAD + 2
+PAYLOAD_MAX = 512
+
+SCANS = 0x01
+TEXT = 0x02
+PING = 0x03
+ACK = 0x81
+CMD = 0x82
+PONG = 0x83
+
+SCANS_HEAD = struct.Struct("<IHIIB")    # device_id, boot, t_send_ms, first_seq, count
+SCANS_EARLIER = 0x80                    # Bit in count: Scans eines früheren Starts (aus dem Journal)
+ACK_BODY = struct.Struct("<IHI")        # device_id, boot, next_seq
+
+
+def crc16(data, crc=0xFFFF):
+    return binascii.crc_hqx(data, crc)
+
+
+def encode(ftype, payload):
+    """Verpackt Nutzdaten in einen Rahmen."""
+    body = struct.pack("<BH", ftype, len(payload)) + payload
+    return SOF + body + struct.pack("<H", crc16(body))
+
+
+def encode_cmd(text):
+    return encode(CMD, text.encode("ascii"))
+
+
+def encode_pong(ping_payload):
+    """Antwort auf einen Keepalive: Nutzdaten unverändert zurück (Umlaufzeit)."""
+    return encode(PONG, ping_payload)
+
+
+def encode_ack(device_id, boot, next_seq):
+    """Kumulative Bestätigung: alle Scans mit Nummer < next_seq sind gespeichert."""
+    return encode(ACK, ACK_BODY.pack(device_id, boot, next_seq & 0xFFFFFFFF))
+
+
+class Decoder:
+    """Setzt Rahmen aus einem Bytestrom zusammen und synchronisiert sich nach Fehlern neu."""
+
+    def __init__(self):
+        self.buf = bytearray()
+        self.crc_errors = 0
+
+    def feed(self, data):
+        """Liefert alle mit data vollständigen Rahmen als (Typ, Nutzdaten)."""
+        self.buf += data
+        frames = []
+        while True:
+            start = self.buf.find(SOF)
+            if start < 0:
+                # Ein einzelnes 0xA5 am Ende kann der Anfang des nächsten Rahmens sein
+                del self.buf[:-1]
+                break
+            del self.buf[:start]
+            if len(self.buf) < HEAD:
+                break
+            ftype, length = struct.unpack_from("<BH", self.buf, 2)
+            if length > PAYLOAD_MAX:
+                del self.buf[:1]
+                continue
+            if len(self.buf) < length + OVERHEAD:
+                break
+            body = bytes(self.buf[2:HEAD + length])
+            (crc,) = struct.unpack_from("<H", self.buf, HEAD + length)
+            if crc16(body) != crc:
+                self.crc_errors += 1
+                del self.buf[:1]
+                continue
+            del self.buf[:length + OVERHEAD]
+            frames.append((ftype, body[3:]))
+        return frames
+
+
+def decode_scans(payload):
+    """
+    Zerlegt die Nutzdaten eines SCANS-Rahmens.
+    Rückgabe: (device_id, boot, t_send_ms, earlier, [(seq, age_ms, scanner, code), ...])
+    earlier: Scans eines früheren Starts; t_send_ms ist dann nicht der Sendezeitpunkt,
+    sondern der Zeitstempel des jüngsten Eintrags.
+    ValueError, wenn die Nutzdaten zu kurz sind oder ein Eintrag über ihr Ende hinausreicht.
+    """
+    if len(payload) < SCANS_HEAD.size:
+        raise ValueError(f"SCANS-Kopf zu kurz ({len(payload)} Bytes)")
+    device_id, boot, t_send_ms, seq, count = SCANS_HEAD.unpack_from(payload)
+    earlier = bool(count & SCANS_EARLIER)
+    count &= ~SCANS_EARLIER
+    pos = SCANS_HEAD.size
+    records = []
+    for i in range(count):
+        age_ms, shift = 0, 0
+        while True:
+            if pos >= len(payload) or shift > 28:
+                raise ValueError(f"Eintrag {i}: Alter unvollständig")
+            b = payload[pos]
+            pos += 1
+            age_ms |= (b & 0x7F) << shift
+            shift += 7
+            if not b & 0x80:
+                break
+        if pos + 2 > len(payload):
+            raise ValueError(f"Eintrag {i}: Scanner/Länge fehlen")
+        scanner, flags = payload[pos], payload[pos + 1]
+        pos += 2
+        length = flags & 0x7F
+        size = (length + 1) // 2 if flags & 0x80 else length
+        if pos + size > len(payload):
+            raise ValueError(f"Eintrag {i}: Code reicht über das Ende ({pos + size} > {len(payload)})")
+        data = payload[pos:pos + size]
+        pos += size
+        if flags & 0x80:
+            code = data.hex()[:length]
+        else:
+            code = data.decode("utf-8", errors="replace")
+        records.append((seq, age_ms, scanner, code))
+        seq = (seq + 1) & 0xFFFFFFFF
+    return device_id, boot, t_send_ms, earlier, records
@@ -0,0 +1,213 @@
+// Zustand der Verbindung zum Server und Wiederherstellung über RES_PIN (siehe net_link.h)
+
+#include "net_link.h"
+#include "net_frame.h"
+#include "net_uart.h"
+#include "CH9121.h"
+#include "pico/time.h"
+
+// Laufende Aktion am CH9121 (UART0 bzw. das Modul sind solange belegt)
+typedef enum { LINK_OP_NONE = 0, LINK_OP_STATUS, LINK_OP_RESET } link_op_t;
+
+static net_link_state_t g_state;
+static link_op_t g_op;
+static uint32_t g_device_id;
+static uint32_t g_baud;
+
+static uint32_t g_t_rx;             // Letzter Rahmen vom Server (bzw. Beginn von CONNECTING)
+static uint32_t g_t_ping;           // Letzter PING
+static uint32_t g_t_status;         // Letzte Statusabfrage
+static uint32_t g_t_lost;           // Ausfall erkannt (UP verlassen)
+static uint32_t g_t_reset;          // Letzter Reset
+static bool g_outage;               // Ausfall läuft (g_t_lost gültig)
+static bool g_reset_in_outage;      // Während dieses Ausfalls zurückgesetzt
+static bool g_query_due;            // Statusabfrage fällig (wartet ggf. auf UART0)
+static bool g_module_lost;          // Modul meldete in diesem Ausfall keine Verbindung
+static uint32_t g_holdoff_ms = NET_LINK_RESET_HOLDOFF_MS;
+
+static net_link_stats_t g_stats;
+
+static void net_link_enter(net_link_state_t state, uint32_t now) {
+    if (state == g_state) return;
+    if (g_state == NET_LINK_UP) {
+        g_t_lost = now;
+        g_outage = true;
+        g_reset_in_outage = false;
+        g_module_lost = false;
+    }
+    if (state == NET_LINK_DEGRADED) g_stats.degraded++;
+    if (state == NET_LINK_DOWN) g_stats.downs++;
+    g_state = state;
+    g_stats.state = state;
+}
+
+void net_link_init(uint32_t device_id, uint32_t baud) {
+    g_device_id = device_id;
+    g_baud = baud;
+    g_state = NET_LINK_CONNECTING;
+    g_stats.state = g_state;
+    g_t_rx = time_us_32();
+}
+
+// Fällige Statusabfrage beim CH9121 starten, sobald UART0 alles gesendet hat
+// Rückgabe: true, wenn sie gestartet wurde
+static bool net_link_query(uint32_t now) {
+    if (!g_query_due || !net_uart_tx_idle()) return false;
+    g_query_due = false;
+    net_uart_suspend();
+    CH9121_status_begin();
+    g_op = LINK_OP_STATUS;
+    g_t_status = now;
+    g_stats.status_queries++;
+    return true;
+}
+
+// Hart zurücksetzen, sofern der Mindestabstand zum letzten Reset eingehalten ist
+static void net_link_reset(uint32_t now) {
+    if (g_reset_in_outage && (now - g_t_reset) / 1000u < g_holdoff_ms) return;
+
+    // Jeder weitere Reset ohne zwischenzeitliche Verbindung wartet doppelt so lange
+    if (g_reset_in_outage) {
+        g_holdoff_ms = (g_holdoff_ms * 2 < NET_LINK_RESET_MAX_MS) ? g_holdoff_ms * 2 : NET_LINK_RESET_MAX_MS;
+    }
+    CH9121_reset_begin();
+    g_op = LINK_OP_RESET;
+    g_t_reset = now;
+    g_reset_in_outage = true;
+    g_stats.resets++;
+}
+
+// Auswertung der Statusabfrage
+static void net_link_on_status(int8_t tcp_status, uint32_t now) {
+    if (g_state == NET_LINK_UP) return;     // Inzwischen kam eine Antwort
+
+    if (tcp_status < 0) {
+        // Modul antwortet nicht
+        g_stats.status_failures++;
+        net_link_enter(NET_LINK_DOWN, now);
+        net_link_reset(now);
+    } else if (tcp_status == 0) {
+        // Modul baut selbst neu auf; nur wenn das zu lange dauert, zurücksetzen
+        g_module_lost = true;
+        net_link_enter(NET_LINK_DOWN, now);
+        if ((now - g_t_lost) / 1000u >= NET_LINK_RESET_MS) net_link_reset(now);
+    } else if (g_state == NET_LINK_DOWN && g_module_lost) {
+        // Modul hat selbst neu verbunden: auf die erste Antwort warten
+        g_module_lost = false;
+        net_link_enter(NET_LINK_CONNECTING, now);
+        g_t_rx = now;
+    } else if (g_state == NET_LINK_DOWN) {
+        // Modul hält eine Verbindung, über die nichts mehr zurückkommt: halboffen
+        net_link_reset(now);
+    }
+}
+
+bool net_link_on_rx(uint8_t type, const uint8_t* payload, uint16_t len) {
+    uint32_t const now = time_us_32();
+    g_t_rx = now;
+
+    if (type == NET_FRAME_PONG && len >= NET_PING_LEN) {
+        uint32_t const t_us = (uint32_t)payload[4] | (uint32_t)payload[5] << 8 | (uint32_t)payload[6] << 16 |
+                              (uint32_t)payload[7] << 24;
+        g_stats.rtt_us = now - t_us;
+        g_stats.pongs++;
+    }
+    if (g_state == NET_LINK_UP) return false;
+
+    net_link_state_t const prev = g_state;
+    if (g_outage) {
+        uint32_t const ms = (now - g_t_lost) / 1000u;
+        g_stats.reconnects++;
+        g_stats.last_reconnect_ms = ms;
+        if (ms > g_stats.max_reconnect_ms) g_stats.max_reconnect_ms = ms;
+        if (g_reset_in_outage) g_stats.last_reset_ms = (now - g_t_reset) / 1000u;
+    }
+    g_outage = false;
+    g_holdoff_ms = NET_LINK_RESET_HOLDOFF_MS;
+    g_state = NET_LINK_UP;
+    g_stats.state = g_state;
+
+    // Neue TCP-Verbindung: was zuvor unterwegs war, ist verloren
+    return prev == NET_LINK_CONNECTING || prev == NET_LINK_DOWN;
+}
+
+// Keepalive senden (Nutzdaten: device_id | Sendezeitpunkt)
+static void net_link_ping(uint32_t now) {
+    uint8_t payload[NET_PING_LEN];
+    uint8_t frame[NET_PING_LEN + NET_FRAME_OVERHEAD];
+
+    for (int i = 0; i < 4; ++i) {
+        payload[i] = (uint8_t)(g_device_id >> (8 * i));
+        payload[4 + i] = (uint8_t)(now >> (8 * i));
+    }
+    if (net_send(frame, net_frame_wrap(frame, NET_FRAME_PING, payload, sizeof(payload)))) g_stats.pings++;
+    g_t_ping = now;
+}
+
+bool net_link_poll(void) {
+    uint32_t const now = time_us_32();
+
+    // Laufende Statusabfrage oder Reset vorantreiben
+    if (g_op != LINK_OP_NONE) {
+        CH9121_State const st = CH9121_poll();
+        if (st != CH9121_DONE && st != CH9121_FAILED) return true;
+
+        if (g_op == LINK_OP_STATUS) {
+            // UART0 zurück in den Datenbetrieb
+            net_uart_init(g_baud);
+            g_op = LINK_OP_NONE;
+            CH9121_Stats cs;
+            CH9121_get_stats(&cs);
+            net_link_on_status(cs.tcp_status, now);
+        } else {
+            // Modul startet neu und verbindet sich; Stille ab jetzt zählen
+            g_op = LINK_OP_NONE;
+            net_link_enter(NET_LINK_CONNECTING, now);
+            g_t_rx = now;
+        }
+        return true;
+    }
+
+    uint32_t const silence_ms = (now - g_t_rx) / 1000u;
+    switch (g_state) {
+    case NET_LINK_UP:
+        if (silence_ms >= NET_LINK_DEGRADED_MS) {
+            net_link_enter(NET_LINK_DEGRADED, now);
+            g_query_due = true;
+        }
+        break;
+    case NET_LINK_CONNECTING:
+    case NET_LINK_DEGRADED:
+        if (silence_ms >= NET_LINK_DEAD_MS) {
+            net_link_enter(NET_LINK_DOWN, now);
+            g_query_due = true;
+        }
+        break;
+    case NET_LINK_DOWN:
+        if ((now - g_t_status) / 1000u >= NET_LINK_STATUS_MS) g_query_due = true;
+        break;
+    }
+    if (net_link_query(now)) return true;
+
+    // Keepalive, solange vom Server nichts kommt (nicht vor einer Statusabfrage); beim
+    // Neuaufbau in kürzerem Abstand
+    uint32_t const interval_ms =
+        (g_state == NET_LINK_CONNECTING || g_state == NET_LINK_DOWN) ? NET_LINK_PROBE_MS : NET_LINK_KEEPALIVE_MS;
+    if (!g_query_due && silence_ms >= interval_ms && (now - g_t_ping) / 1000u >= interval_ms) {
+        net_link_ping(now);
+        return true;
+    }
+    return false;
+}
+
+net_link_state_t net_link_state(void) {
+    return g_state;
+}
+
+bool net_link_sendable(void) {
+    return (g_state == NET_LINK_UP || g_state == NET_LINK_DEGRADED) && g_op == LINK_OP_NONE && !g_query_due;
+}
+
+void net_link_get_stats(net_link_stats_t* out) {
+    *out = g_stats;
+}
@@ -0,0 +1,113 @@
+// Zustand der Verbindung zum Server (CH9121 als TCP-Client) und Wiederherstellung
+//
+// Jeder gültige Rahmen vom Server (ACK, CMD, PONG) belegt, dass die Verbindung trägt.
+// Bleibt es NET_LINK_KEEPALIVE_MS still, geht ein PING-Rahmen hinaus, den der Server
+// sofort mit PONG beantwortet. Aus der Stille ergibt sich der Zustand:
+//
+//   CONNECTING  nach der Konfiguration oder einem Reset, bis der Server antwortet
+//   UP          Antwort innerhalb von NET_LINK_DEGRADED_MS
+//   DEGRADED    länger still; der CH9121 wird nach seiner TCP-Verbindung gefragt
+//   DOWN        NET_LINK_DEAD_MS still oder das Modul meldet keine Verbindung
+//
+// Meldet das Modul bei toter Leitung weiterhin eine Verbindung (halboffene TCP-Verbindung,
+// z.B. nach einem Neustart des Servers ohne FIN) oder antwortet es nicht, wird es über
+// RES_PIN hart zurückgesetzt und verbindet sich neu. Ohne Verbindung (Kabel, Server aus)
+// baut das Modul selbst neu auf; dann wird nur alle NET_LINK_STATUS_MS nachgefragt, bis es
+// wieder eine Verbindung meldet (-> CONNECTING), und erst nach NET_LINK_RESET_MS
+// zurückgesetzt. Aufeinanderfolgende Resets ohne Erfolg
+// verdoppeln ihren Mindestabstand bis NET_LINK_RESET_MAX_MS.
+//
+// Für die Statusabfrage wechselt der CH9121 kurz in den Konfigurationsmodus (9600 Baud);
+// UART0 ist solange freigegeben (net_uart_suspend()). Gesendet werden darf nur, wenn
+// net_link_sendable(). Alle Funktionen nur von Core 1, nach der Konfiguration des CH9121.
+
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// Stille, nach der ein PING gesendet wird (und Abstand weiterer PINGs)
+#ifndef NET_LINK_KEEPALIVE_MS
+#define NET_LINK_KEEPALIVE_MS 1000
+#endif
+
+// Abstand der PINGs in CONNECTING und DOWN (erste Antwort nach dem Neuaufbau schnell sehen)
+#ifndef NET_LINK_PROBE_MS
+#define NET_LINK_PROBE_MS 200
+#endif
+
+// Stille bis DEGRADED (Statusabfrage) und bis DOWN
+#ifndef NET_LINK_DEGRADED_MS
+#define NET_LINK_DEGRADED_MS 3000
+#endif
+#ifndef NET_LINK_DEAD_MS
+#define NET_LINK_DEAD_MS 6000
+#endif
+
+// Abstand der Statusabfragen, solange das Modul keine Verbindung meldet
+#ifndef NET_LINK_STATUS_MS
+#define NET_LINK_STATUS_MS 2000
+#endif
+
+// Ohne Verbindung so lange warten, bis das Modul trotzdem zurückgesetzt wird
+#ifndef NET_LINK_RESET_MS
+#define NET_LINK_RESET_MS 30000
+#endif
+
+// Mindestabstand zweier Resets ohne zwischenzeitliche Verbindung und seine Obergrenze
+#ifndef NET_LINK_RESET_HOLDOFF_MS
+#define NET_LINK_RESET_HOLDOFF_MS 5000
+#endif
+#ifndef NET_LINK_RESET_MAX_MS
+#define NET_LINK_RESET_MAX_MS 60000
+#endif
+
+typedef enum {
+    NET_LINK_CONNECTING = 0,
+    NET_LINK_UP,
+    NET_LINK_DEGRADED,
+    NET_LINK_DOWN,
+} net_link_state_t;
+
+// Zähler der Verbindungsüberwachung
+typedef struct {
+    net_link_state_t state;     // Aktueller Zustand
+    uint32_t pings;             // Gesendete PING-Rahmen
+    uint32_t pongs;             // Empfangene PONG-Rahmen
+    uint32_t rtt_us;            // Umlaufzeit des letzten PONG
+    uint32_t degraded;          // Wechsel nach DEGRADED
+    uint32_t downs;             // Wechsel nach DOWN
+    uint32_t status_queries;    // Statusabfragen beim CH9121
+    uint32_t status_failures;   // Davon ohne Antwort
+    uint32_t resets;            // Harte Resets über RES_PIN
+    uint32_t reconnects;        // Rückkehr nach UP nach einem Ausfall
+    uint32_t last_reconnect_ms; // Letzter Ausfall: Erkennung (DEGRADED) bis UP
+    uint32_t max_reconnect_ms;  // Längster Ausfall
+    uint32_t last_reset_ms;     // Letzter Reset bis UP
+} net_link_stats_t;
+
+// Startet die Überwachung im Zustand CONNECTING (nach net_uart_init())
+// Parameter device_id: Geräte-ID in den PING-Rahmen
+// Parameter baud: Datenbaudrate von UART0 (nach einer Statusabfrage wieder einstellen)
+void net_link_init(uint32_t device_id, uint32_t baud);
+
+// Meldet einen gültigen Rahmen vom Server
+// Parameter type: Rahmentyp (NET_FRAME_PONG liefert die Umlaufzeit)
+// Rückgabe: true, wenn die Verbindung damit nach einem Ausfall wieder steht
+// (unbestätigte Scans sofort wiederholen, siehe net_tx_restart())
+bool net_link_on_rx(uint8_t type, const uint8_t* payload, uint16_t len);
+
+// Sendet Keepalives, bewertet die Stille, fragt den CH9121 ab und setzt ihn zurück
+// (jeden Schleifendurchlauf aufrufen)
+// Rückgabe: true, wenn etwas zu tun war
+bool net_link_poll(void);
+
+// Aktueller Zustand
+net_link_state_t net_link_state(void);
+
+// true, wenn Daten gesendet werden dürfen (UP oder DEGRADED, keine Statusabfrage fällig
+// oder laufend)
+bool net_link_sendable(void);
+
+// Liefert die Zähler der Verbindungsüberwachung
+void net_link_get_stats(net_link_stats_t* out);
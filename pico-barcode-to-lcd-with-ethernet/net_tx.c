@@ -0,0 +1,209 @@
+// Zuverlässiger Sendepfad: Scans in SCANS-Rahmen, Sendefenster und Wiederholung
+// (siehe net_tx.h)
+
+#include "net_tx.h"
+#include "net_frame.h"
+#include "net_uart.h"
+#include "scan_stats.h"
+#include "pico/time.h"
+#include <string.h>
+
+#if (NET_TX_WINDOW & (NET_TX_WINDOW - 1)) != 0
+#error "NET_TX_WINDOW muss eine Zweierpotenz sein"
+#endif
+
+// Ein Scan im Fenster
+typedef struct {
+    net_scan_t scan;
+    uint32_t pos;               // net_uart_tx_head() nach der ersten Sendung
+} net_tx_entry_t;
+
+// Fensterpositionen (fortlaufend, Index = Position & (NET_TX_WINDOW - 1)):
+//   g_base .. g_next   gesendet, unbestätigt
+//   g_next .. g_head   noch zu senden
+// g_sent: Positionen davor wurden mindestens einmal gesendet
+// g_lat:  Positionen davor haben ihre Latenz (erste Sendung) eingetragen
+static net_tx_entry_t g_win[NET_TX_WINDOW];
+static uint32_t g_base, g_next, g_head, g_sent, g_lat;
+
+static uint32_t g_device_id;
+static uint16_t g_boot;
+static net_batch_t g_batch;
+
+static uint32_t g_t_pending;    // Seit wann Scans auf ihre Sendung warten
+static uint32_t g_t_timer;      // Start der laufenden RTO
+static uint32_t g_rto_us = NET_TX_RTO_US;
+static uint8_t g_dup_acks;
+
+static net_tx_stats_t g_stats;
+
+static inline net_tx_entry_t* entry(uint32_t pos) {
+    return &g_win[pos & (NET_TX_WINDOW - 1)];
+}
+
+void net_tx_init(uint32_t device_id, uint16_t boot) {
+    g_device_id = device_id;
+    g_boot = boot;
+    g_rto_us = NET_TX_RTO_US;
+}
+
+bool net_tx_full(void) {
+    return g_head - g_base >= NET_TX_WINDOW;
+}
+
+bool net_tx_push(const net_scan_t* scan) {
+    if (net_tx_full()) return false;
+
+    if (g_next == g_head) g_t_pending = time_us_32();
+    net_tx_entry_t* e = entry(g_head);
+    e->scan = *scan;
+    g_head++;
+
+    if (g_head - g_base > g_stats.window_high) g_stats.window_high = (uint16_t)(g_head - g_base);
+    return true;
+}
+
+// Latenzmessung: trägt die Zeiten aller erstmals gesendeten Live-Scans ein, deren Rahmen
+// UART0 vollständig verlassen hat
+static void net_tx_latency(void) {
+    uint32_t t_done;
+
+    while (g_lat != g_sent) {
+        net_tx_entry_t const* e = entry(g_lat);
+        if (e->scan.live) {
+            if (!net_uart_tx_done(e->pos, &t_done)) break;
+            scan_stats_record(SCAN_LAT_NET, t_done - e->scan.t_us);
+            scan_stats_record(SCAN_LAT_TOTAL, t_done - e->scan.t_first_us);
+        }
+        g_lat++;
+    }
+}
+
+// Millisekunden seit dem Start (ohne Überlauf nach 71 Minuten wie time_us_32)
+static inline uint32_t net_tx_now_ms(void) {
+    return (uint32_t)(time_us_64() / 1000u);
+}
+
+// Sendet einen Rahmen ab g_next (nur Scans desselben Starts)
+// Rückgabe: false, wenn er nicht in den TX-Ringpuffer passt (später erneut versuchen)
+static bool net_tx_send_frame(uint32_t now) {
+    uint16_t const boot = entry(g_next)->scan.boot;
+    uint32_t t_ref = 0;
+
+    net_batch_begin(&g_batch, g_device_id, boot);
+    uint32_t pos = g_next;
+    while (pos != g_head) {
+        net_scan_t const* s = &entry(pos)->scan;
+        if (s->boot != boot || !net_batch_add(&g_batch, s->seq, s->t_ms, s->scanner, s->code, s->len)) break;
+        t_ref = s->t_ms;
+        pos++;
+    }
+
+    // Bezugszeit: jetzt; für Scans früherer Starts ist die damalige Zeit unbekannt,
+    // dann zählt das Alter ab dem jüngsten Eintrag des Rahmens (als solcher markiert)
+    bool const earlier = boot != g_boot;
+    size_t const len = net_batch_finish(&g_batch, earlier ? t_ref : net_tx_now_ms(), earlier);
+    if (len > net_uart_tx_space() || !net_send(g_batch.buf, len)) return false;
+
+    // Positionen vor g_sent waren schon einmal unterwegs
+    uint32_t const resent = (g_sent - g_next < pos - g_next) ? g_sent - g_next : pos - g_next;
+    uint32_t const head = net_uart_tx_head();
+    for (; g_sent - g_next < pos - g_next; ++g_sent) entry(g_sent)->pos = head;
+
+    // Erste ausstehende Sendung startet die RTO
+    if (g_next == g_base) g_t_timer = now;
+    g_stats.frames++;
+    g_stats.records += g_batch.count;
+    g_stats.retransmits += resent;
+    g_next = pos;
+    g_t_pending = now;
+    return true;
+}
+
+bool net_tx_poll(void) {
+    uint32_t const now = time_us_32();
+    bool busy = false;
+
+    // Abgeschlossene Sendungen vor neuen auswerten
+    net_tx_latency();
+
+    // Keine Bestätigung innerhalb der RTO: ab dem ältesten unbestätigten Scan wiederholen
+    if (g_next != g_base && now - g_t_timer >= g_rto_us) {
+        g_next = g_base;
+        g_t_timer = now;
+        g_rto_us = (g_rto_us * 2 < NET_TX_RTO_MAX_US) ? g_rto_us * 2 : NET_TX_RTO_MAX_US;
+        g_dup_acks = 0;
+        g_stats.timeouts++;
+    }
+
+    // Fällige Rahmen senden: volle und Wiederholungen sofort, sonst wenn die Leitung
+    // frei ist oder der älteste wartende Scan das Sammelfenster ausgeschöpft hat
+    while (g_next != g_head) {
+        bool const now_due = g_head - g_next >= NET_FRAME_RECORDS_MAX || g_next != g_sent;
+        if (!now_due && !net_uart_tx_idle() && now - g_t_pending < NET_FRAME_WINDOW_US) break;
+        if (!net_tx_send_frame(now)) break;
+        busy = true;
+    }
+
+    g_stats.in_flight = (uint16_t)(g_next - g_base);
+    g_stats.rto_us = g_rto_us;
+    return busy;
+}
+
+void net_tx_restart(void) {
+    g_next = g_base;
+    g_t_timer = time_us_32();
+    g_rto_us = NET_TX_RTO_US;
+    g_dup_acks = 0;
+}
+
+uint32_t net_tx_on_ack(const uint8_t* payload, uint16_t len) {
+    if (len < NET_ACK_LEN) return 0;
+
+    uint32_t const device_id = (uint32_t)payload[0] | (uint32_t)payload[1] << 8 | (uint32_t)payload[2] << 16 |
+                               (uint32_t)payload[3] << 24;
+    uint16_t const boot = (uint16_t)(payload[4] | payload[5] << 8);
+    uint32_t const ack = (uint32_t)payload[6] | (uint32_t)payload[7] << 8 | (uint32_t)payload[8] << 16 |
+                         (uint32_t)payload[9] << 24;
+    if (device_id != g_device_id) return 0;
+    g_stats.acks++;
+
+    // Bestätigt die vorderen, schon einmal gesendeten Einträge dieses Starts
+    net_tx_latency();
+    uint32_t const now = time_us_32();
+    uint32_t pos = g_base, journaled = 0;
+    while (pos != g_sent) {
+        net_scan_t const* s = &entry(pos)->scan;
+        if (s->boot != boot || (int32_t)(s->seq - ack) >= 0) break;
+        if (s->live) scan_stats_record(SCAN_LAT_ACK, now - s->t_us);
+        if (s->journaled) journaled++;
+        pos++;
+    }
+
+    if (pos == g_base) {
+        // Kein Fortschritt: der Server hat eine Lücke (z.B. während eines Verbindungsabbaus
+        // verworfene Bytes) -> nach zwei solchen ACKs sofort wiederholen
+        if (g_next == g_base) return 0;
+        g_stats.dup_acks++;
+        if (++g_dup_acks == 2) {
+            g_next = g_base;
+            g_t_timer = now;
+            g_stats.fast_retransmits++;
+        }
+        return 0;
+    }
+
+    // Einträge freigeben
+    if (pos - g_base > g_lat - g_base) g_lat = pos;
+    if (pos - g_base > g_next - g_base) g_next = pos;
+    g_base = pos;
+    g_dup_acks = 0;
+    g_rto_us = NET_TX_RTO_US;
+    g_t_timer = now;
+    g_stats.in_flight = (uint16_t)(g_next - g_base);
+    return journaled;
+}
+
+void net_tx_get_stats(net_tx_stats_t* out) {
+    *out = g_stats;
+}
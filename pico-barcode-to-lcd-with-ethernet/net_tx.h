@@ -0,0 +1,97 @@
+// Zuverlässiger Sendepfad: Scans in SCANS-Rahmen, Sendefenster und Wiederholung
+//
+// Jeder Scan bleibt in einem Fenster im RAM, bis der Server ihn mit einem kumulativen
+// ACK-Rahmen (siehe net_frame.h) bestätigt hat. Das Fenster kann Scans früherer Starts
+// aus dem Journal (scan_journal.h) vor denen des laufenden Starts enthalten; ein ACK
+// bestätigt nur die vorderen Einträge seines Starts. Bleibt die Bestätigung länger als die
+// Wartezeit (RTO) aus, wird ab dem ältesten unbestätigten Scan erneut gesendet
+// (Go-Back-N, RTO verdoppelt sich bis NET_TX_RTO_MAX_US). Zwei ACKs ohne Fortschritt
+// bei ausstehenden Scans lösen die Wiederholung sofort aus. Nichts davon blockiert;
+// net_tx_poll() arbeitet nur, was gerade möglich ist. Alle Funktionen nur von Core 1.
+
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "scan_ring.h"     // SCAN_CODE_MAX
+
+// Fenstergröße: höchstens so viele unbestätigte Scans im RAM (Zweierpotenz)
+// Für Strecken mit hoher Umlaufzeit vergrößern, damit die Leitung ausgelastet bleibt
+// (Fenster >= Scanrate * Umlaufzeit).
+#ifndef NET_TX_WINDOW
+#define NET_TX_WINDOW 64
+#endif
+
+// Wartezeit auf eine Bestätigung bis zur ersten Wiederholung und ihre Obergrenze
+#ifndef NET_TX_RTO_US
+#define NET_TX_RTO_US 500000
+#endif
+#ifndef NET_TX_RTO_MAX_US
+#define NET_TX_RTO_MAX_US 8000000
+#endif
+
+// Maximale Wartezeit eines Scans im Sammelrahmen, solange UART0 noch sendet
+// Ist die Leitung frei, geht ein Rahmen sofort hinaus; während der vorherige noch
+// übertragen wird, sammeln sich weitere Scans im nächsten Rahmen (bis zu dieser Zeit
+// oder NET_FRAME_RECORDS_MAX Einträgen).
+#ifndef NET_FRAME_WINDOW_US
+#define NET_FRAME_WINDOW_US 5000
+#endif
+
+// Ein zu sendender Scan
+typedef struct {
+    uint16_t boot;              // Start, in dem der Scan entstand
+    uint32_t seq;               // Scan-Nummer innerhalb des Starts (fortlaufend)
+    uint32_t t_ms;              // Terminator in ms seit dem Start
+    uint32_t t_us;              // Terminator (time_us_32), nur für live übernommene Scans
+    uint32_t t_first_us;        // Erster Report des Scans, dito
+    bool live;                  // true: direkt aus dem Scan-Ring (Latenz messbar)
+    bool journaled;             // true: liegt im Journal (nach Bestätigung kürzen)
+    uint8_t scanner;            // USB-Geräteadresse
+    uint8_t len;                // Länge ohne Null-Terminierung
+    char code[SCAN_CODE_MAX];   // Null-terminierter Barcode
+} net_scan_t;
+
+// Zähler des Sendepfads
+typedef struct {
+    uint32_t frames;            // Gesendete SCANS-Rahmen
+    uint32_t records;           // Gesendete Einträge (inkl. Wiederholungen)
+    uint32_t retransmits;       // Davon wiederholte Einträge
+    uint32_t timeouts;          // Wiederholungen nach Ablauf der RTO
+    uint32_t fast_retransmits;  // Wiederholungen nach doppelten ACKs
+    uint32_t acks;              // Empfangene ACKs (dieses Geräts)
+    uint32_t dup_acks;          // ACKs ohne Fortschritt bei ausstehenden Scans
+    uint16_t in_flight;         // Gesendete, unbestätigte Scans
+    uint16_t window_high;       // Maximale Fensterbelegung seit Start
+    uint32_t rto_us;            // Aktuelle Wartezeit
+} net_tx_stats_t;
+
+// Initialisiert den Sendepfad (nach net_uart_init())
+// Parameter device_id: Geräte-ID in jedem Rahmen
+// Parameter boot: Startzähler des laufenden Starts (Server erkennt daran neu beginnende Nummern)
+void net_tx_init(uint32_t device_id, uint16_t boot);
+
+// true, wenn das Fenster voll ist (keine weiteren Scans annehmen)
+bool net_tx_full(void);
+
+// Übernimmt einen Scan ins Fenster (Kopie)
+// Scans eines Starts müssen in Nummernfolge ankommen.
+// Rückgabe: false, wenn das Fenster voll ist
+bool net_tx_push(const net_scan_t* scan);
+
+// Sendet fällige Rahmen, wiederholt nach Ablauf der RTO und misst die Latenz
+// (regelmäßig aufrufen, jeden Schleifendurchlauf)
+// Rückgabe: true, wenn Rahmen gesendet wurden
+bool net_tx_poll(void);
+
+// Neue Verbindung zum Server: alle unbestätigten Scans sofort erneut senden
+// (was vor dem Abbruch unterwegs war, ist verloren; RTO zurück auf NET_TX_RTO_US)
+void net_tx_restart(void);
+
+// Wertet einen empfangenen ACK-Rahmen aus (Nutzdaten ohne Rahmenkopf)
+// Rückgabe: Anzahl damit bestätigter Scans, die im Journal liegen (scan_journal_trim())
+uint32_t net_tx_on_ack(const uint8_t* payload, uint16_t len);
+
+// Liefert die Zähler des Sendepfads
+void net_tx_get_stats(net_tx_stats_t* out);
@@ -0,0 +1,200 @@
+// Interrupt-getriebener Sendepfad UART0 -> CH9121
+//
+// net_send() kopiert nur in den Ringpuffer. Solange Daten anstehen, ist der
+// TX-Interrupt aktiv und füllt den 32 Byte tiefen UART-FIFO nach, sobald dieser
+// unter die Schwelle fällt. Bei 115200 Baud blockiert ein 64-Byte-Barcode damit
+// nicht mehr ~5,5 ms lang den Aufrufer.
+//
+// Der PL011 meldet den TX-Interrupt nur beim Unterschreiten der Schwelle, nicht bei
+// bereits leerem FIFO. Deshalb füllt net_send() den FIFO selbst an und aktiviert den
+// Interrupt erst danach.
+//
+// Der RX-Interrupt ist dauerhaft aktiv und sammelt Kommandos vom Server in einem
+// eigenen Ringpuffer, den die Hauptschleife mit net_uart_read() abholt.
+
+#include "net_uart.h"
+#include "CH9121.h"
+#include "hardware/irq.h"
+#include "hardware/sync.h"
+#include "hardware/uart.h"
+#include "pico/time.h"
+#include <string.h>
+
+static uint8_t g_tx_ring[NET_TX_RING_SIZE];
+static volatile uint32_t g_tx_head = 0;   // Schreibposition (net_send)
+static volatile uint32_t g_tx_tail = 0;   // Leseposition (FIFO-Nachfüllung)
+static bool g_suspended = false;          // UART0 freigegeben (net_uart_suspend())
+static net_uart_stats_t g_stats;
+
+static uint8_t g_rx_ring[NET_RX_RING_SIZE];
+static volatile uint32_t g_rx_head = 0;   // Schreibposition (RX-Interrupt)
+static volatile uint32_t g_rx_tail = 0;   // Leseposition (net_uart_read)
+
+// Hochrechnung der Sendezeitpunkte (siehe net_uart_tx_done())
+// g_wire_end_ns:  Stoppbit des zuletzt in den FIFO geschobenen Bytes (Position g_tx_tail)
+// g_idle_pos/_ns: Position und Ende des Sendestroms vor der letzten Sendepause
+static uint32_t g_byte_ns = 86806;        // 10 Bit bei 115200 Baud
+static uint64_t g_wire_end_ns = 0;
+static uint32_t g_idle_pos = 0;
+static uint64_t g_idle_end_ns = 0;
+
+// Schiebt Bytes aus dem Ringpuffer in den UART-FIFO, solange dort Platz ist
+// und schaltet den TX-Interrupt passend ein oder aus
+static void net_uart_fill_fifo(void) {
+    uint32_t const start = g_tx_tail;
+    uint32_t tail = start;
+
+    while (tail != g_tx_head && uart_is_writable(UART_ID0)) {
+        uart_putc_raw(UART_ID0, (char)g_tx_ring[tail & (NET_TX_RING_SIZE - 1)]);
+        tail++;
+    }
+    g_tx_tail = tail;
+    // RX-Interrupt bleibt immer aktiv, TX nur solange Daten anstehen
+    uart_set_irq_enables(UART_ID0, true, tail != g_tx_head);
+
+    if (tail != start) {
+        // Die Bytes gehen direkt im Anschluss an die bereits gepufferten hinaus,
+        // bei leerer Leitung ab jetzt
+        uint64_t const now_ns = time_us_64() * 1000u;
+        if (g_wire_end_ns < now_ns) {
+            g_idle_pos = start;
+            g_idle_end_ns = g_wire_end_ns;
+            g_wire_end_ns = now_ns;
+        }
+        g_wire_end_ns += (uint64_t)(tail - start) * g_byte_ns;
+    }
+}
+
+// Übernimmt alle Bytes aus dem RX-FIFO in den Ringpuffer
+static void net_uart_drain_rx(void) {
+    while (uart_is_readable(UART_ID0)) {
+        uint8_t const c = (uint8_t)uart_getc(UART_ID0);
+        uint32_t const head = g_rx_head;
+        if (head - g_rx_tail >= NET_RX_RING_SIZE) {
+            g_stats.rx_dropped++;
+            continue;
+        }
+        g_rx_ring[head & (NET_RX_RING_SIZE - 1)] = c;
+        g_rx_head = head + 1;
+        g_stats.rx_bytes++;
+    }
+}
+
+// UART0-Interrupt: Empfangenes abholen, FIFO nachfüllen
+static void net_uart_irq_handler(void) {
+    net_uart_drain_rx();
+    net_uart_fill_fifo();
+}
+
+void net_uart_init(uint32_t baud) {
+    // UART0 für Datenverkehr mit CH9121
+    uint const actual = uart_init(UART_ID0, baud);
+    gpio_set_function(UART_TX_PIN0, GPIO_FUNC_UART);
+    gpio_set_function(UART_RX_PIN0, GPIO_FUNC_UART);
+    uart_set_fifo_enabled(UART_ID0, true);
+
+    // 8N1: Start + 8 Daten + Stopp
+    g_byte_ns = (uint32_t)(10000000000ull / actual);
+
+    irq_set_exclusive_handler(UART0_IRQ, net_uart_irq_handler);
+    irq_set_enabled(UART0_IRQ, true);
+
+    // Während einer Freigabe angesammelte Nachrichten jetzt senden
+    uint32_t const irq = save_and_disable_interrupts();
+    g_suspended = false;
+    net_uart_fill_fifo();
+    restore_interrupts(irq);
+}
+
+void net_uart_suspend(void) {
+    g_suspended = true;
+    uart_set_irq_enables(UART_ID0, false, false);
+    irq_set_enabled(UART0_IRQ, false);
+    net_uart_drain_rx();
+}
+
+bool net_send(const void* data, size_t len) {
+    uint32_t const irq = save_and_disable_interrupts();
+    uint32_t const head = g_tx_head;
+    uint32_t const used = head - g_tx_tail;
+
+    if (len > NET_TX_RING_SIZE - used) {
+        // Nachricht passt nicht mehr komplett hinein -> verwerfen
+        g_stats.dropped_bytes += len;
+        g_stats.dropped_msgs++;
+        restore_interrupts(irq);
+        return false;
+    }
+
+    // Kopiert in höchstens zwei Stücken (Umlauf am Pufferende)
+    uint32_t const pos = head & (NET_TX_RING_SIZE - 1);
+    size_t const first = (len < NET_TX_RING_SIZE - pos) ? len : NET_TX_RING_SIZE - pos;
+    memcpy(&g_tx_ring[pos], data, first);
+    memcpy(&g_tx_ring[0], (const uint8_t*)data + first, len - first);
+    g_tx_head = head + (uint32_t)len;
+
+    g_stats.tx_bytes += len;
+    if (used + len > g_stats.high_water) g_stats.high_water = (uint16_t)(used + len);
+
+    if (!g_suspended) net_uart_fill_fifo();
+    restore_interrupts(irq);
+    return true;
+}
+
+bool net_send_line(const char* line) {
+    return net_send(line, strlen(line));
+}
+
+size_t net_uart_tx_space(void) {
+    return NET_TX_RING_SIZE - (size_t)(g_tx_head - g_tx_tail);
+}
+
+bool net_uart_tx_idle(void) {
+    return g_tx_head == g_tx_tail && !(uart_get_hw(UART_ID0)->fr & UART_UARTFR_BUSY_BITS);
+}
+
+uint32_t net_uart_tx_head(void) {
+    return g_tx_head;
+}
+
+bool net_uart_tx_done(uint32_t pos, uint32_t* t_done_us) {
+    uint32_t const irq = save_and_disable_interrupts();
+    uint32_t const tail = g_tx_tail;
+    uint64_t t_ns;
+
+    if ((int32_t)(pos - tail) > 0) {
+        // Noch nicht alle Bytes im FIFO
+        restore_interrupts(irq);
+        return false;
+    }
+    if ((int32_t)(pos - g_idle_pos) <= 0) {
+        // Vor der letzten Sendepause abgeschlossen
+        t_ns = g_idle_end_ns - (uint64_t)(g_idle_pos - pos) * g_byte_ns;
+    } else {
+        t_ns = g_wire_end_ns - (uint64_t)(tail - pos) * g_byte_ns;
+    }
+    restore_interrupts(irq);
+
+    if (t_ns > time_us_64() * 1000u) return false;
+    *t_done_us = (uint32_t)(t_ns / 1000u);
+    return true;
+}
+
+size_t net_uart_read(uint8_t* buf, size_t cap) {
+    uint32_t tail = g_rx_tail;
+    size_t n = 0;
+
+    while (n < cap && tail != g_rx_head) {
+        buf[n++] = g_rx_ring[tail & (NET_RX_RING_SIZE - 1)];
+        tail++;
+    }
+    g_rx_tail = tail;
+    return n;
+}
+
+void net_uart_get_stats(net_uart_stats_t* out) {
+    uint32_t const irq = save_and_disable_interrupts();
+    *out = g_stats;
+    out->occupancy = (uint16_t)(g_tx_head - g_tx_tail);
+    restore_interrupts(irq);
+}
@@ -0,0 +1,75 @@
+// Nicht-blockierender Sendepfad UART0 -> CH9121
+// Gesendete Daten landen in einem Ringpuffer, den der UART-TX-Interrupt in den
+// Hardware-FIFO nachfüllt. Empfangene Daten (Kommandos vom Server) sammelt der
+// RX-Interrupt in einem zweiten Ringpuffer. Alle Funktionen nur von Core 1 aufrufen.
+
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+// Größe des TX-Ringpuffers in Bytes (Zweierpotenz)
+#ifndef NET_TX_RING_SIZE
+#define NET_TX_RING_SIZE 1024
+#endif
+
+// Größe des RX-Ringpuffers in Bytes (Zweierpotenz), füllt der UART-RX-Interrupt
+#ifndef NET_RX_RING_SIZE
+#define NET_RX_RING_SIZE 256
+#endif
+
+// Zähler des Sendepfads
+typedef struct {
+    uint32_t tx_bytes;          // In den Ringpuffer übernommene Bytes
+    uint32_t dropped_bytes;     // Verworfene Bytes (Ringpuffer voll)
+    uint32_t dropped_msgs;      // Verworfene Nachrichten
+    uint16_t occupancy;         // Aktuelle Belegung des Ringpuffers
+    uint16_t high_water;        // Maximale Belegung seit Start
+    uint32_t rx_bytes;          // Empfangene Bytes (vom Server über den CH9121)
+    uint32_t rx_dropped;        // Verworfene Empfangsbytes (RX-Ringpuffer voll)
+} net_uart_stats_t;
+
+// Initialisiert UART0 mit der Datenbaudrate und den TX-Interrupt (auf dem aufrufenden Core)
+void net_uart_init(uint32_t baud);
+
+// Gibt UART0 vorübergehend frei (z.B. für eine Statusabfrage des CH9121 im
+// Konfigurationsmodus): sperrt den UART-Interrupt, der RX-Ringpuffer bleibt erhalten.
+// Nur aufrufen, wenn net_uart_tx_idle(); net_uart_init() übernimmt UART0 wieder.
+// Solange bleiben mit net_send() übergebene Nachrichten im Ringpuffer.
+void net_uart_suspend(void);
+
+// Übernimmt eine Nachricht vollständig in den Ringpuffer und kehrt sofort zurück
+// Passt sie nicht mehr hinein, wird sie komplett verworfen (keine halben Barcodes).
+// Rückgabe: true, wenn die Nachricht übernommen wurde
+bool net_send(const void* data, size_t len);
+
+// Komfort: sendet einen null-terminierten String
+bool net_send_line(const char* line);
+
+// Freier Platz im Ringpuffer in Bytes (eine so lange Nachricht nimmt net_send() an)
+size_t net_uart_tx_space(void);
+
+// true, wenn Ringpuffer und UART-FIFO leer sind und das letzte Bit gesendet wurde
+bool net_uart_tx_idle(void);
+
+// Fortlaufende Byteposition hinter der zuletzt übernommenen Nachricht
+// Zusammen mit net_uart_tx_done() lässt sich messen, wann eine Nachricht draußen ist.
+uint32_t net_uart_tx_head(void);
+
+// Prüft, ob alle Bytes vor Position pos die Leitung verlassen haben
+// Parameter pos: Rückgabewert von net_uart_tx_head() direkt nach net_send()
+// Parameter t_done_us: Zeitpunkt (time_us_32) des Stoppbits des letzten Bytes
+// Rückgabe: false, solange noch Bytes davor unterwegs sind
+// 
+// Der PL011 hat kein Füllstandsregister; der Zeitpunkt wird aus der Baudrate und dem
+// Nachfüllzeitpunkt jedes Bytes hochgerechnet. Regelmäßig (jeden Schleifendurchlauf)
+// abfragen, damit Sendepausen zwischen zwei Nachrichten korrekt berücksichtigt werden.
+bool net_uart_tx_done(uint32_t pos, uint32_t* t_done_us);
+
+// Liest empfangene Bytes aus dem RX-Ringpuffer
+// Rückgabe: Anzahl gelesener Bytes (0 = nichts empfangen)
+size_t net_uart_read(uint8_t* buf, size_t cap);
+
+// Liefert die Zähler des Sendepfads
+void net_uart_get_stats(net_uart_stats_t* out);
@@ -0,0 +1,143 @@
+// Prüfzeichen-Kontrolle fertiger Scans (siehe scan_check.h)
+//
+// Die Regeln stehen in einer Tabelle, nach Länge sortiert; ein Scan durchläuft nur die
+// Einträge seiner Länge. Die Prüfung selbst ist eine Summe über die Ziffern, also ein paar
+// Dutzend Takte pro Scan.
+
+#include "scan_check.h"
+#include <string.h>
+
+// Regel für reine Ziffernfolgen fester Länge
+typedef struct {
+    uint8_t len;
+    uint8_t sym;                                    // scan_sym_t
+    char first_max;                                 // Höchste zulässige erste Ziffer
+    bool (*valid)(const char* code, uint8_t len);   // Prüfzeichen stimmt
+} scan_check_rule_t;
+
+static volatile uint8_t g_action[SCAN_SYM_COUNT] = {
+    [SCAN_SYM_EAN8]    = SCAN_CHECK_EAN8_ACTION,
+    [SCAN_SYM_EAN13]   = SCAN_CHECK_EAN13_ACTION,
+    [SCAN_SYM_UPCA]    = SCAN_CHECK_UPCA_ACTION,
+    [SCAN_SYM_UPCE]    = SCAN_CHECK_UPCE_ACTION,
+    [SCAN_SYM_ITF14]   = SCAN_CHECK_ITF14_ACTION,
+    [SCAN_SYM_CODE128] = SCAN_CHECK_CODE128_ACTION,
+};
+static scan_check_stats_t g_stats;
+
+static const char* const scan_sym_names[SCAN_SYM_COUNT] = { "EAN8", "EAN13", "UPCA", "UPCE", "ITF14", "C128" };
+
+// Modulo 10 mit Gewichten 3/1 von rechts (GTIN: EAN-8/13, UPC-A, ITF-14)
+static bool scan_check_gtin(const char* code, uint8_t len) {
+    unsigned sum = 0;
+    for (uint8_t i = 0; i + 1 < len; ++i) {
+        unsigned const d = (unsigned)(code[i] - '0');
+        sum += ((len - i) & 1u) ? d : 3u * d;
+    }
+    return (sum + (unsigned)(code[len - 1] - '0')) % 10u == 0;
+}
+
+// UPC-E: auf UPC-A erweitern (Nummernsystem, 6 Ziffern, Prüfziffer), dann wie GTIN prüfen
+static bool scan_check_upce(const char* code, uint8_t len) {
+    (void)len;
+    char a[12];
+    char const* d = &code[1];
+    a[0] = code[0];
+    switch (d[5]) {
+    case '0': case '1': case '2':
+        memcpy(&a[1], d, 2); a[3] = d[5]; memset(&a[4], '0', 4); memcpy(&a[8], &d[2], 3);
+        break;
+    case '3':
+        memcpy(&a[1], d, 3); memset(&a[4], '0', 5); memcpy(&a[9], &d[3], 2);
+        break;
+    case '4':
+        memcpy(&a[1], d, 4); memset(&a[5], '0', 5); a[10] = d[4];
+        break;
+    default:
+        memcpy(&a[1], d, 5); memset(&a[6], '0', 4); a[10] = d[5];
+        break;
+    }
+    a[11] = code[7];
+    return scan_check_gtin(a, sizeof(a));
+}
+
+// Code 128, Zeichensatz B: Startwert 104, Symbolwert = ASCII - 32, gewichtet mit der Position
+static bool scan_check_code128(const char* code, uint8_t len) {
+    unsigned sum = 104;
+    for (uint8_t i = 0; i + 1 < len; ++i) sum += (unsigned)(i + 1) * (unsigned)((uint8_t)code[i] - 32u);
+    return sum % 103u == (unsigned)((uint8_t)code[len - 1] - 32u);
+}
+
+// Regeln für Ziffernfolgen, nach Länge sortiert
+static const scan_check_rule_t scan_check_rules[] = {
+    { 8,  SCAN_SYM_EAN8,  '9', scan_check_gtin },
+    { 8,  SCAN_SYM_UPCE,  '1', scan_check_upce },     // Nummernsystem 0 oder 1
+    { 12, SCAN_SYM_UPCA,  '9', scan_check_gtin },
+    { 13, SCAN_SYM_EAN13, '9', scan_check_gtin },
+    { 14, SCAN_SYM_ITF14, '9', scan_check_gtin },
+};
+#define SCAN_CHECK_RULES (sizeof(scan_check_rules) / sizeof(scan_check_rules[0]))
+
+// Zählt das Ergebnis der Regel, die über den Scan entschieden hat
+// Rückgabe: Einstellung der Symbologie, wenn das Prüfzeichen falsch ist, sonst SCAN_CHECK_OFF
+static scan_check_action_t scan_check_count(scan_sym_t sym, bool valid) {
+    g_stats.checked[sym]++;
+    if (valid) return SCAN_CHECK_OFF;
+    g_stats.invalid[sym]++;
+    return (scan_check_action_t)g_action[sym];
+}
+
+scan_check_action_t scan_check_code(const char* code, uint8_t len) {
+    bool digits = true;
+    for (uint8_t i = 0; i < len && digits; ++i) digits = code[i] >= '0' && code[i] <= '9';
+
+    // Alle aktiven Regeln gleicher Länge prüfen, aber nur die entscheidende zählen: die erste,
+    // die passt, sonst die mit der mildesten Einstellung
+    int decided = -1;
+    bool valid = false;
+    for (size_t i = 0; digits && i < SCAN_CHECK_RULES && scan_check_rules[i].len <= len; ++i) {
+        scan_check_rule_t const* r = &scan_check_rules[i];
+        if (r->len != len || code[0] > r->first_max || g_action[r->sym] == SCAN_CHECK_OFF) continue;
+        if (r->valid(code, len)) {
+            decided = (int)i;
+            valid = true;
+            break;
+        }
+        if (decided < 0 || g_action[r->sym] < g_action[scan_check_rules[decided].sym]) decided = (int)i;
+    }
+    scan_check_action_t result;
+    if (decided >= 0) {
+        result = scan_check_count((scan_sym_t)scan_check_rules[decided].sym, valid);
+    } else {
+        bool printable = len >= 2 && g_action[SCAN_SYM_CODE128] != SCAN_CHECK_OFF;
+        for (uint8_t i = 0; i < len && printable; ++i) printable = code[i] >= 32 && code[i] <= 126;
+        if (!printable) {
+            g_stats.unchecked++;
+            return SCAN_CHECK_OFF;
+        }
+        result = scan_check_count(SCAN_SYM_CODE128, scan_check_code128(code, len));
+    }
+    if (result == SCAN_CHECK_FLAG) g_stats.flagged++;
+    if (result == SCAN_CHECK_DROP) g_stats.dropped++;
+    return result;
+}
+
+void scan_check_set_action(scan_sym_t sym, scan_check_action_t action) {
+    if (sym < SCAN_SYM_COUNT) g_action[sym] = (uint8_t)action;
+}
+
+const char* scan_check_name(scan_sym_t sym) {
+    return sym < SCAN_SYM_COUNT ? scan_sym_names[sym] : "?";
+}
+
+scan_sym_t scan_check_find(const char* name, size_t len) {
+    for (unsigned i = 0; i < SCAN_SYM_COUNT; ++i) {
+        if (strlen(scan_sym_names[i]) == len && memcmp(scan_sym_names[i], name, len) == 0) return (scan_sym_t)i;
+    }
+    return SCAN_SYM_COUNT;
+}
+
+void scan_check_get_stats(scan_check_stats_t* out) {
+    *out = g_stats;
+    for (unsigned i = 0; i < SCAN_SYM_COUNT; ++i) out->action[i] = g_action[i];
+}
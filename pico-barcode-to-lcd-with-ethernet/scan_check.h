@@ -0,0 +1,94 @@
+// Prüfzeichen-Kontrolle fertiger Scans (EAN-8/13, UPC-A/E, ITF-14, Code 128)
+//
+// Fehllesungen (abgeschnittene EAN-13, falsche UPC-Prüfziffer) sollen nicht erst in der
+// Datenbank bereinigt werden. Jeder Scan wird direkt nach dem Terminator gegen eine Tabelle
+// von Regeln geprüft, bevor er LCD, UART oder Journal belastet.
+//
+// Scanner im Tastaturmodus senden keine Symbologie-Kennung; die Symbologie ergibt sich aus
+// Länge und Zeichenvorrat:
+//   8 Ziffern   EAN-8, mit führender 0/1 auch UPC-E (gültig, wenn eine der beiden passt)
+//   12 Ziffern  UPC-A
+//   13 Ziffern  EAN-13
+//   14 Ziffern  ITF-14 (GTIN-14)
+//   sonst       Code 128, sofern aktiviert: das letzte Zeichen ist das Prüfzeichen (Modulo 103,
+//               Zeichensatz B). Scanner übertragen es nur, wenn das eigens eingestellt ist.
+// Codes, auf die keine aktive Regel passt, gelten als gültig. Passen mehrere Regeln, zählt nur
+// die entscheidende: die gültige, sonst die mit der mildesten Einstellung.
+//
+// Pro Symbologie wird festgelegt, was mit ungültigen Scans geschieht: nicht prüfen,
+// markieren (Scan geht weiter, LCD zeigt ihn als fragwürdig) oder verwerfen.
+// scan_check_code() nur von Core 0 (HID), die übrigen Funktionen von beiden Cores.
+
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+typedef enum {
+    SCAN_SYM_EAN8 = 0,
+    SCAN_SYM_EAN13,
+    SCAN_SYM_UPCA,
+    SCAN_SYM_UPCE,
+    SCAN_SYM_ITF14,
+    SCAN_SYM_CODE128,
+    SCAN_SYM_COUNT
+} scan_sym_t;
+
+// Umgang mit ungültigen Scans einer Symbologie
+typedef enum {
+    SCAN_CHECK_OFF = 0,     // Nicht prüfen
+    SCAN_CHECK_FLAG,        // Weitergeben, aber markieren (SCAN_FLAG_CHECK)
+    SCAN_CHECK_DROP,        // Verwerfen
+} scan_check_action_t;
+
+// Voreinstellungen pro Symbologie: markieren, nicht verwerfen. Die Symbologie ist nur aus der
+// Länge geraten; interne Artikel- oder Chargennummern gleicher Länge (Code 128, Code 39) wären
+// sonst zu 90 % verloren. Verwerfen per -DSCAN_CHECK_<SYM>_ACTION=SCAN_CHECK_DROP oder
+// Kommando "CHECK <Symbologie> DROP".
+#ifndef SCAN_CHECK_EAN8_ACTION
+#define SCAN_CHECK_EAN8_ACTION SCAN_CHECK_FLAG
+#endif
+#ifndef SCAN_CHECK_EAN13_ACTION
+#define SCAN_CHECK_EAN13_ACTION SCAN_CHECK_FLAG
+#endif
+#ifndef SCAN_CHECK_UPCA_ACTION
+#define SCAN_CHECK_UPCA_ACTION SCAN_CHECK_FLAG
+#endif
+#ifndef SCAN_CHECK_UPCE_ACTION
+#define SCAN_CHECK_UPCE_ACTION SCAN_CHECK_FLAG
+#endif
+#ifndef SCAN_CHECK_ITF14_ACTION
+#define SCAN_CHECK_ITF14_ACTION SCAN_CHECK_FLAG
+#endif
+#ifndef SCAN_CHECK_CODE128_ACTION
+#define SCAN_CHECK_CODE128_ACTION SCAN_CHECK_OFF
+#endif
+
+// Zähler der Prüfung
+typedef struct {
+    uint8_t action[SCAN_SYM_COUNT];     // Aktuelle Einstellung (scan_check_action_t)
+    uint32_t checked[SCAN_SYM_COUNT];   // Geprüfte Scans
+    uint32_t invalid[SCAN_SYM_COUNT];   // Davon mit falschem Prüfzeichen
+    uint32_t unchecked;                 // Scans ohne passende aktive Regel
+    uint32_t flagged;                   // Markiert weitergegeben
+    uint32_t dropped;                   // Verworfen
+} scan_check_stats_t;
+
+// Prüft einen fertigen Scan
+// Rückgabe: SCAN_CHECK_OFF, wenn er gültig ist oder nicht geprüft wurde, sonst die
+// Einstellung der Symbologie (SCAN_CHECK_FLAG oder SCAN_CHECK_DROP)
+scan_check_action_t scan_check_code(const char* code, uint8_t len);
+
+// Setzt den Umgang mit ungültigen Scans einer Symbologie; gilt ab dem nächsten Scan
+void scan_check_set_action(scan_sym_t sym, scan_check_action_t action);
+
+// Kurzname einer Symbologie (EAN8, EAN13, UPCA, UPCE, ITF14, C128)
+const char* scan_check_name(scan_sym_t sym);
+
+// Sucht eine Symbologie über ihren Kurznamen
+// Rückgabe: SCAN_SYM_COUNT, wenn der Name unbekannt ist
+scan_sym_t scan_check_find(const char* name, size_t len);
+
+// Liefert die Zähler
+void scan_check_get_stats(scan_check_stats_t* out);
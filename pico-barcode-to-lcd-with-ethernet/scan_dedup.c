@@ -0,0 +1,80 @@
+// Unterdrückung doppelter Lesungen (siehe scan_dedup.h)
+
+#include "scan_dedup.h"
+#include "pico/time.h"
+#include <stddef.h>
+
+// Ein Platz der Tabelle; hash 0 = nie belegt
+typedef struct {
+    uint32_t hash;
+    uint64_t t_us;              // Letzte angenommene Lesung (time_us_64, läuft nicht über)
+} scan_dedup_slot_t;
+
+static scan_dedup_slot_t g_slots[SCAN_DEDUP_SLOTS];
+static volatile uint32_t g_window_ms = SCAN_DEDUP_MS;
+static scan_dedup_stats_t g_stats;
+
+// FNV-1a über Scanner und Code; 0 ist für freie Plätze reserviert
+static uint32_t scan_dedup_hash(const char* code, uint8_t len, uint8_t dev_addr) {
+    uint32_t h = 2166136261u;
+    h = (h ^ dev_addr) * 16777619u;
+    for (uint8_t i = 0; i < len; ++i) h = (h ^ (uint8_t)code[i]) * 16777619u;
+    return h ? h : 1u;
+}
+
+bool scan_dedup_check(const char* code, uint8_t len, uint8_t dev_addr) {
+    uint32_t const window_ms = g_window_ms;
+    if (window_ms == 0) return false;
+
+    uint64_t const now = time_us_64();
+    uint64_t const window_us = (uint64_t)window_ms * 1000u;
+    uint32_t const hash = scan_dedup_hash(code, len, dev_addr);
+
+    g_stats.checked++;
+    for (uint32_t i = 0; i < SCAN_DEDUP_PROBES; ++i) {
+        scan_dedup_slot_t const* s = &g_slots[(hash + i) & (SCAN_DEDUP_SLOTS - 1)];
+        if (s->hash == hash && now - s->t_us < window_us) {
+            g_stats.suppressed++;
+            return true;
+        }
+    }
+    return false;
+}
+
+void scan_dedup_record(const char* code, uint8_t len, uint8_t dev_addr) {
+    uint32_t const window_ms = g_window_ms;
+    if (window_ms == 0) return;
+
+    uint64_t const now = time_us_64();
+    uint64_t const window_us = (uint64_t)window_ms * 1000u;
+    uint32_t const hash = scan_dedup_hash(code, len, dev_addr);
+    scan_dedup_slot_t* victim = NULL;       // Erster freier oder abgelaufener Platz
+    scan_dedup_slot_t* oldest = NULL;       // Ältester noch gültiger Platz
+
+    for (uint32_t i = 0; i < SCAN_DEDUP_PROBES; ++i) {
+        scan_dedup_slot_t* s = &g_slots[(hash + i) & (SCAN_DEDUP_SLOTS - 1)];
+        bool const live = s->hash != 0 && now - s->t_us < window_us;
+        if (!live) {
+            if (!victim) victim = s;
+        } else if (!oldest || s->t_us < oldest->t_us) {
+            oldest = s;
+        }
+    }
+
+    // Im ersten freien Platz merken, notfalls den ältesten verdrängen
+    if (!victim) {
+        victim = oldest;
+        g_stats.evicted++;
+    }
+    victim->hash = hash;
+    victim->t_us = now;
+}
+
+void scan_dedup_set_window(uint32_t ms) {
+    g_window_ms = ms;
+}
+
+void scan_dedup_get_stats(scan_dedup_stats_t* out) {
+    *out = g_stats;
+    out->window_ms = g_window_ms;
+}
@@ -0,0 +1,63 @@
+// Unterdrückung doppelter Lesungen: gleicher Code vom gleichen Scanner innerhalb eines Fensters
+//
+// Handscanner lesen dasselbe Etikett oft zweimal innerhalb weniger hundert Millisekunden.
+// Jede Doppellesung kostet sonst ein LCD-Update, UART-Bytes und eine Datenbankzeile.
+// Jeder weitergegebene (im Scan-Ring veröffentlichte) Scan legt einen 32-Bit-Hash (FNV-1a
+// über Scanner und Code) mit seinem Zeitstempel in einer kleinen Hashtabelle mit offener
+// Adressierung ab. Ein Scan, dessen Hash dort jünger als das Fenster ist, gilt als
+// Doppellesung. Das Fenster zählt ab der
+// letzten angenommenen Lesung; Doppellesungen verlängern es nicht (zwei gleiche Artikel
+// hintereinander gehen also durch, sobald das Fenster abgelaufen ist).
+//
+// Abgelaufene Einträge werden nicht gelöscht, sondern beim Einfügen überschrieben. Gesucht
+// wird ab der Heimatposition über höchstens SCAN_DEDUP_PROBES Plätze; ist keiner davon frei
+// oder abgelaufen, wird der älteste ersetzt. Die Prüfung kostet damit unabhängig von der
+// Belegung höchstens SCAN_DEDUP_PROBES Vergleiche.
+// scan_dedup_check() und scan_dedup_record() nur von Core 0 (HID), die übrigen Funktionen
+// von beiden Cores.
+
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// Standardfenster in ms (0 = keine Unterdrückung)
+#ifndef SCAN_DEDUP_MS
+#define SCAN_DEDUP_MS 500
+#endif
+
+// Größtes per Kommando einstellbares Fenster in ms
+#ifndef SCAN_DEDUP_MAX_MS
+#define SCAN_DEDUP_MAX_MS 60000
+#endif
+
+// Plätze der Hashtabelle (Zweierpotenz) und Länge der Suche
+#ifndef SCAN_DEDUP_SLOTS
+#define SCAN_DEDUP_SLOTS 64
+#endif
+#ifndef SCAN_DEDUP_PROBES
+#define SCAN_DEDUP_PROBES 8
+#endif
+
+// Zähler der Unterdrückung
+typedef struct {
+    uint32_t window_ms;         // Aktuelles Fenster
+    uint32_t checked;           // Geprüfte Scans
+    uint32_t suppressed;        // Davon als Doppellesung verworfen
+    uint32_t evicted;           // Ersetzte, noch nicht abgelaufene Einträge (Tabelle zu klein)
+} scan_dedup_stats_t;
+
+// Prüft einen fertigen Scan (ändert die Tabelle nicht)
+// Parameter dev_addr: USB-Geräteadresse des Scanners
+// Rückgabe: true, wenn es eine Doppellesung ist (Scan verwerfen)
+bool scan_dedup_check(const char* code, uint8_t len, uint8_t dev_addr);
+
+// Merkt sich einen angenommenen Scan; erst aufrufen, wenn er tatsächlich weitergegeben wurde
+// (ein verworfener Scan, z.B. bei vollem Scan-Ring, darf eine erneute Lesung nicht unterdrücken)
+void scan_dedup_record(const char* code, uint8_t len, uint8_t dev_addr);
+
+// Setzt das Fenster (0 = aus); gilt ab dem nächsten Scan
+void scan_dedup_set_window(uint32_t ms);
+
+// Liefert die Zähler
+void scan_dedup_get_stats(scan_dedup_stats_t* out);
@@ -0,0 +1,426 @@
+// Offline-Journal für Scans im On-Board-Flash (siehe scan_journal.h)
+//
+// Positionen im Log sind absolute Seitennummern; die Seite liegt bei (Nummer % Seitenzahl)
+// im reservierten Bereich. Damit ergibt sich die Lage jeder Seite aus ihrer Nummer, und
+// Seiten aus einer früheren Runde des Rings erkennt man an der abweichenden Nummer im Kopf.
+//   g_tail          ältester unbestätigter Scan
+//   g_read          nächster an das Sendefenster zu liefernder Scan
+//   g_head          Seite im RAM (g_page), wird als nächste programmiert
+//   g_erased        Seiten g_head .. g_erased sind gelöscht
+
+#include "scan_journal.h"
+#include "net_frame.h"
+#include "hardware/flash.h"
+#include "pico/flash.h"
+#include "pico/rand.h"
+#include "pico/time.h"
+#include <string.h>
+
+#if (SCAN_JOURNAL_SIZE % FLASH_SECTOR_SIZE) != 0 || SCAN_JOURNAL_SIZE >= PICO_FLASH_SIZE_BYTES
+#error "SCAN_JOURNAL_SIZE muss ein Vielfaches von FLASH_SECTOR_SIZE und kleiner als der Flash sein"
+#endif
+
+#define JOURNAL_OFFSET (PICO_FLASH_SIZE_BYTES - SCAN_JOURNAL_SIZE)
+#define JOURNAL_PAGES (SCAN_JOURNAL_SIZE / FLASH_PAGE_SIZE)
+#define SEGMENT_PAGES (FLASH_SECTOR_SIZE / FLASH_PAGE_SIZE)
+
+#define PAGE_MAGIC 0x4A53u          // "SJ"
+#define PAGE_HEAD 16
+#define PAGE_SCANS 0
+#define PAGE_CHECKPOINT 1
+
+// Eintrag ohne Code: len | t_ms | scanner | crc8
+#define RECORD_OVERHEAD 7
+
+// Wartezeit auf den anderen Core bei Flash-Operationen
+#define JOURNAL_LOCKOUT_MS 100
+
+// Leseposition im Log
+typedef struct {
+    uint32_t page;              // Absolute Seitennummer
+    uint16_t off;               // Byte in der Seite (0 = Kopf noch nicht geprüft)
+    uint8_t rec;                // Davor liegende Einträge der Seite
+} journal_pos_t;
+
+static journal_pos_t g_tail, g_read;
+static journal_pos_t g_cp;                  // Im letzten Checkpoint vermerkter g_tail
+static uint32_t g_head, g_erased;
+static uint16_t g_boot;
+
+// Seite im RAM (Kopf + Einträge, Rest 0xFF)
+static struct {
+    uint8_t data[FLASH_PAGE_SIZE];
+    uint16_t used;              // Belegte Bytes (0 = keine Seite offen)
+    uint16_t programmed;        // Davon bereits im Flash
+    uint16_t boot;
+    uint32_t first_seq;
+    uint8_t count;
+    uint32_t t_dirty_ms;        // Erster noch nicht programmierter Eintrag
+} g_page;
+
+static bool g_full;                         // Letzter Eintrag wurde abgewiesen
+static scan_journal_stats_t g_stats;
+
+static inline void put_u16(uint8_t* p, uint16_t v) {
+    p[0] = (uint8_t)v;
+    p[1] = (uint8_t)(v >> 8);
+}
+
+static inline void put_u32(uint8_t* p, uint32_t v) {
+    p[0] = (uint8_t)v;
+    p[1] = (uint8_t)(v >> 8);
+    p[2] = (uint8_t)(v >> 16);
+    p[3] = (uint8_t)(v >> 24);
+}
+
+static inline uint16_t get_u16(const uint8_t* p) {
+    return (uint16_t)(p[0] | p[1] << 8);
+}
+
+static inline uint32_t get_u32(const uint8_t* p) {
+    return (uint32_t)p[0] | (uint32_t)p[1] << 8 | (uint32_t)p[2] << 16 | (uint32_t)p[3] << 24;
+}
+
+static inline uint32_t journal_now_ms(void) {
+    return (uint32_t)(time_us_64() / 1000u);
+}
+
+// CRC-8 (Polynom 0x07) eines Eintrags
+static uint8_t journal_crc8(const uint8_t* data, size_t len) {
+    uint8_t crc = 0;
+    while (len--) {
+        crc ^= *data++;
+        for (int i = 0; i < 8; ++i) crc = (crc & 0x80) ? (uint8_t)((crc << 1) ^ 0x07) : (uint8_t)(crc << 1);
+    }
+    return crc;
+}
+
+// Adresse einer Seite im Flash (über XIP lesbar)
+static inline const uint8_t* flash_page(uint32_t page) {
+    return (const uint8_t*)(XIP_BASE + JOURNAL_OFFSET + (page % JOURNAL_PAGES) * FLASH_PAGE_SIZE);
+}
+
+// Inhalt einer Seite: die offene Seite aus dem RAM, alle anderen aus dem Flash
+static inline const uint8_t* page_data(uint32_t page) {
+    return (page == g_head) ? g_page.data : flash_page(page);
+}
+
+// Prüft den Kopf einer Seite
+// Rückgabe: kind der Seite oder -1 (leer, defekt oder aus einer früheren Runde)
+static int page_kind(const uint8_t* p, uint32_t page) {
+    if (get_u16(&p[0]) != PAGE_MAGIC || get_u16(&p[14]) != net_frame_crc16(0xFFFF, p, 14)) return -1;
+    if (get_u32(&p[4]) != page) return -1;
+    return p[12];
+}
+
+// Länge eines Eintrags ab p (höchstens avail Bytes) und optional sein Inhalt
+// Rückgabe: 0 am Seitenende oder bei defektem Eintrag
+static size_t record_parse(const uint8_t* p, size_t avail, net_scan_t* out) {
+    if (avail < RECORD_OVERHEAD || p[0] == 0xFF) return 0;
+    uint8_t const n = p[0] & 0x7F;
+    size_t const code = (p[0] & 0x80) ? (n + 1u) / 2u : n;
+    size_t const size = RECORD_OVERHEAD + code;
+    if (n >= SCAN_CODE_MAX || size > avail || journal_crc8(p, size - 1) != p[size - 1]) return 0;
+
+    if (out) {
+        net_code_unpack(out->code, sizeof(out->code), p, &out->len);
+        out->t_ms = get_u32(&p[1 + code]);
+        out->scanner = p[5 + code];
+    }
+    return size;
+}
+
+// Liefert den Eintrag an pos und rückt pos dahinter (überspringt leere und fremde Seiten)
+// Rückgabe: false, wenn pos die offene Seite im RAM erreicht hat und dort nichts mehr liegt
+static bool journal_next(journal_pos_t* pos, net_scan_t* out) {
+    for (;;) {
+        if (pos->page == g_head && g_page.used == 0) return false;
+        const uint8_t* const p = page_data(pos->page);
+
+        if (pos->off == 0) {
+            if (pos->page != g_head && page_kind(p, pos->page) != PAGE_SCANS) {
+                pos->page++;
+                continue;
+            }
+            pos->off = PAGE_HEAD;
+        }
+
+        size_t const size = record_parse(&p[pos->off], FLASH_PAGE_SIZE - pos->off, out);
+        if (size) {
+            if (out) {
+                out->boot = get_u16(&p[2]);
+                out->seq = get_u32(&p[8]) + pos->rec;
+            }
+            pos->off = (uint16_t)(pos->off + size);
+            pos->rec++;
+            return true;
+        }
+        if (pos->page == g_head) return false;
+
+        // Seitenende (oder ein bei Stromausfall abgebrochener Eintrag)
+        if (pos->off < FLASH_PAGE_SIZE && p[pos->off] != 0xFF) g_stats.flash_errors++;
+        pos->page++;
+        pos->off = 0;
+        pos->rec = 0;
+    }
+}
+
+// Flash-Operationen laufen mit angehaltenem anderen Core (flash_safe_execute)
+typedef struct {
+    uint32_t offset;
+    const uint8_t* data;
+} journal_flash_op_t;
+
+static void journal_do_erase(void* param) {
+    journal_flash_op_t const* op = param;
+    flash_range_erase(op->offset, FLASH_SECTOR_SIZE);
+}
+
+static void journal_do_program(void* param) {
+    journal_flash_op_t const* op = param;
+    flash_range_program(op->offset, op->data, FLASH_PAGE_SIZE);
+}
+
+static bool journal_flash(void (*fn)(void*), uint32_t page, const uint8_t* data) {
+    journal_flash_op_t op = { JOURNAL_OFFSET + (page % JOURNAL_PAGES) * FLASH_PAGE_SIZE, data };
+    if (flash_safe_execute(fn, &op, JOURNAL_LOCKOUT_MS) != PICO_OK) {
+        g_stats.flash_errors++;
+        return false;
+    }
+    return true;
+}
+
+// true, wenn eine Flash-Seite vollständig gelöscht ist
+static bool page_blank(uint32_t page) {
+    const uint8_t* p = flash_page(page);
+    for (size_t i = 0; i < FLASH_PAGE_SIZE; ++i) {
+        if (p[i] != 0xFF) return false;
+    }
+    return true;
+}
+
+// true, wenn alle Seiten eines Segments gelöscht sind
+static bool segment_blank(uint32_t page) {
+    for (uint32_t i = 0; i < SEGMENT_PAGES; ++i) {
+        if (!page_blank(page + i)) return false;
+    }
+    return true;
+}
+
+// true, wenn Seite page beschrieben werden darf (ihr Segment enthält keine unbestätigten Scans)
+static inline bool page_writable(uint32_t page) {
+    return page < (g_tail.page / SEGMENT_PAGES) * SEGMENT_PAGES + JOURNAL_PAGES;
+}
+
+// Löscht das Segment ab g_erased
+static bool journal_erase_next(void) {
+    if (!page_writable(g_erased) || !journal_flash(journal_do_erase, g_erased, NULL)) return false;
+    g_erased += SEGMENT_PAGES;
+    g_stats.erases++;
+    return true;
+}
+
+// Programmiert die offene Seite (erneut, mit allen bisherigen Einträgen)
+static bool page_program(void) {
+    if (g_head >= g_erased) {
+        // Kein Segment vorab gelöscht: jetzt, während Scans anstehen
+        if (!journal_erase_next()) return false;
+        g_stats.forced_erases++;
+    }
+    if (!journal_flash(journal_do_program, g_head, g_page.data)) return false;
+    g_page.programmed = g_page.used;
+    g_stats.programs++;
+    return true;
+}
+
+// Schließt die offene Seite: programmiert sie und rückt g_head weiter
+static bool page_close(void) {
+    if (g_page.used == 0) return true;
+    if (g_page.programmed != g_page.used && !page_program()) return false;
+
+    g_head++;
+    memset(g_page.data, 0xFF, sizeof(g_page.data));
+    g_page.used = g_page.programmed = 0;
+    g_page.count = 0;
+    return true;
+}
+
+// Beginnt eine neue Seite im RAM
+static void page_open(uint8_t kind, uint16_t boot, uint32_t first_seq) {
+    uint8_t* const p = g_page.data;
+    put_u16(&p[0], PAGE_MAGIC);
+    put_u16(&p[2], boot);
+    put_u32(&p[4], g_head);
+    put_u32(&p[8], first_seq);
+    p[12] = kind;
+    p[13] = 0xFF;
+    put_u16(&p[14], net_frame_crc16(0xFFFF, p, 14));
+    g_page.used = PAGE_HEAD;
+    g_page.boot = boot;
+    g_page.first_seq = first_seq;
+    g_page.count = 0;
+}
+
+// Schreibt den Stand der Bestätigungen (g_tail) als eigene Seite
+static bool journal_checkpoint(void) {
+    if (!page_close() || !page_writable(g_head)) return false;
+
+    page_open(PAGE_CHECKPOINT, g_boot, 0);
+    uint8_t* const p = &g_page.data[PAGE_HEAD];
+    put_u32(&p[0], g_tail.page);
+    p[4] = g_tail.rec;
+    p[5] = journal_crc8(p, 5);
+    g_page.used = PAGE_HEAD + 6;
+    if (!page_close()) return false;
+    g_cp = g_tail;
+    return true;
+}
+
+uint16_t scan_journal_init(void) {
+    uint32_t newest = 0, cp_page = 0;
+    bool found = false, cp_found = false;
+    journal_pos_t cp = { 0 };
+
+    memset(g_page.data, 0xFF, sizeof(g_page.data));
+
+    // Jüngste Seite und jüngsten Checkpoint suchen
+    for (uint32_t i = 0; i < JOURNAL_PAGES; ++i) {
+        const uint8_t* const p = flash_page(i);
+        uint32_t const page = get_u32(&p[4]);
+        if (page % JOURNAL_PAGES != i || page_kind(p, page) < 0) continue;
+        if (!found || page > newest) {
+            newest = page;
+            g_boot = (uint16_t)(get_u16(&p[2]) + 1u);
+            found = true;
+        }
+        const uint8_t* const c = &p[PAGE_HEAD];
+        if (p[12] == PAGE_CHECKPOINT && journal_crc8(c, 5) == c[5] && (!cp_found || page > cp_page)) {
+            cp_page = page;
+            cp = (journal_pos_t){ .page = get_u32(&c[0]), .rec = c[4] };
+            cp_found = true;
+        }
+    }
+
+    // Leerer Flash: Zufallswert, damit der Server keine Nummern eines früheren Images erwartet
+    if (!found) g_boot = (uint16_t)get_rand_32();
+    g_head = found ? newest + 1 : 0;
+
+    // Hinter der jüngsten Seite muss der Rest ihres Segments leer sein (bei einem
+    // Stromausfall angefangene Seiten überspringen)
+    uint32_t const end = (g_head + SEGMENT_PAGES - 1) / SEGMENT_PAGES * SEGMENT_PAGES;
+    for (uint32_t i = g_head; i < end; ++i) {
+        if (!page_blank(i)) g_head = i + 1;
+    }
+    g_erased = end;
+    if (g_head == g_erased && segment_blank(g_erased)) g_erased += SEGMENT_PAGES;
+
+    // Älteste noch vorhandene Seite: das Segment ab g_erased stammt aus der vorigen Runde
+    uint32_t const first = (g_erased > JOURNAL_PAGES) ? g_erased - JOURNAL_PAGES : 0;
+    g_tail = (journal_pos_t){ .page = first };
+    if (cp_found && cp.page >= first && cp.page <= g_head) {
+        // Bestätigte Einträge der Checkpoint-Seite überspringen
+        g_tail = (journal_pos_t){ .page = cp.page };
+        journal_pos_t pos = g_tail;
+        while (g_tail.rec < cp.rec && journal_next(&pos, NULL) && pos.page == cp.page) g_tail = pos;
+    }
+    g_read = g_tail;
+
+    // Unbestätigte Scans zählen
+    journal_pos_t pos = g_tail;
+    while (journal_next(&pos, NULL)) g_stats.recovered++;
+    g_stats.live = g_stats.recovered;
+
+    // Startmarke: der Checkpoint hält den neuen Startzähler fest (eine Seite pro Start, auch
+    // ohne Ausfall). Ohne sie leitete der nächste Start denselben Zähler aus der jüngsten
+    // Seite ab, und der Server hielte dessen Scans für Wiederholungen dieses Starts.
+    g_stats.boot = g_boot;
+    journal_checkpoint();
+    g_stats.forced_erases = 0;
+    return g_boot;
+}
+
+bool scan_journal_empty(void) {
+    journal_pos_t pos = g_read;
+    return !journal_next(&pos, NULL);
+}
+
+bool scan_journal_append(const net_scan_t* scan) {
+    uint8_t rec[RECORD_OVERHEAD + SCAN_CODE_MAX];
+
+    // Eintrag vorbereiten
+    size_t const code = net_code_pack(rec, scan->code, scan->len);
+    put_u32(&rec[code], scan->t_ms);
+    rec[code + 4] = scan->scanner;
+    rec[code + 5] = journal_crc8(rec, code + 5);
+    size_t const size = code + 6;
+
+    // Neue Seite bei anderem Start, Lücke in den Nummern oder voller Seite
+    if (g_page.used && (scan->boot != g_page.boot || scan->seq != g_page.first_seq + g_page.count ||
+                        g_page.used + size > FLASH_PAGE_SIZE)) {
+        if (!page_close()) return false;
+    }
+    if (g_page.used == 0) {
+        if (!page_writable(g_head)) {
+            if (!g_full) g_stats.full++;
+            g_full = true;
+            return false;
+        }
+        page_open(PAGE_SCANS, scan->boot, scan->seq);
+    }
+
+    uint32_t const now = journal_now_ms();
+    if (g_page.programmed == g_page.used) g_page.t_dirty_ms = now;
+    memcpy(&g_page.data[g_page.used], rec, size);
+    g_page.used = (uint16_t)(g_page.used + size);
+    g_page.count++;
+    g_full = false;
+    g_stats.appended++;
+    g_stats.live++;
+    return true;
+}
+
+bool scan_journal_read(net_scan_t* out) {
+    if (!journal_next(&g_read, out)) return false;
+
+    out->t_us = out->t_first_us = 0;
+    out->live = false;
+    out->journaled = true;
+    g_stats.replayed++;
+    return true;
+}
+
+void scan_journal_trim(uint32_t n) {
+    while (n-- && journal_next(&g_tail, NULL)) {
+        g_stats.trimmed++;
+        g_stats.live--;
+    }
+}
+
+void scan_journal_poll(bool quiet) {
+    uint32_t const now = journal_now_ms();
+
+    // Offene Seite spätestens nach SCAN_JOURNAL_FLUSH_MS sichern
+    if (g_page.programmed != g_page.used && g_page.count && now - g_page.t_dirty_ms >= SCAN_JOURNAL_FLUSH_MS) {
+        page_program();
+    }
+
+    // Checkpoint, wenn alles bestätigt ist oder g_tail ein Segment weiter liegt (begrenzt
+    // die Wiedergabe nach einem Neustart auf etwa ein Segment)
+    bool const moved = g_tail.page != g_cp.page || g_tail.rec != g_cp.rec;
+    if (moved && (g_stats.live == 0 || g_tail.page / SEGMENT_PAGES != g_cp.page / SEGMENT_PAGES)) {
+        journal_checkpoint();
+    }
+
+    // Nächstes Segment in einer Scan-Pause vorab löschen (nur, solange das Journal
+    // gebraucht wird; im Normalbetrieb schreibt nur die Startmarke eine Seite)
+    if (quiet && g_stats.live && g_erased - g_head < SEGMENT_PAGES) {
+        journal_erase_next();
+    }
+
+    g_stats.pages_used = (uint16_t)(g_head - g_tail.page);
+    g_stats.pages = JOURNAL_PAGES;
+}
+
+void scan_journal_get_stats(scan_journal_stats_t* out) {
+    *out = g_stats;
+}
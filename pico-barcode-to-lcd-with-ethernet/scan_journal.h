@@ -0,0 +1,99 @@
+// Offline-Journal für Scans im On-Board-Flash (Ring aus 4-KB-Segmenten)
+//
+// Kann das Sendefenster (net_tx.h) keine Scans mehr aufnehmen, weil der Server nicht
+// bestätigt, landen sie hier. Das Journal ist ein Log über einen reservierten Bereich am
+// Ende des Flash: Seiten (256 B) werden der Reihe nach beschrieben, ein Segment (4 KB)
+// wird erst gelöscht, wenn der Schreibzeiger es wieder erreicht. Jede Seite trägt eine
+// fortlaufende Seitennummer (Position im Log, auch über Neustarts), der Ring dreht sich
+// also gleichmäßig über alle Segmente weiter (Wear-Levelling).
+//
+// Seitenaufbau:
+//   Kopf (16 B): magic u16 | boot u16 | page_seq u32 | first_seq u32 | kind u8 | 0xFF |
+//                crc16 (über die 14 B davor, kind eingeschlossen)
+//   kind 0 (Scans): Einträge hintereinander, danach 0xFF
+//     Eintrag: len u8 (Bit 7 = BCD, siehe net_code_pack()) | Code | t_ms u32 | scanner u8 | crc8
+//     Die Scan-Nummern sind fortlaufend ab first_seq.
+//   kind 1 (Checkpoint): tail_page u32 | tail_rec u8 | crc8
+//     Stand der Bestätigungen; beim Start beginnt die Wiedergabe dort.
+//
+// Außerhalb eines Ausfalls wird der Flash nur einmal pro Start beschrieben: scan_journal_init()
+// programmiert einen Checkpoint als Startmarke, die den neuen Startzähler festhält. Bei
+// 8192 Seiten (2 MB) wird damit etwa alle 16 Starts ein Segment gelöscht.
+//
+// Der Bereich ist beim Linken reserviert (scan_journal.ld): wächst das Programm hinein,
+// bricht der Build ab.
+//
+// Neue Einträge sammeln sich in einer Seite im RAM. Sie wird nach SCAN_JOURNAL_FLUSH_MS
+// oder wenn sie voll ist programmiert; eine teilweise programmierte Seite wird später mit
+// den weiteren Einträgen erneut programmiert (NOR-Flash ändert dabei nur 0xFF-Bytes).
+// Während ein Segment gelöscht wird, stehen beide Cores still (flash_safe_execute());
+// das Löschen des nächsten Segments geschieht deshalb vorab in Scan-Pausen
+// (scan_journal_poll()). Alle Funktionen nur von Core 1.
+
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "net_tx.h"        // net_scan_t
+
+// Größe des reservierten Bereichs am Ende des Flash (Vielfaches von 4 KB)
+// 2 MB fassen etwa 140000 EAN-13-Scans. Im Firmware-Build setzt CMakeLists.txt den Wert
+// (SCAN_JOURNAL_SIZE), damit Compiler und Linker-Prüfung übereinstimmen.
+#ifndef SCAN_JOURNAL_SIZE
+#define SCAN_JOURNAL_SIZE (2u * 1024u * 1024u)
+#endif
+
+// Höchstens so lange bleiben neue Einträge nur im RAM
+#ifndef SCAN_JOURNAL_FLUSH_MS
+#define SCAN_JOURNAL_FLUSH_MS 1000
+#endif
+
+// So lange ohne neuen Scan gilt die Leitung als ruhig (vorab löschen erlaubt)
+#ifndef SCAN_JOURNAL_QUIET_MS
+#define SCAN_JOURNAL_QUIET_MS 100
+#endif
+
+// Zähler des Journals
+typedef struct {
+    uint16_t boot;              // Startzähler dieses Starts
+    uint32_t appended;          // Aufgenommene Scans
+    uint32_t replayed;          // An das Sendefenster gelieferte Scans (inkl. Wiedergabe nach Start)
+    uint32_t trimmed;           // Bestätigte und freigegebene Scans
+    uint32_t recovered;         // Beim Start im Flash vorgefundene, unbestätigte Scans
+    uint32_t programs;          // Seitenprogrammierungen
+    uint32_t erases;            // Gelöschte Segmente
+    uint32_t forced_erases;     // Davon ohne Scan-Pause (Scans standen dabei still)
+    uint32_t full;              // Wie oft das Journal voll war (Scans blieben im Scan-Ring)
+    uint32_t flash_errors;      // Fehlgeschlagene Flash-Operationen und defekte Seiten
+    uint32_t live;              // Unbestätigte Scans im Journal
+    uint16_t pages_used;        // Belegte Seiten (ab der ältesten unbestätigten)
+    uint16_t pages;             // Seiten im Journal
+} scan_journal_stats_t;
+
+// Liest das Journal aus dem Flash und bestimmt den Startzähler
+// Unbestätigte Scans früherer Starts stehen danach zum Lesen bereit.
+// Rückgabe: Startzähler dieses Starts (jüngster im Flash + 1)
+uint16_t scan_journal_init(void);
+
+// true, wenn keine ungelesenen Scans vorliegen (neue Scans dürfen ins Sendefenster)
+bool scan_journal_empty(void);
+
+// Nimmt einen Scan auf (boot = scan_journal_init(), Nummern aufsteigend)
+// Rückgabe: false, wenn das Journal voll ist (Scan im Scan-Ring lassen)
+bool scan_journal_append(const net_scan_t* scan);
+
+// Liefert den ältesten ungelesenen Scan (Flash-Seiten, danach die Seite im RAM)
+// Rückgabe: false, wenn keiner vorliegt
+bool scan_journal_read(net_scan_t* out);
+
+// Gibt die ältesten n gelesenen Scans frei (vom Server bestätigt)
+void scan_journal_trim(uint32_t n);
+
+// Programmiert fällige Seiten, schreibt Checkpoints und löscht vorab das nächste Segment
+// (jeden Schleifendurchlauf aufrufen)
+// Parameter quiet: true, wenn seit SCAN_JOURNAL_QUIET_MS kein Scan kam
+void scan_journal_poll(bool quiet);
+
+// Liefert die Zähler des Journals
+void scan_journal_get_stats(scan_journal_stats_t* out);
@@ -0,0 +1,77 @@
+// Lock-freier Scan-Ring (ein Produzent, mehrere Konsumenten)
+//
+// Core 0 schreibt nur g_head, jede Senke auf Core 1 schreibt nur ihren eigenen
+// Lesezeiger. Ein Platz wird erst überschrieben, wenn alle Senken ihn freigegeben
+// haben. Die Speicherbarrieren sorgen dafür, dass ein Eintrag vollständig im RAM
+// steht, bevor der andere Core den neuen Index sieht.
+
+#include "scan_ring.h"
+#include "hardware/sync.h"
+#include "pico/stdlib.h"
+#include <string.h>
+
+// Index auf eigener Cache-Zeile, damit Produzent und Konsumenten sich nicht stören
+typedef struct __attribute__((aligned(SCAN_RING_ALIGN))) {
+    volatile uint32_t v;
+} scan_index_t;
+
+static scan_record_t g_ring[SCAN_RING_SIZE];
+static scan_index_t g_head;                      // Nächster Schreibplatz (Core 0)
+static scan_index_t g_tail[SCAN_SINK_COUNT];     // Nächster Leseplatz je Senke (Core 1)
+static scan_ring_stats_t g_stats;
+
+// Liefert den Lesezeiger der langsamsten Senke
+static inline uint32_t scan_ring_min_tail(uint32_t head) {
+    uint32_t used_max = 0;
+    for (int i = 0; i < SCAN_SINK_COUNT; ++i) {
+        uint32_t used = head - g_tail[i].v;
+        if (used > used_max) used_max = used;
+    }
+    return head - used_max;
+}
+
+bool scan_ring_publish(const char* code, size_t len, uint8_t dev_addr, uint8_t instance, uint32_t t_first_us,
+                       uint8_t flags) {
+    uint32_t const head = g_head.v;
+    uint32_t const used = head - scan_ring_min_tail(head);
+
+    if (used >= SCAN_RING_SIZE) {  // Ring voll
+        g_stats.overflows++;
+        return false;
+    }
+    if (used + 1 > g_stats.high_water) g_stats.high_water = used + 1;
+
+    if (len > SCAN_CODE_MAX - 1) len = SCAN_CODE_MAX - 1;
+    scan_record_t* rec = &g_ring[head & (SCAN_RING_SIZE - 1)];
+    rec->seq = g_stats.published++;
+    rec->t_us = time_us_32();
+    rec->t_first_us = t_first_us;
+    rec->dev_addr = dev_addr;
+    rec->instance = instance;
+    rec->len = (uint8_t)len;
+    rec->flags = flags;
+    memcpy(rec->code, code, len);
+    rec->code[len] = '\0';
+
+    // Eintrag veröffentlichen
+    __mem_fence_release();
+    g_head.v = head + 1;
+    return true;
+}
+
+const scan_record_t* scan_ring_peek(scan_sink_t sink) {
+    uint32_t const tail = g_tail[sink].v;
+    if (g_head.v == tail) return NULL;  // Nichts Neues für diese Senke
+    __mem_fence_acquire();
+    return &g_ring[tail & (SCAN_RING_SIZE - 1)];
+}
+
+void scan_ring_release(scan_sink_t sink) {
+    // Platz freigeben (erst nachdem die Senke den Eintrag fertig gelesen hat)
+    __mem_fence_release();
+    g_tail[sink].v = g_tail[sink].v + 1;
+}
+
+void scan_ring_get_stats(scan_ring_stats_t* out) {
+    *out = g_stats;
+}
@@ -0,0 +1,67 @@
+// Lock-freier Scan-Ring zwischen HID-Dekodierung (Core 0) und den Ausgabe-Senken (Core 1)
+// Ein Produzent (HID-Dekoder), mehrere Konsumenten (LCD, Ethernet, LED), die jeweils
+// einen eigenen Lesezeiger haben und den Ring unabhängig voneinander abarbeiten.
+
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+// Maximale Barcode-Länge inkl. Null-Terminierung
+#define SCAN_CODE_MAX 64
+
+// Anzahl Einträge im Ring (Zweierpotenz)
+#ifndef SCAN_RING_SIZE
+#define SCAN_RING_SIZE 16
+#endif
+
+// Ausrichtung der Einträge und Indizes (eine Cache-Zeile)
+#define SCAN_RING_ALIGN 32
+
+// Markierungen eines Scans
+#define SCAN_FLAG_CHECK 0x01    // Prüfzeichen falsch, trotzdem weitergegeben (siehe scan_check.h)
+
+// Konsumenten des Scan-Rings
+typedef enum {
+    SCAN_SINK_LCD = 0,   // Anzeige auf dem LCD
+    SCAN_SINK_NET,       // Versand über CH9121
+    SCAN_SINK_LED,       // LED-Feedback
+    SCAN_SINK_COUNT
+} scan_sink_t;
+
+// Ein fertig gelesener Barcode
+typedef struct __attribute__((aligned(SCAN_RING_ALIGN))) {
+    uint32_t seq;               // Fortlaufende Scan-Nummer (ab 0 seit Start)
+    uint32_t t_us;              // Zeitstempel des Terminators (time_us_32)
+    uint32_t t_first_us;        // Zeitstempel des ersten HID-Reports des Scans (time_us_32)
+    uint8_t dev_addr;           // USB-Geräteadresse des Scanners
+    uint8_t instance;           // HID-Instanz des Scanners
+    uint8_t len;                // Länge ohne Null-Terminierung
+    uint8_t flags;              // SCAN_FLAG_*
+    char code[SCAN_CODE_MAX];   // Null-terminierter Barcode
+} scan_record_t;
+
+// Zähler des Scan-Rings
+typedef struct {
+    uint32_t published;         // Veröffentlichte Scans
+    uint32_t overflows;         // Verworfene Scans (Ring voll, Senken zu langsam)
+    uint32_t high_water;        // Maximale Belegung seit Start (Einträge)
+} scan_ring_stats_t;
+
+// Veröffentlicht einen Barcode (nur Core 0, blockiert nie)
+// Parameter t_first_us: Zeitstempel des ersten Reports dieses Scans (Latenzmessung)
+// Parameter flags: SCAN_FLAG_*
+// Rückgabe: false, wenn der Ring voll ist (Barcode wird verworfen und gezählt)
+bool scan_ring_publish(const char* code, size_t len, uint8_t dev_addr, uint8_t instance, uint32_t t_first_us,
+                       uint8_t flags);
+
+// Liefert den nächsten ungelesenen Eintrag einer Senke oder NULL, wenn keiner vorliegt
+// Der Eintrag bleibt gültig, bis die Senke ihn mit scan_ring_release() freigibt.
+const scan_record_t* scan_ring_peek(scan_sink_t sink);
+
+// Gibt den mit scan_ring_peek() gelesenen Eintrag der Senke frei
+void scan_ring_release(scan_sink_t sink);
+
+// Liefert die Zähler des Scan-Rings
+void scan_ring_get_stats(scan_ring_stats_t* out);
@@ -0,0 +1,270 @@
+"""
+Lokaler Spool für empfangene Scans zwischen mysql_bridge.py und MySQL
+
+mysql_bridge.py hängt neue Scans hier an und bestätigt sie der Firmware, sobald sie per
+fsync auf der Platte liegen. Ein Hintergrund-Thread überträgt sie von dort gruppenweise in
+MySQL und hält den übertragenen Stand im Checkpoint fest. Ist die Datenbank nicht
+erreichbar (Wartung, Neustart), wächst nur der Spool; die Scanner merken davon nichts.
+
+Aufbau des Verzeichnisses:
+    NNNNNNNN.seg    Segmente, der Reihe nach beschrieben; ab segment_bytes beginnt ein neues
+                    Datensatz: Länge u16 | Nutzdaten | CRC-32 u32 (über die Nutzdaten)
+                    Nutzdaten: device_id u32 | boot u16 | seq u32 | scanner u8 |
+                               device_ms u32 | timestamp (µs seit 1970, lokal) i64 | Code (UTF-8)
+                    timestamp = TIMESTAMP_NONE: Zeit unbekannt (NULL in MySQL)
+    checkpoint      1. Zeile "Segment Offset": alles davor ist in MySQL gespeichert
+                    danach je Zeile "device_id boot next_seq": Stand der zuletzt übertragenen
+                    Geräte/Starts (höchstens CHECKPOINT_KEYS)
+                    (wird per rename ersetzt, ist also immer vollständig)
+
+Ganz übertragene Segmente werden gelöscht. Beim Start wird ein am Ende abgeschnittener
+Datensatz (Absturz während des Schreibens) entfernt, alles nach dem Checkpoint wird erneut
+übertragen. Was dabei doppelt ankommt, fängt der eindeutige Schlüssel (device_id, boot, seq)
+ab (siehe Create_MySQL_Database.sql). Der Stand pro Gerät/Start (next_seq) ergibt sich aus dem
+Checkpoint und den Datensätzen danach; so kennt der Zwischenserver ihn nach einem Neustart
+auch bei leerem Spool.
+
+Schreiben (append/sync) nur aus einem Thread, Lesen (read/commit) nur aus einem anderen.
+"""
+
+import binascii
+import os
+import struct
+import threading
+from datetime import datetime, timedelta
+
+# Beginn eines neuen Segments ab dieser Größe
+SEGMENT_BYTES = 16 * 1024 * 1024
+
+# Im Checkpoint festgehaltene Geräte/Starts (die zuletzt übertragenen)
+CHECKPOINT_KEYS = 1024
+
+RECORD_LEN = struct.Struct("<H")
+RECORD_HEAD = struct.Struct("<IHIBIq")    # device_id, boot, seq, scanner, device_ms, timestamp_us
+RECORD_CRC = struct.Struct("<I")
+
+EPOCH = datetime(1970, 1, 1)
+TIMESTAMP_NONE = -(1 << 63)
+
+
+def encode_row(row):
+    """Verpackt eine Zeile (Spalten wie mysql_bridge.INSERT_COLUMNS) als Datensatz."""
+    code, timestamp, device_id, boot, seq, scanner, device_ms = row
+    us = TIMESTAMP_NONE if timestamp is None else (timestamp - EPOCH) // timedelta(microseconds=1)
+    body = RECORD_HEAD.pack(device_id, boot, seq, scanner, device_ms, us) + code.encode("utf-8")
+    return RECORD_LEN.pack(len(body)) + body + RECORD_CRC.pack(binascii.crc32(body))
+
+
+def read_record(f):
+    """Liest den nächsten Datensatz.
+
+    Liefert (Zeile, Größe in Bytes); None am Ende der Datei oder bei einem unvollständigen
+    bzw. beschädigten Datensatz.
+    """
+    head = f.read(RECORD_LEN.size)
+    if len(head) < RECORD_LEN.size:
+        return None
+    (n,) = RECORD_LEN.unpack(head)
+    if n < RECORD_HEAD.size:
+        return None
+    data = f.read(n + RECORD_CRC.size)
+    if len(data) < n + RECORD_CRC.size:
+        return None
+    body = data[:n]
+    if RECORD_CRC.unpack(data[n:])[0] != binascii.crc32(body):
+        return None
+    device_id, boot, seq, scanner, device_ms, us = RECORD_HEAD.unpack_from(body)
+    code = body[RECORD_HEAD.size:].decode("utf-8", errors="replace")
+    timestamp = None if us == TIMESTAMP_NONE else EPOCH + timedelta(microseconds=us)
+    row = (code, timestamp, device_id, boot, seq, scanner, device_ms)
+    return row, RECORD_LEN.size + n + RECORD_CRC.size
+
+
+class Spool:
+    """Segmentierte Datei-Warteschlange mit Checkpoint (siehe Moduldokumentation)."""
+
+    def __init__(self, path, segment_bytes=SEGMENT_BYTES):
+        self.path = path
+        self.segment_bytes = segment_bytes
+        os.makedirs(path, exist_ok=True)
+
+        # (device_id, boot) -> nächste Nummer nach dem letzten übertragenen Datensatz
+        self.drained = {}
+        self.checkpoint = self._load_checkpoint()
+        # Beim Start vorgefundene, noch nicht übertragene Zeilen
+        self.recovered = 0
+        # (device_id, boot) -> nächste Nummer nach dem letzten Datensatz im Spool (inkl. übertragener)
+        self.next_seq = dict(self.drained)
+        self._recover()
+
+        # Schreibseite
+        segments = self._segments()
+        self.segment = max(segments[-1] if segments else 0, self.checkpoint[0])
+        self.file = open(self._name(self.segment), "ab")
+        self.size = self.file.tell()
+        self.unsynced = 0
+        self._sync_dir()
+
+        # Gemeinsamer Stand: Ende des per fsync gesicherten Teils, offene Zeilen
+        self.cond = threading.Condition()
+        self.durable = (self.segment, self.size)
+        self.backlog = self.recovered
+
+        # Leseseite
+        self.read_pos = self.checkpoint
+        self.read_file = None
+        self.read_segment = None
+        self.read_next = {}     # Stand der zuletzt gelesenen Zeilen, gilt ab commit()
+
+    def _name(self, segment):
+        return os.path.join(self.path, f"{segment:08d}.seg")
+
+    def _segments(self):
+        return sorted(int(name[:-4]) for name in os.listdir(self.path)
+                      if name.endswith(".seg") and name[:-4].isdigit())
+
+    def _sync_dir(self):
+        """Sichert Anlegen, Umbenennen und Löschen von Dateien im Verzeichnis."""
+        fd = os.open(self.path, os.O_RDONLY)
+        try:
+            os.fsync(fd)
+        finally:
+            os.close(fd)
+
+    def _load_checkpoint(self):
+        try:
+            with open(os.path.join(self.path, "checkpoint")) as f:
+                lines = f.read().splitlines()
+            segment, offset = lines[0].split()
+            for line in lines[1:]:
+                device_id, boot, next_seq = (int(v) for v in line.split())
+                self.drained[(device_id, boot)] = next_seq
+            return int(segment), int(offset)
+        except (OSError, ValueError, IndexError):
+            return 0, 0
+
+    def _recover(self):
+        """Löscht übertragene Segmente, zählt den Rest und kürzt einen abgeschnittenen Schluss."""
+        segments = self._segments()
+        for segment in segments:
+            name = self._name(segment)
+            if segment < self.checkpoint[0]:
+                os.remove(name)
+                continue
+            offset = self.checkpoint[1] if segment == self.checkpoint[0] else 0
+            with open(name, "rb") as f:
+                f.seek(offset)
+                while (rec := read_record(f)) is not None:
+                    row, size = rec
+                    self.next_seq[(row[2], row[3])] = (row[4] + 1) & 0xFFFFFFFF
+                    self.recovered += 1
+                    offset += size
+                end = f.seek(0, os.SEEK_END)
+            if offset < end:
+                if segment == segments[-1]:
+                    print(f"  Spool: {end - offset} Bytes unvollständig am Ende von {name} entfernt")
+                    with open(name, "r+b") as f:
+                        f.truncate(offset)
+                        os.fsync(f.fileno())
+                else:
+                    print(f"  Spool: {name} ab Offset {offset} beschädigt, Rest übersprungen")
+
+    def append(self, rows):
+        """Hängt Zeilen an (gepuffert; gesichert erst mit sync())."""
+        data = b"".join(encode_row(row) for row in rows)
+        self.file.write(data)
+        self.size += len(data)
+        self.unsynced += len(rows)
+
+    def sync(self):
+        """Sichert alle angehängten Zeilen per fsync und gibt sie zum Übertragen frei."""
+        self.file.flush()
+        os.fsync(self.file.fileno())
+        n, self.unsynced = self.unsynced, 0
+        if self.size >= self.segment_bytes:
+            # Segment voll: das nächste beginnen
+            self.file.close()
+            self.segment += 1
+            self.file = open(self._name(self.segment), "ab")
+            self.size = 0
+            self._sync_dir()
+        with self.cond:
+            self.durable = (self.segment, self.size)
+            self.backlog += n
+            self.cond.notify()
+
+    def read(self, max_rows, timeout):
+        """Liest bis zu max_rows gesicherte, noch nicht gelesene Zeilen.
+
+        Wartet höchstens timeout Sekunden, falls keine vorliegen. Liefert (Zeilen, Position
+        nach der letzten); die Position geht nach dem Speichern an commit().
+        """
+        with self.cond:
+            if self.read_pos >= self.durable:
+                self.cond.wait(timeout)
+            end = self.durable
+
+        rows = []
+        segment, offset = self.read_pos
+        while len(rows) < max_rows and (segment, offset) < end:
+            if self.read_segment != segment:
+                if self.read_file:
+                    self.read_file.close()
+                self.read_file = open(self._name(segment), "rb")
+                self.read_segment = segment
+                self.read_file.seek(offset)
+            rec = read_record(self.read_file)
+            if rec is None:
+                if segment == end[0]:
+                    break
+                if offset < self.read_file.seek(0, os.SEEK_END):
+                    print(f"  Spool: {self._name(segment)} ab Offset {offset} beschädigt, Rest übersprungen")
+                # Segment zu Ende: im nächsten weiter
+                segment, offset = segment + 1, 0
+                continue
+            row, size = rec
+            rows.append(row)
+            self.read_next[(row[2], row[3])] = (row[4] + 1) & 0xFFFFFFFF
+            offset += size
+        self.read_pos = (segment, offset)
+        return rows, self.read_pos
+
+    def wake(self):
+        """Beendet das Warten eines read() vorzeitig (liefert dann keine Zeilen)."""
+        with self.cond:
+            self.cond.notify()
+
+    def commit(self, position, n):
+        """Hält fest, dass alles bis position (n Zeilen) in MySQL gespeichert ist."""
+        # Zuletzt übertragene Geräte/Starts ans Ende, die ältesten fallen heraus
+        for key, next_seq in self.read_next.items():
+            self.drained.pop(key, None)
+            self.drained[key] = next_seq
+        self.read_next = {}
+        while len(self.drained) > CHECKPOINT_KEYS:
+            del self.drained[next(iter(self.drained))]
+        name = os.path.join(self.path, "checkpoint")
+        with open(name + ".tmp", "w") as f:
+            f.write(f"{position[0]} {position[1]}\n")
+            f.writelines(f"{k[0]} {k[1]} {v}\n" for k, v in self.drained.items())
+            f.flush()
+            os.fsync(f.fileno())
+        os.replace(name + ".tmp", name)
+        for segment in range(self.checkpoint[0], position[0]):
+            if segment == self.read_segment:
+                self.read_file.close()
+                self.read_file = self.read_segment = None
+            try:
+                os.remove(self._name(segment))
+            except FileNotFoundError:
+                pass
+        self._sync_dir()
+        self.checkpoint = position
+        with self.cond:
+            self.backlog -= n
+
+    def stats(self):
+        """Liefert (offene Zeilen, Segmente auf der Platte)."""
+        with self.cond:
+            backlog = self.backlog
+        return backlog, self.segment - self.checkpoint[0] + 1
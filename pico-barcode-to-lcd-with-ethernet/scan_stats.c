@@ -0,0 +1,74 @@
+// Latenzmessung pro Scan (siehe scan_stats.h)
+//
+// Die Histogramme liegen komplett im RAM und haben feste, logarithmisch wachsende
+// Klassengrenzen; das Eintragen kostet nur ein clz und ein paar Additionen.
+
+#include "scan_stats.h"
+#include <stdio.h>
+#include <string.h>
+
+static scan_stats_t g_scan_stats = {
+    .hist = {
+        [SCAN_LAT_SCANNER] = { .min_us = UINT32_MAX },
+        [SCAN_LAT_LCD]     = { .min_us = UINT32_MAX },
+        [SCAN_LAT_NET]     = { .min_us = UINT32_MAX },
+        [SCAN_LAT_TOTAL]   = { .min_us = UINT32_MAX },
+        [SCAN_LAT_ACK]     = { .min_us = UINT32_MAX },
+    },
+};
+
+// Namen der Strecken im Dump
+static const char* const scan_lat_names[SCAN_LAT_COUNT] = { "scanner", "lcd", "net", "total", "ack" };
+
+// Berechnet die Histogrammklasse eines Messwerts
+static inline unsigned scan_hist_bucket(uint32_t us) {
+    uint32_t const q = us / SCAN_HIST_BASE_US;
+    if (q == 0) return 0;
+    unsigned const b = 32u - (unsigned)__builtin_clz(q);
+    return b < SCAN_HIST_BUCKETS ? b : SCAN_HIST_BUCKETS - 1;
+}
+
+void scan_stats_char(bool kept) {
+    if (kept) g_scan_stats.chars++;
+    else g_scan_stats.dropped_chars++;
+}
+
+void scan_stats_scan(bool published, uint8_t len) {
+    g_scan_stats.scans++;
+    if (!published) {
+        g_scan_stats.dropped_scans++;
+        g_scan_stats.dropped_chars += len;
+    }
+}
+
+void scan_stats_record(scan_lat_t which, uint32_t us) {
+    scan_hist_t* h = &g_scan_stats.hist[which];
+    h->count++;
+    h->sum_us += us;
+    if (us < h->min_us) h->min_us = us;
+    if (us > h->max_us) h->max_us = us;
+    h->bucket[scan_hist_bucket(us)]++;
+}
+
+void scan_stats_get(scan_stats_t* out) {
+    *out = g_scan_stats;
+}
+
+bool scan_stats_format_line(const scan_stats_t* st, unsigned line, char* buf, size_t cap) {
+    if (line == 0) {
+        snprintf(buf, cap, "#STATS scans=%lu chars=%lu dropped_chars=%lu dropped_scans=%lu base_us=%u",
+                 (unsigned long)st->scans, (unsigned long)st->chars, (unsigned long)st->dropped_chars,
+                 (unsigned long)st->dropped_scans, (unsigned)SCAN_HIST_BASE_US);
+        return true;
+    }
+    if (line > SCAN_LAT_COUNT) return false;
+
+    scan_hist_t const* h = &st->hist[line - 1];
+    int n = snprintf(buf, cap, "#HIST %s n=%lu min=%lu avg=%lu max=%lu b=", scan_lat_names[line - 1],
+                     (unsigned long)h->count, (unsigned long)(h->count ? h->min_us : 0),
+                     (unsigned long)(h->count ? h->sum_us / h->count : 0), (unsigned long)h->max_us);
+    for (unsigned i = 0; i < SCAN_HIST_BUCKETS && n > 0 && (size_t)n < cap; ++i) {
+        n += snprintf(buf + n, cap - (size_t)n, i ? ",%lu" : "%lu", (unsigned long)h->bucket[i]);
+    }
+    return true;
+}
@@ -0,0 +1,65 @@
+// Latenzmessung pro Scan: Histogramme mit festen Klassen und Zeichenzähler
+//
+// Gemessen wird zwischen vier Zeitpunkten eines Scans (alle time_us_32):
+//   t_first: erster HID-Report des Scans (erstes Zeichen)
+//   t_term:  Terminator '\r' in process_kbd_report()
+//   LCD:     Barcode vollständig auf dem Display (Ende des I2C-Frames)
+//   UART:    letztes Byte hat UART0 verlassen
+// Zeichen- und Scan-Zähler schreibt nur Core 0, die Histogramme nur Core 1.
+
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+// Anzahl Histogrammklassen; Klasse i zählt Werte < (SCAN_HIST_BASE_US << i),
+// die letzte Klasse alles darüber (bei 64 us Basis ab ~1 s)
+#define SCAN_HIST_BUCKETS 16
+#define SCAN_HIST_BASE_US 64
+
+// Gemessene Strecken
+typedef enum {
+    SCAN_LAT_SCANNER = 0,   // t_first -> t_term (Tippdauer des Scanners)
+    SCAN_LAT_LCD,           // t_term  -> LCD fertig
+    SCAN_LAT_NET,           // t_term  -> letztes UART-Byte
+    SCAN_LAT_TOTAL,         // t_first -> letztes UART-Byte
+    SCAN_LAT_ACK,           // t_term  -> Bestätigung vom Server (inkl. Wiederholungen)
+    SCAN_LAT_COUNT
+} scan_lat_t;
+
+// Histogramm einer Strecke
+typedef struct {
+    uint32_t count;
+    uint32_t min_us;
+    uint32_t max_us;
+    uint64_t sum_us;
+    uint32_t bucket[SCAN_HIST_BUCKETS];
+} scan_hist_t;
+
+typedef struct {
+    uint32_t scans;             // Abgeschlossene Scans (Terminator mit Inhalt)
+    uint32_t chars;             // Übernommene Zeichen
+    uint32_t dropped_chars;     // Verworfene Zeichen (Puffer voll oder Scan verworfen)
+    uint32_t dropped_scans;     // Verworfene Scans (Scan-Ring voll)
+    scan_hist_t hist[SCAN_LAT_COUNT];
+} scan_stats_t;
+
+// Core 0: ein druckbares Zeichen wurde übernommen (kept) oder verworfen
+void scan_stats_char(bool kept);
+
+// Core 0: ein Scan wurde abgeschlossen
+// Parameter published: false, wenn der Scan-Ring voll war (alle Zeichen gelten als verworfen)
+// Parameter len: Anzahl Zeichen des Scans
+void scan_stats_scan(bool published, uint8_t len);
+
+// Core 1: trägt eine gemessene Latenz ein
+void scan_stats_record(scan_lat_t which, uint32_t us);
+
+// Liefert eine Kopie aller Zähler
+void scan_stats_get(scan_stats_t* out);
+
+// Formatiert Zeile 'line' des Dumps (ohne Zeilenumbruch)
+// Zeile 0: Zähler, Zeilen 1..SCAN_LAT_COUNT: Histogramme
+// Rückgabe: false, wenn es die Zeile nicht gibt
+bool scan_stats_format_line(const scan_stats_t* st, unsigned line, char* buf, size_t cap);
@@ -0,0 +1,395 @@
+"""
+Lastmessung für mysql_bridge.py mit simulierten CH9121-Modulen
+
+Startet den Zwischenserver als eigenen Prozess und öffnet N gleichzeitige
+TCP-Verbindungen, die wie die Firmware SCANS-Rahmen senden (net_frame.py): jede
+Verbindung ist ein Gerät mit eigener device_id, fortlaufenden Scan-Nummern und fester
+Rate. Gemessen werden pro Scan
+
+    ack     Senden -> ACK (Scan im Spool gesichert)
+    commit  Senden -> Commit in MySQL (Hintergrund-Thread des Zwischenservers)
+
+und daraus Zeilen/s sowie p50/p99/p999. Als Datenbank dient entweder ein Ersatz im
+Prozess des Zwischenservers (--db stub, Commit-Dauer über --commit-ms/--row-us) oder
+die lokale MySQL-Datenbank aus MYSQL_CONFIG (--db mysql; die Zeilen bleiben in der
+Tabelle, device_id ab --device-base). Die Commit-Zeitpunkte schreibt eine Hülle um
+mysql.connector im Zwischenserver mit; beide Prozesse nutzen dieselbe monotone Uhr.
+
+Aufruf (im Projektordner):
+    python tools/bridge_bench.py --clients 100 --rate 20 --batch 4 --duration 10
+    python tools/bridge_bench.py --clients 10 --rate 500 --batch 16 --db mysql --json run1.json
+"""
+
+import argparse
+import asyncio
+import collections
+import json
+import os
+import random
+import socket
+import subprocess
+import sys
+import tempfile
+import time
+
+FW_DIR = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+sys.path.insert(0, FW_DIR)
+
+import net_frame  # noqa: E402
+
+# Code-Längen wie der Lastgenerator in pico-ethernet/main.c (Gewicht, Länge, nur Ziffern)
+CODE_MIX = [(55, 13, True), (10, 8, True), (15, 12, True), (5, 14, True), (10, 20, False), (5, 40, False)]
+ALNUM = "0123456789ABCDEFGHIJKLMNOPQRSTUVWXYZ-"
+
+
+def make_code(rng, mix):
+    weight, length, digits = CODE_MIX[0]
+    if mix:
+        weight, length, digits = rng.choices(CODE_MIX, weights=[c[0] for c in CODE_MIX])[0]
+    if digits:
+        return "".join(rng.choice("0123456789") for _ in range(length))
+    return "".join(rng.choice(ALNUM) for _ in range(length))
+
+
+def encode_scans(device_id, boot, t_send_ms, first_seq, codes):
+    """SCANS-Rahmen wie net_batch_finish() (Alter 0, Scanner 1); mehrere, wenn die Codes
+    nicht in PAYLOAD_MAX passen."""
+    frames = b""
+    body, count = bytearray(), 0
+    for i, code in enumerate(codes):
+        if code.isdigit():
+            record = bytes([0, 1, 0x80 | len(code)]) + bytes.fromhex(code + ("f" if len(code) % 2 else ""))
+        else:
+            record = bytes([0, 1, len(code)]) + code.encode("ascii")
+        if count and net_frame.SCANS_HEAD.size + len(body) + len(record) > net_frame.PAYLOAD_MAX:
+            head = net_frame.SCANS_HEAD.pack(device_id, boot, t_send_ms & 0xFFFFFFFF, first_seq + i - count, count)
+            frames += net_frame.encode(net_frame.SCANS, head + bytes(body))
+            body, count = bytearray(), 0
+        body += record
+        count += 1
+    head = net_frame.SCANS_HEAD.pack(device_id, boot, t_send_ms & 0xFFFFFFFF, first_seq + len(codes) - count, count)
+    return frames + net_frame.encode(net_frame.SCANS, head + bytes(body))
+
+
+# ---------------------------------------------------------------------------
+# Zwischenserver-Prozess (--child): Datenbank ersetzen bzw. umhüllen, dann starten
+# ---------------------------------------------------------------------------
+
+class CommitLog:
+    """Schreibt pro Commit "t_ns device_id boot seq ..." aller Zeilen in eine Datei."""
+
+    def __init__(self, path):
+        self.file = open(path, "w", buffering=1 << 16)
+
+    def write(self, rows):
+        t = time.monotonic_ns()
+        for device_id, boot, seq in rows:
+            self.file.write(f"{t} {device_id} {boot} {seq}\n")
+        self.file.flush()
+
+
+def install_db(kind, commit_log, commit_ms, row_us):
+    """Ersetzt mysql.connector (stub) oder hängt die Commit-Protokollierung an (mysql)."""
+    import types
+
+    if kind == "stub":
+        mysql = types.ModuleType("mysql")
+        connector = types.ModuleType("mysql.connector")
+
+        class Error(Exception):
+            pass
+
+        connector.Error = Error
+        mysql.connector = connector
+        sys.modules["mysql"] = mysql
+        sys.modules["mysql.connector"] = connector
+
+        class Cursor:
+            def __init__(self, conn):
+                self.conn = conn
+
+            def execute(self, sql, params=()):
+                if sql.startswith("INSERT"):
+                    self.conn.pending += len(params) // 7
+                self.result = (None,)
+
+            def fetchone(self):
+                return self.result
+
+        class Conn:
+            autocommit = False
+
+            def __init__(self):
+                self.pending = 0
+
+            def cursor(self):
+                return Cursor(self)
+
+            def commit(self):
+                # Dauer eines InnoDB-Commits: fester Anteil (fsync) plus pro Zeile
+                time.sleep((commit_ms * 1000 + row_us * self.pending) / 1e6)
+                self.pending = 0
+
+            def rollback(self):
+                self.pending = 0
+
+            def close(self):
+                pass
+
+        connector.connect = lambda **kw: Conn()
+
+    import mysql.connector
+
+    # Hülle: Schlüssel der eingefügten Zeilen merken, beim Commit protokollieren
+    connect = mysql.connector.connect
+
+    class CursorWrap:
+        def __init__(self, cursor, owner):
+            self.cursor, self.owner = cursor, owner
+
+        def execute(self, sql, params=()):
+            self.cursor.execute(sql, params)
+            if sql.startswith("INSERT"):
+                # Spalten wie INSERT_COLUMNS: barcode, timestamp, device_id, boot, seq, ...
+                self.owner.rows += [tuple(params[i + 2:i + 5]) for i in range(0, len(params), 7)]
+
+        def __getattr__(self, name):
+            return getattr(self.cursor, name)
+
+    class ConnWrap:
+        def __init__(self, conn):
+            self.conn, self.rows = conn, []
+
+        def cursor(self):
+            return CursorWrap(self.conn.cursor(), self)
+
+        def commit(self):
+            self.conn.commit()
+            commit_log.write(self.rows)
+            self.rows = []
+
+        def rollback(self):
+            self.rows = []
+            self.conn.rollback()
+
+        def __setattr__(self, name, value):
+            if name in ("conn", "rows"):
+                object.__setattr__(self, name, value)
+            else:
+                setattr(self.conn, name, value)
+
+        def __getattr__(self, name):
+            return getattr(self.conn, name)
+
+    mysql.connector.connect = lambda **kw: ConnWrap(connect(**kw))
+
+
+def run_child(args):
+    import runpy
+
+    install_db(args.db, CommitLog(args.commit_log), args.commit_ms, args.row_us)
+    sys.path.insert(0, FW_DIR)
+    sys.argv = ["mysql_bridge.py", "--port", str(args.port), "--spool", args.spool, "--quiet"]
+    runpy.run_path(os.path.join(FW_DIR, "mysql_bridge.py"), run_name="__main__")
+
+
+# ---------------------------------------------------------------------------
+# Simulierte Module
+# ---------------------------------------------------------------------------
+
+class Client:
+    """Ein Gerät: sendet alle batch/rate Sekunden einen Rahmen mit batch Scans."""
+
+    def __init__(self, index, args, codes, sent, acked):
+        self.device_id = args.device_base + index
+        self.boot = random.randrange(0x10000)
+        self.args = args
+        self.rng = random.Random(index)
+        self.codes = codes
+        self.sent = sent        # (device_id, boot, seq) -> Sendezeitpunkt (ns)
+        self.acked = acked      # Liste der ACK-Latenzen (ns)
+        self.seq = 0
+        self.next_ack = 0
+        self.pending = collections.deque()  # (end_seq, Sendezeitpunkt) unbestätigter Rahmen
+
+    async def run(self, port, t_start, t_end):
+        reader, writer = await asyncio.open_connection("127.0.0.1", port)
+        receiver = asyncio.create_task(self.receive(reader))
+        interval = self.args.batch / self.args.rate
+        # Versetzter Start, damit nicht alle Verbindungen gleichzeitig senden
+        t_next = t_start + self.rng.random() * interval
+        while True:
+            now = time.monotonic()
+            if t_next >= t_end:
+                break
+            if t_next > now:
+                await asyncio.sleep(t_next - now)
+            codes = [self.codes[self.rng.randrange(len(self.codes))] for _ in range(self.args.batch)]
+            t_ns = time.monotonic_ns()
+            writer.write(encode_scans(self.device_id, self.boot, t_ns // 1000000, self.seq, codes))
+            for i in range(self.args.batch):
+                self.sent[(self.device_id, self.boot, self.seq + i)] = t_ns
+            self.seq += self.args.batch
+            self.pending.append((self.seq, t_ns))
+            t_next += interval
+        await writer.drain()
+        # Auf die restlichen ACKs warten
+        deadline = time.monotonic() + self.args.settle
+        while self.next_ack < self.seq and time.monotonic() < deadline:
+            await asyncio.sleep(0.01)
+        receiver.cancel()
+        writer.close()
+
+    async def receive(self, reader):
+        decoder = net_frame.Decoder()
+        while True:
+            data = await reader.read(4096)
+            if not data:
+                return
+            t_ns = time.monotonic_ns()
+            for ftype, payload in decoder.feed(data):
+                if ftype != net_frame.ACK:
+                    continue
+                _, _, next_seq = net_frame.ACK_BODY.unpack(payload)
+                while self.pending and self.pending[0][0] <= next_seq:
+                    end_seq, t_send = self.pending.popleft()
+                    start = end_seq - self.args.batch
+                    self.acked += [t_ns - t_send] * (end_seq - max(start, self.next_ack))
+                self.next_ack = max(self.next_ack, next_seq)
+
+
+def percentiles(values_ns):
+    """Liefert (p50, p99, p999, max) in ms."""
+    if not values_ns:
+        return (0.0, 0.0, 0.0, 0.0)
+    v = sorted(values_ns)
+
+    def q(p):
+        return v[min(len(v) - 1, int(p * len(v)))] / 1e6
+    return (q(0.50), q(0.99), q(0.999), v[-1] / 1e6)
+
+
+async def run_clients(args, port):
+    sent, acked = {}, []
+    # Vorrat an Codes: das Erzeugen pro Scan würde den Messtreiber selbst ausbremsen
+    rng = random.Random(0)
+    codes = [make_code(rng, args.mix) for _ in range(4096)]
+    clients = [Client(i, args, codes, sent, acked) for i in range(args.clients)]
+    t_start = time.monotonic() + 0.2
+    t_end = t_start + args.duration
+    await asyncio.gather(*(c.run(port, t_start, t_end) for c in clients))
+    return sent, acked, t_start, t_end
+
+
+def wait_listening(port, proc, timeout=10.0):
+    deadline = time.monotonic() + timeout
+    while time.monotonic() < deadline:
+        if proc.poll() is not None:
+            return False
+        try:
+            socket.create_connection(("127.0.0.1", port), timeout=0.2).close()
+            return True
+        except OSError:
+            time.sleep(0.05)
+    return False
+
+
+def free_port():
+    with socket.socket() as s:
+        s.bind(("127.0.0.1", 0))
+        return s.getsockname()[1]
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Lastmessung für mysql_bridge.py")
+    parser.add_argument("--clients", type=int, default=50, help="gleichzeitige Verbindungen (Geräte)")
+    parser.add_argument("--rate", type=float, default=20.0, help="Scans/s pro Verbindung")
+    parser.add_argument("--batch", type=int, default=1, choices=range(1, 17), metavar="1..16",
+                        help="Scans pro SCANS-Rahmen")
+    parser.add_argument("--duration", type=float, default=10.0, help="Sendedauer in s")
+    parser.add_argument("--settle", type=float, default=10.0, help="Wartezeit auf ACKs/Commits danach in s")
+    parser.add_argument("--mix", action=argparse.BooleanOptionalAction, default=True,
+                        help="Code-Längen gemischt (sonst nur EAN-13)")
+    parser.add_argument("--db", choices=("stub", "mysql"), default="stub", help="Datenbank")
+    parser.add_argument("--commit-ms", type=float, default=2.0, help="stub: feste Dauer eines Commits")
+    parser.add_argument("--row-us", type=float, default=5.0, help="stub: Dauer pro Zeile")
+    parser.add_argument("--device-base", type=lambda s: int(s, 0), default=0xBE000000,
+                        help="device_id der ersten Verbindung")
+    parser.add_argument("--json", help="Ergebnis zusätzlich als JSON in diese Datei")
+    # Intern: Zwischenserver-Prozess
+    parser.add_argument("--child", action="store_true", help=argparse.SUPPRESS)
+    parser.add_argument("--port", type=int, help=argparse.SUPPRESS)
+    parser.add_argument("--spool", help=argparse.SUPPRESS)
+    parser.add_argument("--commit-log", help=argparse.SUPPRESS)
+    args = parser.parse_args()
+
+    if args.child:
+        run_child(args)
+        return
+
+    work = tempfile.mkdtemp(prefix="bridge_bench_")
+    port = free_port()
+    commit_log = os.path.join(work, "commits.log")
+    bridge_log = open(os.path.join(work, "bridge.log"), "w")
+    proc = subprocess.Popen(
+        [sys.executable, os.path.abspath(__file__), "--child", "--db", args.db,
+         "--commit-ms", str(args.commit_ms), "--row-us", str(args.row_us), "--port", str(port),
+         "--spool", os.path.join(work, "spool"), "--commit-log", commit_log],
+        cwd=work, stdout=bridge_log, stderr=subprocess.STDOUT)
+    try:
+        if not wait_listening(port, proc):
+            sys.exit(f"Zwischenserver startet nicht, siehe {bridge_log.name}")
+        sent, acked, t_start, t_end = asyncio.run(run_clients(args, port))
+        # Auf die letzten Commits warten
+        deadline = time.monotonic() + args.settle
+        committed = {}
+        while time.monotonic() < deadline:
+            with open(commit_log) as f:
+                for line in f:
+                    t, device_id, boot, seq = map(int, line.split())
+                    committed.setdefault((device_id, boot, seq), t)
+            if len(committed) >= len(sent):
+                break
+            time.sleep(0.2)
+    finally:
+        proc.terminate()
+        _, _, usage = os.wait4(proc.pid, 0)
+
+    commit_lat = [committed[k] - t for k, t in sent.items() if k in committed]
+    t_first = min(sent.values()) if sent else 0
+    t_last = max(committed.values()) if committed else t_first
+    span_s = max((t_last - t_first) / 1e9, 1e-9)
+    result = {
+        "clients": args.clients, "rate": args.rate, "batch": args.batch, "duration": args.duration,
+        "db": args.db, "mix": args.mix,
+        "offered_rows_s": args.clients * args.rate,
+        "sent": len(sent), "acked": len(acked), "committed": len(commit_lat),
+        "sent_rows_s": len(sent) / (t_end - t_start),
+        "committed_rows_s": len(commit_lat) / span_s,
+        "bridge_cpu_s": usage.ru_utime + usage.ru_stime,
+        "driver_cpu_s": time.process_time(),
+        "ack_ms": dict(zip(("p50", "p99", "p999", "max"), percentiles(acked))),
+        "commit_ms": dict(zip(("p50", "p99", "p999", "max"), percentiles(commit_lat))),
+    }
+
+    print(f"{args.clients} Verbindungen x {args.rate:g} Scans/s, {args.batch} pro Rahmen, "
+          f"{args.duration:g} s, DB {args.db}")
+    print(f"  gesendet {result['sent']} ({result['sent_rows_s']:.0f}/s, angeboten "
+          f"{result['offered_rows_s']:.0f}/s), bestätigt {result['acked']}, gespeichert {result['committed']} "
+          f"({result['committed_rows_s']:.0f} Zeilen/s)")
+    for name in ("ack", "commit"):
+        p = result[f"{name}_ms"]
+        print(f"  {name:6s} p50 {p['p50']:7.2f} ms  p99 {p['p99']:7.2f} ms  p999 {p['p999']:7.2f} ms  "
+              f"max {p['max']:7.2f} ms")
+    # Läuft einer der Prozesse dauerhaft am Anschlag, misst der Lauf dessen Grenze
+    print(f"  CPU Zwischenserver {result['bridge_cpu_s']:.1f} s, Messtreiber {result['driver_cpu_s']:.1f} s "
+          f"(Sendedauer {args.duration:g} s)")
+    if result["committed"] < result["sent"]:
+        print(f"  {result['sent'] - result['committed']} Scans nicht gespeichert, siehe {bridge_log.name}")
+    if args.json:
+        with open(args.json, "w") as f:
+            json.dump(result, f, indent=2)
+
+
+if __name__ == "__main__":
+    main()
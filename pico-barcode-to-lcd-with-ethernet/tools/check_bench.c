@@ -0,0 +1,97 @@
+// Host-Benchmark: Kosten der Prüfzeichen-Kontrolle (scan_check.h) pro Scan
+//
+// Gemischter Verkehr aus EAN-13, EAN-8, UPC-A, ITF-14 und Code 128 (aktiviert), jeweils zur
+// Hälfte mit falschem Prüfzeichen. Zum Vergleich: die Dekodierung der Zeichen desselben Scans
+// über die Keycode-Tabelle (keymap.h), die ohnehin für jeden Scan anfällt.
+//
+// Bauen und ausführen (ohne Pico SDK, im Projektordner):
+//   python tools/gen_keymap.py --layout US --out /tmp/keymap_table.c
+//   cc -O2 -I. tools/check_bench.c scan_check.c /tmp/keymap_table.c -o /tmp/check_bench && /tmp/check_bench
+
+#include "scan_check.h"
+#include "keymap.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define BENCH_SCANS  4096
+#define BENCH_ROUNDS 500
+
+static char codes[BENCH_SCANS][16];
+static uint8_t lens[BENCH_SCANS];
+
+static double now_s(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+// Zufällige Ziffern mit GTIN-Prüfziffer (Modulo 10, Gewichte 3/1 von rechts)
+static void make_gtin(char* out, unsigned len) {
+    unsigned sum = 0;
+    for (unsigned i = 0; i + 1 < len; ++i) {
+        out[i] = (char)('0' + rand() % 10);
+        sum += ((len - i) & 1u) ? (unsigned)(out[i] - '0') : 3u * (unsigned)(out[i] - '0');
+    }
+    out[len - 1] = (char)('0' + (10u - sum % 10u) % 10u);
+}
+
+// Zufällige Großbuchstaben und Ziffern mit Code-128-Prüfzeichen (Zeichensatz B)
+static void make_code128(char* out, unsigned len) {
+    static const char set[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZ0123456789";
+    unsigned sum = 104;
+    for (unsigned i = 0; i + 1 < len; ++i) {
+        out[i] = set[rand() % (int)(sizeof(set) - 1)];
+        sum += (i + 1) * (unsigned)(out[i] - 32);
+    }
+    out[len - 1] = (char)(32 + sum % 103u);
+}
+
+int main(void) {
+    static const uint8_t gtin_lens[] = { 13, 13, 13, 8, 12, 14 };
+    static uint8_t keys[BENCH_SCANS][16];
+
+    scan_check_set_action(SCAN_SYM_CODE128, SCAN_CHECK_FLAG);
+    srand(1);
+    for (unsigned i = 0; i < BENCH_SCANS; ++i) {
+        unsigned const kind = (unsigned)rand() % (sizeof(gtin_lens) + 1);
+        if (kind < sizeof(gtin_lens)) {
+            lens[i] = gtin_lens[kind];
+            make_gtin(codes[i], lens[i]);
+        } else {
+            lens[i] = 10;
+            make_code128(codes[i], lens[i]);
+        }
+        // Jeder zweite Scan mit falschem Prüfzeichen
+        if (rand() & 1) codes[i][lens[i] - 1] = codes[i][lens[i] - 1] == '1' ? '2' : '1';
+        for (unsigned k = 0; k < lens[i]; ++k) keys[i][k] = (uint8_t)(0x04 + rand() % (0x27 - 0x04 + 1));
+    }
+
+    unsigned bad = 0, sum_keys = 0;
+    double t0 = now_s();
+    for (int r = 0; r < BENCH_ROUNDS; ++r) {
+        for (unsigned i = 0; i < BENCH_SCANS; ++i) bad += scan_check_code(codes[i], lens[i]) != SCAN_CHECK_OFF;
+        __asm__ volatile("" : "+r"(bad));
+    }
+    double t1 = now_s();
+    for (int r = 0; r < BENCH_ROUNDS; ++r) {
+        for (unsigned i = 0; i < BENCH_SCANS; ++i) {
+            for (unsigned k = 0; k < lens[i]; ++k) sum_keys += keymap_decode(0, keys[i][k]);
+        }
+        __asm__ volatile("" : "+r"(sum_keys));
+    }
+    double t2 = now_s();
+
+    scan_check_stats_t st;
+    scan_check_get_stats(&st);
+    double const n = (double)BENCH_SCANS * BENCH_ROUNDS;
+    printf("%.0f Scans, davon %.1f%% mit falschem Prüfzeichen erkannt\n", n, 100.0 * bad / n);
+    for (unsigned i = 0; i < SCAN_SYM_COUNT; ++i) {
+        printf("  %-6s geprüft=%lu ungültig=%lu\n", scan_check_name((scan_sym_t)i), (unsigned long)st.checked[i],
+               (unsigned long)st.invalid[i]);
+    }
+    printf("  Prüfung:              %8.1f ns/Scan\n", (t1 - t0) / n * 1e9);
+    printf("  Keycode-Dekodierung:  %8.1f ns/Scan\n", (t2 - t1) / n * 1e9);
+    return 0;
+}
@@ -0,0 +1,177 @@
+"""
+Erzeugt die flache Keycode -> ASCII Tabelle (keymap_table.c) für ein Tastaturlayout.
+
+Aufruf (normalerweise durch CMake):
+    python gen_keymap.py --layout DE --out build/keymap_table.c
+
+Die Tabelle hat 4 Ebenen à 256 Keycodes (ohne Modifier, Shift, AltGr, Shift + AltGr),
+siehe keymap.h. Zeichen außerhalb von ASCII (ä, ö, ü, ß, §, €, ...) werden als 0
+eingetragen, da die Firmware nur druckbares ASCII in Barcodes übernimmt.
+"""
+
+import argparse
+import string
+
+PLANES = 4
+KEYCODES = 256
+
+
+def us_layout():
+    """US-Layout, entspricht HID_KEYCODE_TO_ASCII aus TinyUSB."""
+    base = {}
+    shift = {}
+
+    for i, c in enumerate(string.ascii_lowercase):
+        base[0x04 + i] = c
+        shift[0x04 + i] = c.upper()
+
+    for i, (c, s) in enumerate(zip("1234567890", "!@#$%^&*()")):
+        base[0x1E + i] = c
+        shift[0x1E + i] = s
+
+    for code, c, s in [
+        (0x28, "\r", "\r"), (0x29, "\x1b", "\x1b"), (0x2A, "\b", "\b"), (0x2B, "\t", "\t"),
+        (0x2C, " ", " "), (0x2D, "-", "_"), (0x2E, "=", "+"), (0x2F, "[", "{"),
+        (0x30, "]", "}"), (0x31, "\\", "|"), (0x32, "#", "~"), (0x33, ";", ":"),
+        (0x34, "'", "\""), (0x35, "`", "~"), (0x36, ",", "<"), (0x37, ".", ">"),
+        (0x38, "/", "?"),
+    ]:
+        base[code] = c
+        shift[code] = s
+
+    # Ziffernblock (Shift liefert bei den Ziffern kein Zeichen)
+    for code, c in [(0x54, "/"), (0x55, "*"), (0x56, "-"), (0x57, "+"), (0x58, "\r"), (0x67, "=")]:
+        base[code] = c
+        shift[code] = c
+    for i, c in enumerate("1234567890."):
+        base[0x59 + i] = c
+
+    # Kein AltGr im US-Layout: wie bisher wird Alt ignoriert
+    return base, shift, dict(base), dict(shift)
+
+
+def de_layout():
+    """Deutsches QWERTZ-Layout (ISO)."""
+    base, shift, _, _ = us_layout()
+    altgr = {}
+
+    # Y und Z sind vertauscht
+    base[0x1C], base[0x1D] = "z", "y"
+    shift[0x1C], shift[0x1D] = "Z", "Y"
+
+    # Ziffernreihe: Shift-Ebene ('§' ist kein ASCII)
+    for i, s in enumerate(["!", "\"", None, "$", "%", "&", "/", "(", ")", "="]):
+        shift[0x1E + i] = s
+
+    # Sonderzeichen-Tasten (None = kein ASCII bzw. Tottaste)
+    for code, c, s, a in [
+        (0x2D, None, "?", "\\"),   # ß ? \
+        (0x2E, None, None, None),  # ´ ` (Tottasten)
+        (0x2F, None, None, None),  # ü Ü
+        (0x30, "+", "*", "~"),
+        (0x31, "#", "'", None),    # wie 0x32 (Non-US #)
+        (0x32, "#", "'", None),
+        (0x33, None, None, None),  # ö Ö
+        (0x34, None, None, None),  # ä Ä
+        (0x35, "^", None, None),   # ^ °
+        (0x36, ",", ";", None),
+        (0x37, ".", ":", None),
+        (0x38, "-", "_", None),
+        (0x64, "<", ">", "|"),     # Non-US \\ und |
+    ]:
+        base[code] = c
+        shift[code] = s
+        if a:
+            altgr[code] = a
+
+    # AltGr-Ebene
+    altgr[0x14] = "@"    # q
+    altgr[0x24] = "{"    # 7
+    altgr[0x25] = "["    # 8
+    altgr[0x26] = "]"    # 9
+    altgr[0x27] = "}"    # 0
+
+    # Dezimaltrenner des Ziffernblocks
+    base[0x63] = ","
+
+    # Steuerzeichen bleiben mit AltGr erhalten (z.B. Enter als Terminator)
+    for code in (0x28, 0x29, 0x2A, 0x2B, 0x2C, 0x58):
+        altgr.setdefault(code, base[code])
+
+    return base, shift, altgr, dict(altgr)
+
+
+LAYOUTS = {
+    "US": us_layout,
+    "DE": de_layout,
+}
+
+
+def build_table(layout):
+    planes = LAYOUTS[layout]()
+    table = [0] * (PLANES * KEYCODES)
+    for p, plane in enumerate(planes):
+        for code, c in plane.items():
+            if c is not None:
+                table[p * KEYCODES + code] = ord(c)
+    return table
+
+
+def plane_offset(modifier):
+    """Ebenen-Offset für ein Modifier-Byte (siehe keymap.h)."""
+    shift = bool(modifier & (0x02 | 0x20))
+    altgr = bool(modifier & 0x40) or (modifier & 0x05) == 0x05
+    return ((2 if altgr else 0) + (1 if shift else 0)) * KEYCODES
+
+
+def c_char(v):
+    if v == 0:
+        return "0"
+    c = chr(v)
+    if c == "\\":
+        return "'\\\\'"
+    if c == "'":
+        return "'\\''"
+    if 32 <= v <= 126:
+        return f"'{c}'"
+    return f"0x{v:02x}"
+
+
+def render(layout, table):
+    plane_names = ["ohne Modifier", "Shift", "AltGr", "Shift + AltGr"]
+    out = [
+        f"// Automatisch erzeugt von tools/gen_keymap.py (Layout {layout}) - nicht bearbeiten",
+        "",
+        "#include \"keymap.h\"",
+        "",
+        f"const char keymap_layout[] = \"{layout}\";",
+        "",
+        "uint8_t keymap_table[KEYMAP_PLANES * KEYMAP_KEYCODES] = {",
+    ]
+    for p in range(PLANES):
+        out.append(f"    // Ebene {p}: {plane_names[p]}")
+        for row in range(0, KEYCODES, 8):
+            cells = ", ".join(f"{c_char(table[p * KEYCODES + row + i]):>6}" for i in range(8))
+            out.append(f"    {cells}, /* 0x{row:02X} */")
+    out.append("};")
+    out.append("")
+    out.append("uint16_t keymap_plane_offset[256] = {")
+    for row in range(0, 256, 16):
+        cells = ", ".join(f"{plane_offset(row + i):>3}" for i in range(16))
+        out.append(f"    {cells}, /* 0x{row:02X} */")
+    out.append("};")
+    return "\n".join(out) + "\n"
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Erzeugt keymap_table.c")
+    parser.add_argument("--layout", default="DE", choices=sorted(LAYOUTS))
+    parser.add_argument("--out", required=True)
+    args = parser.parse_args()
+
+    with open(args.out, "w", newline="\n") as f:
+        f.write(render(args.layout, build_table(args.layout)))
+
+
+if __name__ == "__main__":
+    main()
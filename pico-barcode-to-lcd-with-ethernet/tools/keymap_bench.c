@@ -0,0 +1,64 @@
+// Host-Benchmark: Keycode-Dekodierung alt (2D-Tabelle + Shift-Verzweigung) gegen
+// die flache, verzweigungsfreie Tabelle aus keymap.h
+//
+// Bauen und ausführen (ohne Pico SDK, im Projektordner):
+//   python tools/gen_keymap.py --layout US --out /tmp/keymap_table.c
+//   cc -O2 -I. tools/keymap_bench.c /tmp/keymap_table.c -o /tmp/keymap_bench && /tmp/keymap_bench
+
+#include "keymap.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#define BENCH_KEYS   (1u << 16)
+#define BENCH_ROUNDS 2000
+
+// Alte Tabelle im Format von HID_KEYCODE_TO_ASCII, aus Ebene 0/1 der neuen befüllt
+static uint8_t keycode2ascii[128][2];
+
+static double now_s(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+int main(void) {
+    static uint8_t mods[BENCH_KEYS], codes[BENCH_KEYS];
+
+    for (int k = 0; k < 128; ++k) {
+        keycode2ascii[k][0] = keymap_table[k];
+        keycode2ascii[k][1] = keymap_table[KEYMAP_KEYCODES + k];
+    }
+
+    // Typischer Barcode-Verkehr: Ziffern, Buchstaben, teils mit Shift
+    srand(1);
+    for (unsigned i = 0; i < BENCH_KEYS; ++i) {
+        codes[i] = (uint8_t)(0x04 + rand() % (0x27 - 0x04 + 1));
+        mods[i] = (rand() & 1) ? 0x02 : 0x00;
+    }
+
+    unsigned sum_old = 0, sum_new = 0;
+    double t0 = now_s();
+    for (int r = 0; r < BENCH_ROUNDS; ++r) {
+        for (unsigned i = 0; i < BENCH_KEYS; ++i) {
+            uint8_t const m = mods[i];
+            int const is_shift = m & (0x02 | 0x20);
+            sum_old += keycode2ascii[codes[i]][is_shift ? 1 : 0];
+        }
+        __asm__ volatile("" : "+r"(sum_old));
+    }
+    double t1 = now_s();
+    for (int r = 0; r < BENCH_ROUNDS; ++r) {
+        for (unsigned i = 0; i < BENCH_KEYS; ++i) {
+            sum_new += keymap_decode(mods[i], codes[i]);
+        }
+        __asm__ volatile("" : "+r"(sum_new));
+    }
+    double t2 = now_s();
+
+    double const n = (double)BENCH_KEYS * BENCH_ROUNDS;
+    printf("Layout %s, %.0f Zeichen\n", keymap_layout, n);
+    printf("  alt (2D + Shift-Verzweigung): %8.1f MZeichen/s\n", n / (t1 - t0) / 1e6);
+    printf("  neu (flach, verzweigungsfrei): %8.1f MZeichen/s\n", n / (t2 - t1) / 1e6);
+    return sum_old == sum_new ? 0 : 1;
+}
@@ -1,52 +1,119 @@
 /*****************************************************************************
- * CH9121 IP Configuration & Communication Tool
- * 
+ * CH9121 Load Generator
+ *
  * This program:
  * 1. Configures CH9121 Ethernet module (settings saved to EEPROM)
- * 2. Sends continuous status messages to console and network partners
- * 
+ * 2. Sends synthetic barcode scans as SCANS frames (net_frame.h) to
+ *    mysql_bridge.py, following a selectable load profile
+ * 3. Reports achieved send rate, UART stalls and ACK round-trip times
+ *    once per second on the USB console
+ *
  * HOW TO USE:
- * 1. Edit the IP configuration values below
- * 2. Compile and flash to Pico
- * 3. Run once - CH9121 is configured and starts sending data
- * 
+ * 1. Edit the IP configuration values below (target = PC running mysql_bridge.py)
+ * 2. Choose profile and rates via the LOAD_* defines (or -D at build time)
+ * 3. Compile and flash to Pico, open the USB console
+ * 4. Console keys: c = constant, b = bursts, r = ramp,
+ *                  + / - = double / halve the rate, m = code mix on/off
+ *
  *****************************************************************************/
 
 #include <stdio.h>
+#include <string.h>
 #include "pico/stdlib.h"
+#include "pico/rand.h"
 #include "hardware/uart.h"
 #include "CH9121.h"
+#include "net_frame.h"
 
-// UART1 is used for data communication with CH9121 (network traffic)
+// UART0 is used for data communication with CH9121 (network traffic)
 #define UART_ID0        uart0
 #define UART_TX_PIN0    0
 #define UART_RX_PIN0    1
-#define DATA_BAUD_RATE  115200  // Must match CH9121 baud rate config
 
 
 // **************************************************************************************************************** //
 
-// Verbindet sich als TCP-Client mit einem Python-Zwischenserver (IP-Adresse des PCs)
-// Der Python-Server kommuniziert dann mit der MySQL-Datenbank
+// Verbindet sich als TCP-Client mit dem Python-Zwischenserver (mysql_bridge.py aus
+// pico-barcode-to-lcd-with-ethernet) und sendet ihm künstliche Scans im selben
+// Rahmenformat wie die Scanner-Firmware. Die Bestätigungen (ACK) des Servers liefern
+// die Umlaufzeit Pico -> CH9121 -> Server (Spool) -> CH9121 -> Pico.
 
 // **************************************************************************************************************** //
 
 
 // ============================================================================
-// CH9121 CONFIGURATION - CHANGE THESE VALUES AS NEEDED
+// LOAD CONFIGURATION - CHANGE THESE VALUES AS NEEDED
 // ============================================================================
 
-/*
- 0: TCP-Server, der CH9121 wartet auf eingehende Verbindung auf dem localport. Empfängt Daten.
- Beispiel: telnet [eth.localip] [eth.u0localport]
+// Lastprofile
+typedef enum {
+    LOAD_CONSTANT = 0,  // LOAD_RATE Scans/s gleichmäßig
+    LOAD_BURST,         // Alle LOAD_BURST_PERIOD_MS ein Stoß aus LOAD_BURST_SCANS Scans
+    LOAD_RAMP,          // Rate steigt in LOAD_RAMP_MS linear von LOAD_RAMP_FROM auf LOAD_RATE, dann von vorn
+    LOAD_PROFILE_COUNT
+} load_profile_t;
+
+#ifndef LOAD_PROFILE
+#define LOAD_PROFILE LOAD_CONSTANT
+#endif
+
+// Scans pro Sekunde (LOAD_CONSTANT, Endrate von LOAD_RAMP)
+#ifndef LOAD_RATE
+#define LOAD_RATE 100
+#endif
+
+#ifndef LOAD_BURST_SCANS
+#define LOAD_BURST_SCANS 50
+#endif
+#ifndef LOAD_BURST_PERIOD_MS
+#define LOAD_BURST_PERIOD_MS 1000
+#endif
+
+#ifndef LOAD_RAMP_FROM
+#define LOAD_RAMP_FROM 10
+#endif
+#ifndef LOAD_RAMP_MS
+#define LOAD_RAMP_MS 60000
+#endif
+
+// Code-Längen: 1 = realistische Mischung (k_load_codes), 0 = nur EAN-13
+#ifndef LOAD_CODE_MIX
+#define LOAD_CODE_MIX 1
+#endif
+
+// Scans höchstens so lange sammeln, bevor ihr Rahmen gesendet wird (wie net_tx.h)
+#ifndef LOAD_BATCH_MS
+#define LOAD_BATCH_MS 5
+#endif
 
- 1: TCP-Client, der CH9121 verbindet sich mit dem angegebenen Server. Versendet Daten.
- Beispiel: mit tcp_server.py
+// Höchstens so viele unbestätigte Rahmen unterwegs (Sendefenster)
+#ifndef LOAD_WINDOW
+#define LOAD_WINDOW 32
+#endif
 
- 2: UDP-Server, der CH9121 empfängt UDP-Pakete über localport.
+// So lange ohne Fortschritt der Bestätigungen: mit neuem Startwert (boot) neu beginnen
+#ifndef LOAD_ACK_TIMEOUT_MS
+#define LOAD_ACK_TIMEOUT_MS 3000
+#endif
 
- 3: UDP-Client, der CH9121 versendet einfach ohne Verbindungsaufbau Daten an einen angegebenen Port.
-*/
+// Abstand der Ausgaben auf der Konsole
+#ifndef LOAD_REPORT_MS
+#define LOAD_REPORT_MS 1000
+#endif
+
+// Geräte-ID in den Rahmen (getrennt von echten Geräten auswertbar)
+#ifndef LOAD_DEVICE_ID
+#define LOAD_DEVICE_ID 0x10AD0001u
+#endif
+
+// UART-Baudrate zwischen Pico und CH9121 (bis 921600); begrenzt die erreichbare Rate
+#ifndef LOAD_BAUD
+#define LOAD_BAUD 115200
+#endif
+
+// ============================================================================
+// CH9121 CONFIGURATION - CHANGE THESE VALUES AS NEEDED
+// ============================================================================
 
 // Für Python-Zwischenserver (der dann mit MySQL kommuniziert)
 CH9121_Config ch9121_config = {
@@ -56,60 +123,413 @@ CH9121_Config ch9121_config = {
     .target_ip    = {192, 168, 0, 86},    // Python-Server IP (IP-Adresse des PCs)
     .local_port   = 4000,                 // Local Port
     .target_port  = 5000,                 // Python-Server Port
-    .baud_rate    = 115200,               // UART Baud Rate
+    .baud_rate    = LOAD_BAUD,            // UART Baud Rate
     .mode         = TCP_CLIENT            // TCP Client
 };
 
+// ============================================================================
+// SYNTHETIC CODES
+// ============================================================================
+
+// Verteilung der Code-Längen (Gewichte in Prozent), angelehnt an Handel und Lager
+typedef struct {
+    uint8_t weight;
+    uint8_t len;
+    bool digits;        // Nur Ziffern (GS1-Prüfziffer am Ende), sonst alphanumerisch
+} load_code_t;
+
+static const load_code_t k_load_codes[] = {
+    { 55, 13, true  },  // EAN-13
+    { 10,  8, true  },  // EAN-8
+    { 15, 12, true  },  // UPC-A
+    {  5, 14, true  },  // ITF-14
+    { 10, 20, false },  // Code 128 (Seriennummern, Lagerplätze)
+    {  5, 40, false },  // Lange Code-128-Etiketten
+};
+
+static uint32_t g_rng;
+
+// xorshift32: schnell und ohne Bibliothek, Startwert aus get_rand_32()
+static uint32_t load_rand(void) {
+    g_rng ^= g_rng << 13;
+    g_rng ^= g_rng >> 17;
+    g_rng ^= g_rng << 5;
+    return g_rng;
+}
+
+// Erzeugt einen Code gemäß der Verteilung
+// Parameter out: Ziel (mind. 41 Zeichen)
+// Rückgabe: Länge
+static uint8_t load_make_code(char* out, bool mix) {
+    static const char alnum[] = "0123456789ABCDEFGHIJKLMNOPQRSTUVWXYZ-";
+    load_code_t const* c = &k_load_codes[0];
+
+    if (mix) {
+        uint32_t pick = load_rand() % 100u;
+        for (size_t i = 0; i < sizeof(k_load_codes) / sizeof(k_load_codes[0]); ++i) {
+            c = &k_load_codes[i];
+            if (pick < c->weight) break;
+            pick -= c->weight;
+        }
+    }
+    if (!c->digits) {
+        for (uint8_t i = 0; i < c->len; ++i) out[i] = alnum[load_rand() % (sizeof(alnum) - 1)];
+        return c->len;
+    }
+
+    // GS1-Prüfziffer: von rechts abwechselnd Gewicht 3 und 1
+    unsigned sum = 0;
+    for (uint8_t i = 0; i + 1 < c->len; ++i) {
+        out[i] = (char)('0' + load_rand() % 10u);
+        sum += (unsigned)(out[i] - '0') * (((c->len - 1 - i) & 1) ? 3u : 1u);
+    }
+    out[c->len - 1] = (char)('0' + (10u - sum % 10u) % 10u);
+    return c->len;
+}
+
+// ============================================================================
+// LOAD STATE AND STATISTICS
+// ============================================================================
+
+// Histogrammklassen der Umlaufzeit: Klasse i zählt Werte < (LOAD_HIST_BASE_US << i)
+#define LOAD_HIST_BUCKETS 16
+#define LOAD_HIST_BASE_US 64
+
+typedef struct {
+    uint32_t count;
+    uint32_t max_us;
+    uint32_t bucket[LOAD_HIST_BUCKETS];
+} load_hist_t;
+
+// Zähler eines Ausgabeintervalls
+typedef struct {
+    uint32_t scans;             // Erzeugte Scans
+    uint32_t frames;            // Gesendete Rahmen
+    uint32_t bytes;             // Über UART0 gesendete Bytes
+    uint32_t stalls;            // Sendewunsch bei voller TX-FIFO
+    uint32_t stall_us;          // Zeit mit voller TX-FIFO und wartenden Bytes
+    uint32_t window_full_us;    // Zeit, in der das Sendefenster voll war
+    uint32_t behind;            // Fällige Scans, die nicht erzeugt werden konnten (verworfen)
+    uint32_t acked;             // Bestätigte Scans
+    load_hist_t rtt;            // Rahmen fertig -> ACK
+} load_stats_t;
+
+// Ein unbestätigter Rahmen
+typedef struct {
+    uint32_t end_seq;           // Nummer nach dem letzten Scan
+    uint32_t t_us;              // Rahmen fertig (in den Sendepuffer gestellt)
+} load_inflight_t;
+
+static load_profile_t g_profile = LOAD_PROFILE;
+static uint32_t g_rate = LOAD_RATE;
+static bool g_mix = LOAD_CODE_MIX;
+
+static uint16_t g_boot;
+static uint32_t g_seq;
+static uint32_t g_acked_seq;        // Bestätigt bis hierher (ausschließlich)
+static uint32_t g_resyncs;
+static net_batch_t g_batch;
+static uint32_t g_batch_t_us;
+
+// Rahmen, der gerade über UART0 geht
+static uint8_t g_tx[NET_FRAME_OVERHEAD + NET_FRAME_PAYLOAD_MAX];
+static size_t g_tx_len;
+static size_t g_tx_pos;
+static bool g_stalled;
+static uint32_t g_t_stall;
+
+static load_inflight_t g_inflight[LOAD_WINDOW];
+static unsigned g_if_head;
+static unsigned g_if_count;
+static uint32_t g_t_progress;
+
+static load_stats_t g_stats;
+
+static const char* const k_profile_names[LOAD_PROFILE_COUNT] = { "konstant", "Stoesse", "Rampe" };
+
+static void load_hist_add(load_hist_t* h, uint32_t us) {
+    uint32_t const q = us / LOAD_HIST_BASE_US;
+    unsigned b = q ? 32u - (unsigned)__builtin_clz(q) : 0u;
+    if (b >= LOAD_HIST_BUCKETS) b = LOAD_HIST_BUCKETS - 1;
+    h->bucket[b]++;
+    h->count++;
+    if (us > h->max_us) h->max_us = us;
+}
+
+// Obergrenze der Klasse, in die das Quantil permille/1000 fällt
+static uint32_t load_hist_quantile(const load_hist_t* h, uint32_t permille) {
+    if (h->count == 0) return 0;
+    uint32_t const rank = (uint32_t)(((uint64_t)h->count * permille + 999u) / 1000u);
+    uint32_t seen = 0;
+    for (unsigned i = 0; i < LOAD_HIST_BUCKETS - 1; ++i) {
+        seen += h->bucket[i];
+        if (seen >= rank) return (uint32_t)LOAD_HIST_BASE_US << i;
+    }
+    return h->max_us;
+}
+
+// Beginnt mit neuem Startwert bei Scan-Nummer 0 (der Server sieht ein neues Gerät/Start)
+static void load_restart(void) {
+    g_boot = (uint16_t)load_rand();
+    g_seq = g_acked_seq = 0;
+    g_if_head = g_if_count = 0;
+    net_batch_begin(&g_batch, LOAD_DEVICE_ID, g_boot);
+    g_t_progress = time_us_32();
+}
+
+// ============================================================================
+// LOAD PROFILES
+// ============================================================================
+
+// Fällige Scans (in Millionstel Scan: Rate x Mikrosekunden, ohne Rundungsverlust bei
+// kurzen Schleifendurchläufen)
+#define LOAD_SCAN_UNITS 1000000u
+static uint64_t g_credit;
+static uint32_t g_t_gen;
+static uint32_t g_t_profile;
+static uint32_t g_burst_period = UINT32_MAX;   // Periode des letzten Stoßes
+
+static uint32_t load_due(uint32_t now) {
+    uint32_t const dt_us = now - g_t_gen;
+    uint32_t const since_ms = (now - g_t_profile) / 1000u;
+    g_t_gen = now;
+
+    switch (g_profile) {
+    case LOAD_CONSTANT:
+        g_credit += (uint64_t)g_rate * dt_us;
+        break;
+    case LOAD_BURST: {
+        // Ein Stoß zu Beginn jeder Periode
+        uint32_t const period = since_ms / LOAD_BURST_PERIOD_MS;
+        if (period != g_burst_period) {
+            g_burst_period = period;
+            g_credit += (uint64_t)LOAD_BURST_SCANS * LOAD_SCAN_UNITS;
+        }
+        break;
+    }
+    case LOAD_RAMP: {
+        uint32_t const pos = since_ms % LOAD_RAMP_MS;
+        uint32_t const from = g_rate > LOAD_RAMP_FROM ? LOAD_RAMP_FROM : g_rate;
+        uint32_t const rate = from + (uint32_t)((uint64_t)(g_rate - from) * pos / LOAD_RAMP_MS);
+        g_credit += (uint64_t)rate * dt_us;
+        break;
+    }
+    default:
+        break;
+    }
+    return (uint32_t)(g_credit / LOAD_SCAN_UNITS);
+}
+
+// Aktuelle Sollrate für die Ausgabe (Scans/s)
+static uint32_t load_target_rate(uint32_t now) {
+    switch (g_profile) {
+    case LOAD_BURST:
+        return (uint32_t)((uint64_t)LOAD_BURST_SCANS * 1000u / LOAD_BURST_PERIOD_MS);
+    case LOAD_RAMP: {
+        uint32_t const pos = ((now - g_t_profile) / 1000u) % LOAD_RAMP_MS;
+        uint32_t const from = g_rate > LOAD_RAMP_FROM ? LOAD_RAMP_FROM : g_rate;
+        return from + (uint32_t)((uint64_t)(g_rate - from) * pos / LOAD_RAMP_MS);
+    }
+    default:
+        return g_rate;
+    }
+}
+
+// ============================================================================
+// SEND AND RECEIVE
+// ============================================================================
+
+// Schließt den gesammelten Rahmen ab und stellt ihn in den Sendepuffer
+static void load_send_batch(uint32_t now) {
+    g_tx_len = net_batch_finish(&g_batch, to_ms_since_boot(get_absolute_time()), false);
+    memcpy(g_tx, g_batch.buf, g_tx_len);
+    g_tx_pos = 0;
+
+    load_inflight_t* f = &g_inflight[(g_if_head + g_if_count) % LOAD_WINDOW];
+    f->end_seq = g_batch.first_seq + g_batch.count;
+    f->t_us = now;
+    if (g_if_count == 0) g_t_progress = now;
+    g_if_count++;
+    g_stats.frames++;
+    net_batch_begin(&g_batch, LOAD_DEVICE_ID, g_boot);
+}
+
+// Schiebt den Sendepuffer in die TX-FIFO, ohne zu warten
+static void load_pump_uart(uint32_t now) {
+    while (g_tx_pos < g_tx_len && uart_is_writable(UART_ID0)) {
+        uart_putc_raw(UART_ID0, (char)g_tx[g_tx_pos++]);
+        g_stats.bytes++;
+    }
+    bool const stalled = g_tx_pos < g_tx_len;
+    if (stalled && !g_stalled) {
+        g_stats.stalls++;
+        g_t_stall = now;
+    } else if (!stalled && g_stalled) {
+        g_stats.stall_us += now - g_t_stall;
+    }
+    g_stalled = stalled;
+}
+
+// Wertet eine Bestätigung aus: alle Rahmen bis next_seq sind angekommen
+static void load_on_ack(const uint8_t* p, uint16_t len, uint32_t now) {
+    if (len < NET_ACK_LEN) return;
+    uint32_t const device_id = (uint32_t)p[0] | (uint32_t)p[1] << 8 | (uint32_t)p[2] << 16 | (uint32_t)p[3] << 24;
+    uint16_t const boot = (uint16_t)(p[4] | p[5] << 8);
+    uint32_t const next_seq = (uint32_t)p[6] | (uint32_t)p[7] << 8 | (uint32_t)p[8] << 16 | (uint32_t)p[9] << 24;
+    if (device_id != LOAD_DEVICE_ID || boot != g_boot) return;
+
+    while (g_if_count && (int32_t)(next_seq - g_inflight[g_if_head].end_seq) >= 0) {
+        load_hist_add(&g_stats.rtt, now - g_inflight[g_if_head].t_us);
+        g_if_head = (g_if_head + 1) % LOAD_WINDOW;
+        g_if_count--;
+        g_t_progress = now;
+    }
+    if ((int32_t)(next_seq - g_acked_seq) > 0) {
+        g_stats.acked += next_seq - g_acked_seq;
+        g_acked_seq = next_seq;
+    }
+}
+
+static net_frame_parser_t g_rx;
+static uint8_t g_rx_payload[64];
+
+static void load_poll_rx(uint32_t now) {
+    while (uart_is_readable(UART_ID0)) {
+        if (!net_frame_parse(&g_rx, (uint8_t)uart_getc(UART_ID0))) continue;
+        if (g_rx.type != NET_FRAME_ACK) continue;
+        load_on_ack(g_rx.payload, g_rx.len, now);
+    }
+}
+
+// ============================================================================
+// CONSOLE
+// ============================================================================
+
+static void load_poll_console(uint32_t now) {
+    int const ch = getchar_timeout_us(0);
+    if (ch == PICO_ERROR_TIMEOUT) return;
+
+    switch (ch) {
+    case 'c': g_profile = LOAD_CONSTANT; break;
+    case 'b': g_profile = LOAD_BURST; break;
+    case 'r': g_profile = LOAD_RAMP; break;
+    case '+': g_rate = g_rate * 2u; break;
+    case '-': g_rate = g_rate > 1u ? g_rate / 2u : 1u; break;
+    case 'm': g_mix = !g_mix; break;
+    default: return;
+    }
+    g_t_profile = now;
+    g_credit = 0;
+    g_burst_period = UINT32_MAX;
+    printf("Profil %s, Rate %lu Scans/s, Codes %s\n", k_profile_names[g_profile], (unsigned long)g_rate,
+           g_mix ? "gemischt" : "EAN-13");
+}
+
+static void load_report(uint32_t now, uint32_t interval_us) {
+    load_stats_t const* s = &g_stats;
+    uint32_t const ms = interval_us / 1000u ? interval_us / 1000u : 1u;
+
+    printf("[%lu s] %s soll %lu/s ist %lu/s (%lu Rahmen/s, %lu B/s), verworfen %lu | "
+           "UART voll %lux %lu%% | Fenster voll %lu%% | ACK %lu/s RTT p50<%lu p99<%lu p999<%lu max %lu us | "
+           "offen %u, Neustarts %lu\n",
+           (unsigned long)(now / 1000000u), k_profile_names[g_profile], (unsigned long)load_target_rate(now),
+           (unsigned long)(s->scans * 1000u / ms), (unsigned long)(s->frames * 1000u / ms),
+           (unsigned long)(s->bytes * 1000u / ms), (unsigned long)s->behind, (unsigned long)s->stalls,
+           (unsigned long)(s->stall_us / 10u / ms), (unsigned long)(s->window_full_us / 10u / ms),
+           (unsigned long)(s->acked * 1000u / ms), (unsigned long)load_hist_quantile(&s->rtt, 500),
+           (unsigned long)load_hist_quantile(&s->rtt, 990), (unsigned long)load_hist_quantile(&s->rtt, 999),
+           (unsigned long)s->rtt.max_us, g_if_count, (unsigned long)g_resyncs);
+    memset(&g_stats, 0, sizeof(g_stats));
+}
+
 // ============================================================================
 // MAIN PROGRAM
 // ============================================================================
 int main() {
     // Initialize stdio (for console debug output via USB)
     stdio_init_all();
-    
+
     // Configure CH9121 with settings above
     CH9121_configure(&ch9121_config);
-    
+
     // Initialize UART0 for data communication with CH9121 (network traffic)
     uart_init(UART_ID0, ch9121_config.baud_rate);
     gpio_set_function(UART_TX_PIN0, GPIO_FUNC_UART);
     gpio_set_function(UART_RX_PIN0, GPIO_FUNC_UART);
-    
+
     printf("\n==============================================\n");
-    printf("Connecting to Python MySQL Bridge...\n");
-    printf("Server: %d.%d.%d.%d:%d\n", 
+    printf("Load generator -> Python MySQL Bridge\n");
+    printf("Server: %d.%d.%d.%d:%d, %lu Baud\n",
            ch9121_config.target_ip[0], ch9121_config.target_ip[1],
            ch9121_config.target_ip[2], ch9121_config.target_ip[3],
-           ch9121_config.target_port);
+           ch9121_config.target_port, (unsigned long)ch9121_config.baud_rate);
+    printf("Profil %s, Rate %lu Scans/s\n", k_profile_names[g_profile], (unsigned long)g_rate);
     printf("==============================================\n\n");
-    
-    // Counter for message numbering
-    uint32_t message_count = 0;
-    
+
     // Warte kurz auf Verbindungsaufbau
     sleep_ms(2000);
-    
-    // Main loop: Send continuous status updates
+
+    g_rng = get_rand_32() | 1u;
+    net_frame_parser_init(&g_rx, g_rx_payload, sizeof(g_rx_payload));
+    load_restart();
+
+    uint32_t t_report = time_us_32();
+    uint32_t t_loop = t_report;
+    g_t_gen = g_t_profile = t_report;
+
+    // Hauptschleife: nie blockieren, damit Senden, Empfangen und Messen gleichmäßig laufen
     while (true) {
-        uint32_t time_ms = to_ms_since_boot(get_absolute_time());
-        
-        // Simulierter Barcode (in echter Anwendung von Scanner lesen)
-        char barcode[32];
-        snprintf(barcode, sizeof(barcode), "BAR%08lu", message_count);
-        
-        // Einfaches Text-Protokoll: nur der Barcode mit Newline
-        char message[64];
-        snprintf(message, sizeof(message), "%s\n", barcode);
-        
-        // Debug-Ausgabe auf Console
-        printf("[%lu] Sending barcode: %s", time_ms, message);
-        
-        // Send to Python server via UART0 -> CH9121 -> Python
-        uart_puts(UART_ID0, message);
-        
-        message_count++;
-        sleep_ms(1000); // Sende alle 1 Sekunde einen neuen Barcode
-    }
-    
+        uint32_t const now = time_us_32();
+        bool const window_full = g_if_count >= LOAD_WINDOW;
+        if (window_full) g_stats.window_full_us += now - t_loop;
+        t_loop = now;
+
+        load_poll_rx(now);
+        load_pump_uart(now);
+
+        // Fällige Scans erzeugen, solange der Rahmen Platz hat; ist der Sendepuffer noch
+        // belegt oder das Fenster voll, bleibt die Gutschrift stehen
+        uint32_t due = load_due(now);
+        while (due && g_tx_pos >= g_tx_len && g_if_count < LOAD_WINDOW) {
+            char code[48];
+            uint8_t const len = load_make_code(code, g_mix);
+            if (!net_batch_add(&g_batch, g_seq, to_ms_since_boot(get_absolute_time()), 1, code, len)) {
+                load_send_batch(now);
+                break;
+            }
+            if (g_batch.count == 1) g_batch_t_us = now;
+            g_seq++;
+            g_stats.scans++;
+            g_credit -= LOAD_SCAN_UNITS;
+            due--;
+        }
+
+        // Angefangenen Rahmen spätestens nach LOAD_BATCH_MS senden
+        if (g_batch.count && g_tx_pos >= g_tx_len && g_if_count < LOAD_WINDOW &&
+            (g_batch.count >= NET_FRAME_RECORDS_MAX || now - g_batch_t_us >= LOAD_BATCH_MS * 1000u)) {
+            load_send_batch(now);
+        }
+
+        // Mehr als einen Sekundenvorrat Rückstand nicht nachholen (Rate zeigt die Grenze)
+        uint64_t const cap = (uint64_t)(g_rate > LOAD_BURST_SCANS ? g_rate : LOAD_BURST_SCANS) * LOAD_SCAN_UNITS;
+        if (g_credit >= cap + LOAD_SCAN_UNITS) {
+            uint32_t const excess = (uint32_t)((g_credit - cap) / LOAD_SCAN_UNITS);
+            g_stats.behind += excess;
+            g_credit -= (uint64_t)excess * LOAD_SCAN_UNITS;
+        }
+
+        // Keine Bestätigungen mehr (Verbindung neu, Rahmen verloren): neuer Start
+        if (g_if_count && now - g_t_progress >= LOAD_ACK_TIMEOUT_MS * 1000u) {
+            g_resyncs++;
+            load_restart();
+        }
+
+        load_poll_console(now);
+        if (now - t_report >= LOAD_REPORT_MS * 1000u) {
+            load_report(now, now - t_report);
+            t_report = now;
+        }
+    }
+
     return 0;
 }